@@ -0,0 +1,380 @@
+#include "physics_system.h"
+#include "global.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <vector>
+
+// Small benchmark runner for the physics system.
+// Run it under `perf stat -e cache-references,cache-misses` to compare memory behaviour.
+
+static float RandomRange(float min, float max)
+{
+    return min + (max - min) * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+}
+
+static void SpawnBodies(int count, float world_size)
+{
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    // Every body ticks every step unless a benchmark turns the LOD on
+    physics.SetSimulationLodEnabled(false);
+    for (int i = 0; i < count; i++)
+    {
+        PhysicsBody body;
+        body.is_alive = true;
+        body.type = ObjectType::ASTEROID_TYPE;
+        body.position = {RandomRange(-world_size, world_size), RandomRange(-world_size, world_size)};
+        body.velocity = {RandomRange(-50.0f, 50.0f), RandomRange(-50.0f, 50.0f)};
+        body.rotation_torque = RandomRange(-100.0f, 100.0f);
+        body.speed_limit = 50.0f;
+        body.rotation_speed_limit = 200.0f;
+        body.width = 5.0f;
+        body.height = 5.0f;
+        body.center = {8.0f, 8.0f};
+        physics.CreatePhysicsObject(body);
+    }
+}
+
+// Time FixUpdate over a uniform field of asteroids, report nanoseconds per body per tick
+static void BenchFixUpdate(int count, int ticks)
+{
+    srand(42);
+    SpawnBodies(count, 20000.0f);
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++)
+    {
+        physics.FixUpdate(0.02f, {0.0f, 0.0f});
+    }
+    auto end = std::chrono::steady_clock::now();
+    double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("FixUpdate %7d bodies: %8.3f ms/tick %6.2f ns/body\n", count, total_ns / ticks / 1e6, total_ns / ticks / count);
+    physics.Unload();
+}
+
+// Time the integration kernel alone on every instruction set the CPU supports
+static void BenchIntegrate(int count, int ticks)
+{
+    for (SimdPath path : {SimdPath::Scalar, SimdPath::SSE2, SimdPath::AVX2, SimdPath::WasmSimd128})
+    {
+        if (!IsSimdPathSupported(path))
+            continue;
+        srand(42);
+        SpawnBodies(count, 20000.0f);
+        PhysicsSystem &physics = PhysicsSystem::GetInstance();
+        physics.SetSimdPath(path);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++)
+        {
+            // Camera far away, nothing is on screen so only integration runs
+            physics.FixUpdate(0.02f, {1e9f, 1e9f});
+        }
+        auto end = std::chrono::steady_clock::now();
+        double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        printf("Integrate %-9s %7d bodies: %8.3f ms/tick %6.2f ns/body\n", physics.GetSimdPathName(), count, total_ns / ticks / 1e6, total_ns / ticks / count);
+        physics.Unload();
+    }
+    PhysicsSystem::GetInstance().SetSimdPath(GetPhysicsKernels().path);
+}
+
+// Time FixUpdate with every body on screen (collisions enabled) from 1 to max_threads threads
+static void BenchThreads(int count, int ticks, int max_threads)
+{
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    int default_thread_count = physics.GetThreadCount();
+    int saved_width = virtual_screen_width;
+    int saved_height = virtual_screen_height;
+    virtual_screen_width = 40000;
+    virtual_screen_height = 40000;
+    double single_thread_ns = 0.0;
+    for (int threads = 1; threads <= max_threads; threads *= 2)
+    {
+        srand(42);
+        SpawnBodies(count, 20000.0f);
+        physics.SetThreadCount(threads);
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < ticks; i++)
+        {
+            physics.FixUpdate(0.02f, {-20000.0f, -20000.0f});
+        }
+        auto end = std::chrono::steady_clock::now();
+        double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        if (threads == 1)
+            single_thread_ns = total_ns;
+        printf("Threads %2d %7d bodies: %8.3f ms/tick speedup %5.2fx\n", threads, count, total_ns / ticks / 1e6, single_thread_ns / total_ns);
+        physics.Unload();
+    }
+    physics.SetThreadCount(default_thread_count);
+    virtual_screen_width = saved_width;
+    virtual_screen_height = saved_height;
+}
+
+// Time FixUpdate with the simulation LOD on, the view in the middle of the field
+static void BenchLod(int count, int ticks)
+{
+    srand(42);
+    SpawnBodies(count, 20000.0f);
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.SetSimulationLodEnabled(true);
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++)
+    {
+        physics.FixUpdate(0.02f, {0.0f, 0.0f});
+    }
+    auto end = std::chrono::steady_clock::now();
+    double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("LOD %7d bodies: %8.3f ms/tick near %d mid %d far %d\n", count, total_ns / ticks / 1e6,
+           physics.GetTierCount(SIM_TIER_NEAR), physics.GetTierCount(SIM_TIER_MID), physics.GetTierCount(SIM_TIER_FAR));
+    physics.Unload();
+}
+
+// Time FixUpdate with bodies of very different sizes on screen: bullets, asteroids and
+// static planets, the case a single grid cell size could not handle
+static void BenchBroadphase(int count, int ticks)
+{
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    int saved_width = virtual_screen_width;
+    int saved_height = virtual_screen_height;
+    virtual_screen_width = 40000;
+    virtual_screen_height = 40000;
+    srand(42);
+    SpawnBodies(count, 20000.0f);
+    for (int i = 0; i < count; i++)
+    {
+        PhysicsBody bullet;
+        bullet.is_alive = true;
+        bullet.is_fast = true;
+        bullet.type = ObjectType::BULLET_TYPE;
+        bullet.position = {RandomRange(-20000.0f, 20000.0f), RandomRange(-20000.0f, 20000.0f)};
+        bullet.velocity = {RandomRange(-500.0f, 500.0f), RandomRange(-500.0f, 500.0f)};
+        bullet.speed_limit = 500.0f;
+        bullet.width = 2.0f;
+        bullet.height = 2.0f;
+        physics.CreatePhysicsObject(bullet);
+    }
+    for (int i = 0; i < 64; i++)
+    {
+        PhysicsBody planet;
+        planet.is_alive = true;
+        planet.is_static = true;
+        planet.type = ObjectType::ASTEROID_TYPE;
+        planet.collision = ObjectShape::Rectangle;
+        planet.position = {RandomRange(-20000.0f, 20000.0f), RandomRange(-20000.0f, 20000.0f)};
+        planet.width = 128.0f;
+        planet.height = 128.0f;
+        physics.CreatePhysicsObject(planet);
+    }
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++)
+    {
+        physics.FixUpdate(0.02f, {-20000.0f, -20000.0f});
+    }
+    auto end = std::chrono::steady_clock::now();
+    double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("Broadphase %7d bodies: %8.3f ms/tick %d candidate pairs\n", physics.GetBodyCount(), total_ns / ticks / 1e6, physics.GetCandidatePairCount());
+    physics.Unload();
+    virtual_screen_width = saved_width;
+    virtual_screen_height = saved_height;
+}
+
+// Time batches of spatial queries against a field of asteroids in the broadphase
+static void BenchQueries(int count, int queries)
+{
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    int saved_width = virtual_screen_width;
+    int saved_height = virtual_screen_height;
+    virtual_screen_width = 4000;
+    virtual_screen_height = 4000;
+    srand(42);
+    SpawnBodies(count, 2000.0f);
+    physics.FixUpdate(0.0f, {-2000.0f, -2000.0f});
+    std::vector<Vector2> origins(queries);
+    std::vector<Vector2> directions(queries);
+    for (int i = 0; i < queries; i++)
+    {
+        origins[i] = {RandomRange(-2000.0f, 2000.0f), RandomRange(-2000.0f, 2000.0f)};
+        float angle = RandomRange(0.0f, 2.0f * PI);
+        directions[i] = {cosf(angle) * 200.0f, sinf(angle) * 200.0f};
+    }
+    QueryFilter filter;
+    RaycastHit hit;
+    PhysicsHandle results[16];
+    float distances[16];
+    int found = 0;
+    auto time_queries = [&](const char *name, auto query)
+    {
+        found = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < queries; i++)
+            query(i);
+        auto end = std::chrono::steady_clock::now();
+        double total_ns = std::chrono::duration<double, std::nano>(end - start).count();
+        printf("%-13s %7d bodies: %8.3f ms per %d queries %7.1f ns/query (%d found)\n", name, count, total_ns / 1e6, queries, total_ns / queries, found);
+    };
+    time_queries("Raycast", [&](int i) { found += physics.Raycast(origins[i], Vector2Add(origins[i], directions[i]), filter, hit); });
+    time_queries("OverlapCircle", [&](int i) { found += physics.OverlapCircle(origins[i], 50.0f, filter, results, 16); });
+    time_queries("OverlapAABB", [&](int i) { found += physics.OverlapAABB({origins[i].x, origins[i].y, 100.0f, 100.0f}, filter, results, 16); });
+    time_queries("KNearest", [&](int i) { found += physics.KNearest(origins[i], 200.0f, filter, 8, results, distances); });
+    physics.Unload();
+    virtual_screen_width = saved_width;
+    virtual_screen_height = saved_height;
+}
+
+// Time one n-body gravity step (tree build and the pull on every body) against the
+// brute force sum, and report the relative RMS error of the tree
+static void BenchNBody(int count, float theta, bool with_brute_force)
+{
+    srand(42);
+    std::vector<float> x(count);
+    std::vector<float> y(count);
+    std::vector<float> mass(count);
+    for (int i = 0; i < count; i++)
+    {
+        x[i] = RandomRange(-20000.0f, 20000.0f);
+        y[i] = RandomRange(-20000.0f, 20000.0f);
+        mass[i] = RandomRange(1.0f, 100.0f);
+    }
+    std::vector<Vector2> tree_pull(count);
+    BarnesHutTree tree;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+        tree.AddBody(i, x[i], y[i], mass[i]);
+    tree.Build();
+    for (int i = 0; i < count; i++)
+        tree_pull[i] = tree.GetAcceleration(x[i], y[i], i, theta, 10.0f);
+    auto end = std::chrono::steady_clock::now();
+    double tree_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    if (!with_brute_force)
+    {
+        printf("NBody %7d bodies theta %.2f: %9.3f ms/tick Barnes-Hut\n", count, theta, tree_ms);
+        return;
+    }
+    double error_sum = 0.0;
+    double norm_sum = 0.0;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        Vector2 exact = ComputeGravityBruteForce(x.data(), y.data(), mass.data(), count, x[i], y[i], i, 10.0f);
+        error_sum += (tree_pull[i].x - exact.x) * (tree_pull[i].x - exact.x) + (tree_pull[i].y - exact.y) * (tree_pull[i].y - exact.y);
+        norm_sum += exact.x * exact.x + exact.y * exact.y;
+    }
+    end = std::chrono::steady_clock::now();
+    double brute_force_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("NBody %7d bodies theta %.2f: %9.3f ms/tick Barnes-Hut %9.3f ms/tick brute force, error %.4f%%\n",
+           count, theta, tree_ms, brute_force_ms, 100.0 * sqrt(error_sum / norm_sum));
+}
+
+// Time integration-only ticks with a growing number of force sources baked in the
+// field, against summing the same sources directly for every body
+static void BenchForceField(int count, int ticks, int source_count)
+{
+    srand(42);
+    SpawnBodies(count, 20000.0f);
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    std::vector<ForceSource> sources;
+    for (int i = 0; i < source_count; i++)
+    {
+        Vector2 position = {RandomRange(-20000.0f, 20000.0f), RandomRange(-20000.0f, 20000.0f)};
+        if (i % 4 == 0)
+            sources.push_back(ForceSource::Drag(position, 0.2f, 1500.0f));
+        else if (i % 4 == 1)
+            sources.push_back(ForceSource::Wind(position, {0.6f, 0.8f}, 5.0f, 1500.0f));
+        else
+            sources.push_back(ForceSource::Well(position, 50000.0f, 64.0f, 1500.0f));
+        physics.AddForceSource(sources.back());
+    }
+    auto start = std::chrono::steady_clock::now();
+    // The first tick bakes every sector
+    physics.FixUpdate(0.02f, {1e9f, 1e9f});
+    auto end = std::chrono::steady_clock::now();
+    double bake_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ticks; i++)
+    {
+        physics.FixUpdate(0.02f, {1e9f, 1e9f});
+    }
+    end = std::chrono::steady_clock::now();
+    double field_ms = std::chrono::duration<double, std::milli>(end - start).count() / ticks;
+    // What each body would pay without the grid, one term per source
+    ForceField direct;
+    for (const ForceSource &source : sources)
+        direct.AddSource(source);
+    std::vector<float> x(count);
+    std::vector<float> y(count);
+    for (int i = 0; i < count; i++)
+    {
+        x[i] = RandomRange(-20000.0f, 20000.0f);
+        y[i] = RandomRange(-20000.0f, 20000.0f);
+    }
+    float checksum = 0.0f;
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < count; i++)
+    {
+        for (const ForceSource &source : sources)
+        {
+            float dx = source.position.x - x[i];
+            float dy = source.position.y - y[i];
+            float distance_sqr = dx * dx + dy * dy + source.core_radius * source.core_radius;
+            checksum += source.strength * dx / (distance_sqr * sqrtf(distance_sqr));
+        }
+    }
+    end = std::chrono::steady_clock::now();
+    double direct_ms = std::chrono::duration<double, std::milli>(end - start).count();
+    printf("ForceField %4d sources %d sectors: %8.3f ms/tick, bake %8.3f ms, direct sum %8.3f ms/tick (%g)\n",
+           source_count, physics.GetForceField().GetSectorCount(), field_ms, bake_ms, direct_ms, checksum);
+    physics.Unload();
+}
+
+int main(int argc, char **argv)
+{
+    const char *filter = argc > 1 ? argv[1] : "";
+    if (strstr("fixupdate", filter))
+    {
+        for (int count : {1000, 10000, 50000, 100000})
+        {
+            BenchFixUpdate(count, 100);
+        }
+    }
+    if (strstr("integrate", filter))
+    {
+        BenchIntegrate(100000, 100);
+    }
+    if (strstr("lod", filter))
+    {
+        BenchLod(100000, 100);
+    }
+    if (strstr("broadphase", filter))
+    {
+        BenchBroadphase(20000, 20);
+    }
+    if (strstr("queries", filter))
+    {
+        BenchQueries(10000, 1000);
+    }
+    if (strstr("nbody", filter))
+    {
+        for (float theta : {0.3f, 0.5f, 0.8f})
+        {
+            BenchNBody(10000, theta, true);
+        }
+        for (int count : {50000, 100000})
+        {
+            BenchNBody(count, 0.5f, false);
+        }
+    }
+    if (strstr("field", filter))
+    {
+        for (int source_count : {0, 16, 256})
+        {
+            BenchForceField(100000, 50, source_count);
+        }
+    }
+    if (strstr("threads", filter))
+    {
+        BenchThreads(100000, 50, std::max(PhysicsThreadPool::GetHardwareThreadCount(), 8));
+    }
+    return 0;
+}
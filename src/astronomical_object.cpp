@@ -1 +0,0 @@
-#include "astronomical_object.h"
\ No newline at end of file
@@ -4,7 +4,7 @@
 // Apply force to move forward
 void DynamicBody::ApplyForce(float force)
 {
-    if (physics_id < 0)
+    if (!physics_id.IsValid())
         return;
     // move forward based on rotation angle
     PhysicsSystem::GetInstance().ApplyForce(physics_id, force);
@@ -12,7 +12,7 @@ void DynamicBody::ApplyForce(float force)
 // Apply force to move forward
 void DynamicBody::ApplyForceDirected(float force, Vector2 direction)
 {
-    if (physics_id < 0)
+    if (!physics_id.IsValid())
         return;
     // move forward based on rotation angle 
     PhysicsSystem::GetInstance().ApplyForce(physics_id, force, direction);
@@ -21,7 +21,7 @@ void DynamicBody::ApplyForceDirected(float force, Vector2 direction)
 // Apply force to move backward
 void DynamicBody::ApplyTorque(float torque)
 {
-    if (physics_id < 0)
+    if (!physics_id.IsValid())
         return;
     PhysicsSystem::GetInstance().ApplyTorque(physics_id, torque);
 };
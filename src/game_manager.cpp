@@ -21,11 +21,16 @@ GameManager::GameManager()
         menu_stars.push_back({static_cast<float>(GetRandomValue(0, virtual_screen_width)), static_cast<float>(GetRandomValue(0, virtual_screen_height))});
     }
     PhysicsSystem::GetInstance(0.0f, 0.0f); // Initialize physic world
+    PhysicsSystem::GetInstance().SetNBodyGravity(true);
     camera.offset = {0.0f, 0.0f};
     camera.target = {0.0f, 0.0f};
     // Zoom in if the screen increases and zoom out if the screen decreases
     camera.zoom = 1.0f * (virtual_screen_width + virtual_screen_height) / 1000;
     input_manager = new InputManager();
+    RegisterContactHandlers();
+    // Asteroids may first spawn on the simulation thread, which must not add sprites.
+    // The bullet sprite comes with the BulletPool.
+    GetAsteroidSprite();
     asteriod_cooldown_time = 0.2f;
     SpawnAsteroid(asteriod_cooldown_time);
     planet = Planet::Create({virtual_screen_width/2.0f, virtual_screen_height/2.0f});
@@ -45,6 +50,29 @@ void GameManager::Update(float delta_time)
         // }
         return;
     }
+    if (simulation.IsStarted())
+    {
+        if (simulation.IsRunning())
+        {
+            // Applied by the simulation thread before its next step
+            input_commands.Push(input_manager->Poll());
+            return;
+        }
+        // The simulation thread stopped itself, the player is dead
+        simulation.Stop();
+    }
+    else if (is_threaded_simulation && player->IsAlive())
+    {
+        // Something to draw before the first step
+        PublishState(world_states.GetWriteBuffer());
+        world_states.Publish();
+        if (simulation.Start(simulation_timestep, &GameManager::SimulationStep, this))
+        {
+            input_commands.Push(input_manager->Poll());
+            return;
+        }
+        is_threaded_simulation = false;
+    }
     // if (IsWindowResized())
     // { // Only update when window is resized
     //     // camera.offset = {virtual_screen_width / 2.0f, virtual_screen_height / 2.0f};
@@ -58,87 +86,236 @@ void GameManager::Update(float delta_time)
         // implement reset game if player choose to try again.
         // the idea is for the player to comeback in the closest space station or beginning position if no space station discovered.
         is_menu = true;
+        lifecycle.QueueDestroy(player);
+        lifecycle.FlushAll(entities, physic_objects);
         player.reset();
         camera.target = { 0 };
         camera.offset = { 0 };
+        camera_sector = WorldSector();
+        star_sector = WorldSector();
+        // Commands the simulation thread did not get to
+        input_commands.Drain([](const InputCommand &){});
+        entities.Clear();
+        damage_system.Clear();
+        EventBus::GetInstance().Clear();
         PhysicsSystem::GetInstance().Unload();
+        bullet_pool.Reset();
         if(star_builder != nullptr){
             delete star_builder;
             star_builder = nullptr;
         }
         return;
     }
-    input_manager->Update(delta_time);
+    InputManager::Apply(input_manager->Poll(), *player);
+    UpdateGame(delta_time);
+}
+
+void GameManager::UpdateGame(float delta_time)
+{
     frameCounter++;
     player->Update(delta_time);
+    // Outcome of the shots fired since the last frame
+    EventBus &events = EventBus::GetInstance();
+    events.Drain<CollisionEvent>([this](const CollisionEvent &){ hit_count++; });
+    events.Drain<EndOfLifeEvent>([this](const EndOfLifeEvent &){ miss_count++; });
+    events.Drain<DeathEvent>([this](const DeathEvent &){ kill_count++; });
     if (player->GetScore() > score)
     {
         score = player->GetScore();
     }
-    star_builder->Update(delta_time);
 }
 
-void GameManager::RelocateOriginBasedOnPlayerPosition(){
-    // MAX 1280 -+
-    if(player->position.x < -1280 || player->position.x > 1280){
-        // Move all objects based on payer position
-        for (std::shared_ptr<PhysicsObject> &obj : physic_objects){
-            obj->position.x -= player->position.x;
-        }
-        star_builder->ReOriginStarsX(player->position.x);
-        player->position.x = 0.0f;
+void GameManager::FollowPlayer(const RenderProxy &player_proxy){
+    // Bodies keep their own sector, only what is relative to the camera moves
+    if(player_proxy.sector != camera_sector){
+        camera_sector = player_proxy.sector;
+        PhysicsSystem::GetInstance().SetFrameSector(camera_sector);
     }
-    if(player->position.y < -1280 || player->position.y > 1280){
-        // Move all objects based on payer position
-        for (std::shared_ptr<PhysicsObject> &obj : physic_objects){
-            obj->position.y -= player->position.y;
+    camera.target = player_proxy.position;
+}
+
+void GameManager::RegisterContactHandlers(){
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.SetContactHandler(ObjectType::BULLET_TYPE, ObjectType::ASTEROID_TYPE, [this](const PhysicsContact *contacts, int count){
+        PhysicsSystem &physics = PhysicsSystem::GetInstance();
+        for (int i = 0; i < count; i++){
+            Entity target = GetBodyEntity(contacts[i].handle_b);
+            // Planets are not entities and take no shots, nothing is hit or paid
+            if (!entities.IsAlive(target)) continue;
+            std::shared_ptr<Bullet> bullet = std::dynamic_pointer_cast<Bullet>(physics.GetGameObject(contacts[i].handle_a));
+            if (!bullet || !bullet->is_enabled) continue;
+            EventBus::GetInstance().Push(DamageEvent{contacts[i].handle_a, contacts[i].handle_b, bullet->damage, contacts[i].point});
+            bullet->OnHit(contacts[i].handle_b, contacts[i].point);
         }
-        star_builder->ReOriginStarsY(player->position.y);
-        player->position.y = 0.0f;
-    }
+    });
+    physics.SetContactHandler(ObjectType::ASTEROID_TYPE, ObjectType::PLAYER_TYPE, [this](const PhysicsContact *contacts, int count){
+        PhysicsSystem &physics = PhysicsSystem::GetInstance();
+        for (int i = 0; i < count; i++){
+            Entity asteroid = GetBodyEntity(contacts[i].handle_a);
+            if (!entities.IsAlive(asteroid)){
+                physics.NotifyCollision(contacts[i]);
+                continue;
+            }
+            // Already spent on an earlier contact, gone at the end of the frame
+            if (lifecycle.IsPendingDestroy(asteroid)) continue;
+            ContactDamageComponent *hit = entities.Get<ContactDamageComponent>(asteroid);
+            std::shared_ptr<PhysicsObject> target = physics.GetGameObject(contacts[i].handle_b);
+            if (hit == nullptr || !target) continue;
+            target->TakeDamage(hit->damage, contacts[i].point);
+            lifecycle.QueueDestroy(entities, asteroid);
+        }
+    });
 }
 
 void GameManager::FixUpdate(float delta_time)
 {
     if (player == nullptr)  return;
-    input_manager->FixUpdate();
+    // The simulation thread steps on its own
+    if (simulation.IsStarted()) return;
+    Step(delta_time);
+}
+
+void GameManager::Step(float delta_time)
+{
     Vector2 camera_with_offset = Vector2Subtract(camera.target, camera.offset);
-    PhysicsSystem::GetInstance().FixUpdate(delta_time, camera_with_offset);
-    camera.target = player->GetPosition();
-    star_builder->FixUpdate(camera.target);
+    PhysicsSystem::GetInstance().FixUpdate(delta_time, camera_with_offset, camera_sector);
+    if (const RenderProxy *player_proxy = PhysicsSystem::GetInstance().GetRenderSnapshot().Find(player->physics_id))
+    {
+        FollowPlayer(*player_proxy);
+        // Gameplay (gun, damage push) works from where the tick left the ship
+        player->sector = camera_sector;
+        player->position = player_proxy->GetPosition(1.0f, camera_sector);
+        player->rotation = player_proxy->rotation;
+        player->is_on_screen = player_proxy->is_on_screen;
+    }
+    body_link_system.Update(entities, lifecycle);
+    damage_system.Update(entities, lifecycle);
+    lifetime_system.Update(entities, delta_time, lifecycle);
     SpawnAsteroid(delta_time);
-    RelocateOriginBasedOnPlayerPosition();
 }
 
-void GameManager::Render()
+bool GameManager::SimulateStep(float step)
+{
+    // Controls of the frames drawn since the last step, in order
+    input_commands.Drain([this](const InputCommand &command)
+    {
+        InputManager::Apply(command, *player);
+    });
+    UpdateGame(step);
+    Step(step);
+    lifecycle.Flush(entities, physic_objects);
+    PublishState(world_states.GetWriteBuffer());
+    world_states.Publish();
+    return player->IsAlive();
+}
+
+bool GameManager::SimulationStep(void *context, float step)
+{
+    return static_cast<GameManager *>(context)->SimulateStep(step);
+}
+
+void GameManager::SetThreadedSimulation(bool enabled, FixedTimestep timestep)
+{
+    is_threaded_simulation = enabled;
+    simulation_timestep = timestep;
+    if (!enabled)
+        simulation.Stop();
+}
+
+void GameManager::PublishState(WorldState &state)
+{
+    // Copied into storage kept from earlier states, no allocation once warmed up
+    state.snapshot = PhysicsSystem::GetInstance().GetRenderSnapshot();
+    CaptureView(state);
+    CaptureStats(state);
+}
+
+void GameManager::CaptureView(WorldState &state)
+{
+    state.camera = camera;
+    state.camera_sector = camera_sector;
+    state.player = player->physics_id;
+    state.player_position = player->GetPosition();
+    state.gun_sight = player->GetGunSight();
+    state.health = player->GetPercentHealth();
+    state.energy = player->GetPercentEnergy();
+    state.score = score;
+    state.step_time = SimulationThread::Now();
+}
+
+void GameManager::CaptureStats(WorldState &state)
+{
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    state.candidate_pairs = physics.GetCandidatePairCount();
+    state.body_count = physics.GetBodyCount();
+    state.stale_handle_accesses = physics.GetStaleHandleAccessCount();
+    for (int tier = 0; tier < SIM_TIER_COUNT; tier++)
+        state.tier_counts[tier] = physics.GetTierCount(static_cast<SimulationTier>(tier));
+    state.entity_count = entities.GetCount();
+    state.archetype_count = entities.GetArchetypeCount();
+    state.bullet_count = bullet_pool.GetActiveCount();
+    state.live_count = entities.GetCount() + static_cast<int>(physic_objects.size());
+    state.pending_count = lifecycle.GetPendingCount();
+    state.destroyed_count = lifecycle.GetDestroyedCount();
+    state.hit_count = hit_count;
+    state.miss_count = miss_count;
+    state.kill_count = kill_count;
+    state.events_dropped = EventBus::GetInstance().GetDroppedCount();
+}
+
+void GameManager::UpdateStars(const WorldState &state, float delta_time)
+{
+    if (star_builder == nullptr)
+        return;
+    if (state.camera_sector != star_sector)
+    {
+        star_builder->ShiftOrigin(star_sector.OffsetFrom(state.camera_sector));
+        star_sector = state.camera_sector;
+    }
+    star_builder->FixUpdate(delta_time, state.camera.target);
+}
+
+void GameManager::Render(float alpha)
 {
     // Check if window is ready
     if (IsWindowReady() == false)
         return;
     // Clear the screen
     ClearBackground(BLACK);
+    // With the simulation thread nothing below reads live game state, only the last
+    // published one. Without it the game and the physics snapshot are read in place.
+    const bool is_threaded = simulation.IsStarted();
+    if (!is_threaded)
+    {
+        if (!is_menu && player) CaptureView(live_state);
+        if (is_debug) CaptureStats(live_state);
+    }
+    const WorldState &state = is_threaded ? world_states.Read() : live_state;
+    const RenderSnapshot &snapshot = is_threaded ? state.snapshot : PhysicsSystem::GetInstance().GetRenderSnapshot();
     if (!is_menu)
     {
-        BeginMode2D(camera);
+        // The simulation thread places its states in time, blend from the last one
+        if (is_threaded)
+            alpha = Clamp(static_cast<float>((SimulationThread::Now() - state.step_time) / simulation_timestep.GetStep()), 0.0f, 1.0f);
+        // Everything is drawn from what the last tick published, nothing is copied back
+        const RenderProxy *player_proxy = snapshot.Find(state.player);
+        Camera2D view = state.camera;
+        // Follow the interpolated player so the camera moves as smoothly as the bodies
+        if (player_proxy) view.target = player_proxy->GetPosition(alpha, state.camera_sector);
+        UpdateStars(state, GetFrameTime());
+        BeginMode2D(view);
             star_builder->Render();
-            for(const auto& obj : physic_objects){
-                if(obj){
-                    PhysicsBody& body = PhysicsSystem::GetInstance().GetPhysicsObject(obj->physics_id);
-                    if(body.is_alive && body.is_on_screen){
-                        obj->position = body.position;
-                        obj->rotation = body.rotation;
-                        obj->is_accelerating = body.is_accelerating;
-                        obj->is_rotating_left = body.is_rotating_left;
-                        obj->is_rotating_right = body.is_rotating_right;
-                        obj->Render();
-                    }
-                }
-            }
+            // Player, bullets and asteroids, relative to the camera sector so floats stay small
+            snapshot.Render(alpha, state.camera_sector, sprite_batch);
+            // Every sprite of the frame in one pass over the atlas
+            sprite_batch.Flush();
+            if (player_proxy && player_proxy->is_on_screen)
+                Player::RenderGunSight(state.gun_sight);
         EndMode2D();
-        input_manager->Render();
+        input_manager->Render(state.health, state.energy);
     }
     // Draw score and other UI elements
-    DrawText(TextFormat("Score: %d", score), 10, 70, 5, GREEN);
+    DrawText(TextFormat("Score: %d", is_menu ? score : state.score), 10, 70, 5, GREEN);
     if (is_menu)
     {
         BeginMode2D(camera);
@@ -147,26 +324,15 @@ void GameManager::Render()
             {
                 DrawPixel(star.x, star.y, WHITE);
             }
-            planet->Render();
+            planet->Render(sprite_batch);
+            sprite_batch.Flush();
         EndMode2D();
         float size_width = 200.0f;
         float size_height = 50.0f;
         // Add start menu
         if (MenuButtom({static_cast<float>(virtual_screen_width / 2) - size_width / 2, static_cast<float>(virtual_screen_height / 2) - size_height / 1.5f, size_width, size_height}, "Start Game"))
         {
-            is_menu = false;
-
-            // Initialize player
-            player = Player::Create();
-            // player->position = Vector2({0, -10000});
-            physic_objects.push_back(player);
-            input_manager->SetPlayer(player);
-            camera.target = player->GetPosition();
-            camera.offset = Vector2({virtual_screen_width / 2.0f, virtual_screen_height / 2.0f});
-            // camera.zoom = 1.0f * (virtual_screen_width + virtual_screen_height) / 1000;
-            // if(camera.zoom < 1) camera.zoom = 1.0f;
-            // camera.rotation = 0.0f;
-            star_builder = new StarBuilder(100, camera.target, camera.zoom);
+            StartGame();
         }
         // Add exit button
         if (MenuButtom({static_cast<float>(virtual_screen_width / 2) - size_width / 2, static_cast<float>(virtual_screen_height / 2) + size_height / 1.5f, size_width, size_height}, "Exit Game"))
@@ -181,7 +347,7 @@ void GameManager::Render()
     if (is_debug)
     {
         // Draw Player position
-        if (player) DrawText(TextFormat("Player: %f, %f", player->GetPosition().x, player->GetPosition().y), 10, 100, 5, WHITE);
+        if (!is_menu) DrawText(TextFormat("Player: %f, %f (sector %i, %i)", state.player_position.x, state.player_position.y, state.camera_sector.x, state.camera_sector.y), 10, 100, 5, WHITE);
         // Draw Planet position
         if (planet) DrawText(TextFormat("Planet: %f, %f", planet->GetPosition().x, planet->GetPosition().y), 10, 110, 5, WHITE);
         // Draw screen size
@@ -205,11 +371,64 @@ void GameManager::Render()
 
         // Draw render size
         DrawText(TextFormat("Render: %i, %i", GetRenderWidth(), GetRenderHeight()), 10, 180, 5, WHITE);
+
+        // Draw collision pairs that passed the broadphase on the last physics tick
+        DrawText(TextFormat("Collision Pairs: %i", state.candidate_pairs), 10, 190, 5, WHITE);
+        // Draw instruction set used by the physics kernels
+        DrawText(TextFormat("Physics SIMD: %s", PhysicsSystem::GetInstance().GetSimdPathName()), 10, 200, 5, WHITE);
+        // Draw physics bodies and accesses through handles of removed bodies
+        DrawText(TextFormat("Physics Bodies: %i (stale handles: %i)", state.body_count, state.stale_handle_accesses), 10, 210, 5, WHITE);
+        // Draw bodies per simulation LOD tier
+        DrawText(TextFormat("Sim LOD near/mid/far: %i/%i/%i", state.tier_counts[SIM_TIER_NEAR], state.tier_counts[SIM_TIER_MID], state.tier_counts[SIM_TIER_FAR]), 10, 220, 5, WHITE);
+        // Draw entities and the archetypes they are stored in
+        DrawText(TextFormat("Entities: %i (archetypes: %i)", state.entity_count, state.archetype_count), 10, 230, 5, WHITE);
+        // Draw bullets in flight out of the pool
+        DrawText(TextFormat("Bullets: %i/%i", state.bullet_count, BulletPool::CAPACITY), 10, 240, 5, WHITE);
+        // Draw sprites of the last batch and the texture binds they took
+        DrawText(TextFormat("Sprites: %i (draws: %i)", sprite_batch.GetInstanceCount(), sprite_batch.GetDrawCount()), 10, 250, 5, WHITE);
+        // Draw live objects, those waiting for the end of frame and those released so far
+        DrawText(TextFormat("Lifecycle live/pending/destroyed: %i/%i/%i", state.live_count, state.pending_count, state.destroyed_count), 10, 260, 5, WHITE);
+        // Draw the shots that hit, those that timed out and the asteroids they destroyed
+        DrawText(TextFormat("Hits/misses/kills: %i/%i/%i (events dropped: %u)", state.hit_count, state.miss_count, state.kill_count, state.events_dropped), 10, 270, 5, WHITE);
+        // Draw the frame arenas: bytes used so far, the most a frame used and their mallocs since the start
+        FrameArenas &arenas = FrameArenas::GetInstance();
+        DrawText(TextFormat("Frame arena: %i/%i KB (mallocs: %i)", static_cast<int>(arenas.GetUsed() / 1024), static_cast<int>(arenas.GetHighWater() / 1024), arenas.GetHeapAllocationCount()), 10, 280, 5, WHITE);
+        // Draw whether the simulation has its own thread and the input it had to drop
+        DrawText(TextFormat("Simulation thread: %s (steps: %i, input dropped: %u)", is_threaded ? "on" : "off", simulation.GetStepCount(), input_commands.GetDroppedCount()), 10, 290, 5, WHITE);
     }
     // Draw FPS
     DrawFPS(virtual_screen_width - 100, 10);
 }
 
+void GameManager::StartGame()
+{
+    is_menu = false;
+    // A game over unloaded the physics world, the planet and its well with it
+    if (!PhysicsSystem::GetInstance().IsValid(planet->physics_id))
+        planet = Planet::Create(planet->GetPosition());
+
+    // Initialize player
+    player = Player::Create(&bullet_pool);
+    // player->position = Vector2({0, -10000});
+    physic_objects.push_back(player);
+    input_manager->SetPlayer(player);
+    camera.target = player->GetPosition();
+    camera.offset = Vector2({virtual_screen_width / 2.0f, virtual_screen_height / 2.0f});
+    // camera.zoom = 1.0f * (virtual_screen_width + virtual_screen_height) / 1000;
+    // if(camera.zoom < 1) camera.zoom = 1.0f;
+    // camera.rotation = 0.0f;
+    if (star_builder != nullptr)
+        delete star_builder;
+    star_builder = new StarBuilder(100, camera.target, camera.zoom);
+}
+
+void GameManager::EndFrame()
+{
+    // The simulation thread releases after its own steps
+    if (simulation.IsStarted()) return;
+    lifecycle.Flush(entities, physic_objects);
+}
+
 void GameManager::SpawnAsteroid(float delta_time)
 {
     asteriod_cooldown += delta_time;
@@ -253,12 +472,11 @@ void GameManager::SpawnAsteroid(float delta_time)
         Vector2 direction = Vector2Normalize(Vector2Subtract(camera.target, spawnPos));
 
         asteriod_cooldown = 0.0f;
-        std::shared_ptr<AstronomicalObject> asteroid = AstronomicalObject::Create(ObjectType::ASTEROID_TYPE, 100.0f, 10.0f, 1, spawnPos, {.2f, .2f}, 50.0f, 100.0f);
-        
-        PhysicsSystem::GetInstance().ApplyForce(asteroid->physics_id, 10, direction);
+        Entity asteroid = CreateAsteroid(entities, 100.0f, 10.0f, 50.0f, spawnPos, camera_sector);
+        PhysicsHandle asteroid_body = entities.Get<PhysicsBodyComponent>(asteroid)->handle;
+        PhysicsSystem::GetInstance().ApplyForce(asteroid_body, 10, direction);
         // random torque
-        PhysicsSystem::GetInstance().ApplyTorque(asteroid->physics_id, GetRandomValue(-100, 100));
-        physic_objects.push_back(asteroid);
+        PhysicsSystem::GetInstance().ApplyTorque(asteroid_body, GetRandomValue(-100, 100));
     }
 }
 
@@ -0,0 +1,78 @@
+#ifndef ASTEROID_H
+#define ASTEROID_H
+
+#include "raylib.h"
+#include "entity_world.h"
+#include "components.h"
+#include "physics_system.h"
+
+// Asteroids are entities: physics body, health, contact damage and lifetime. Their
+// sprite goes with the physics body and is drawn from the RenderSnapshot.
+constexpr int ASTEROID_TEXTURE_SIZE = 16;
+
+// Pixel art of the asteroid, generated once by the SpriteRegistry
+inline Image GenerateAsteroidImage()
+{
+    struct Stroke
+    {
+        Vector2 position;
+        Vector2 size;
+        Color color;
+    };
+    const float move_by = 4;
+    const Stroke strokes[] = {
+        {{5, 2 + move_by}, {5, 1}, LIGHTGRAY},
+        {{4, 3 + move_by}, {2, 1}, LIGHTGRAY},
+        {{5, 3 + move_by}, {5, 1}, GRAY},
+        {{10, 3 + move_by}, {1, 1}, LIGHTGRAY},
+        {{4, 4 + move_by}, {2, 1}, LIGHTGRAY},
+        {{5, 4 + move_by}, {5, 1}, GRAY},
+        {{10, 4 + move_by}, {1, 1}, LIGHTGRAY},
+        {{5, 5 + move_by}, {5, 1}, LIGHTGRAY}};
+    Image asteroid_image = GenImageColor(ASTEROID_TEXTURE_SIZE, ASTEROID_TEXTURE_SIZE, BLANK);
+    for (const Stroke &stroke : strokes)
+    {
+        ImageDrawRectangleV(&asteroid_image, stroke.position, stroke.size, stroke.color);
+    }
+    return asteroid_image;
+}
+
+// Sprite shared by every asteroid, registered on the main thread before anything spawns
+inline SpriteHandle GetAsteroidSprite()
+{
+    return SpriteRegistry::GetInstance().GetOrCreate("asteroid", 0, GenerateAsteroidImage);
+}
+
+// Asteroids slowly crumble, a full life lasts this long
+constexpr float ASTEROID_LIFETIME = 1000.0f;
+
+inline Entity CreateAsteroid(EntityWorld &world, float mass, float size, float speed_limit, Vector2 position, WorldSector sector = WorldSector())
+{
+    const float half_texture = ASTEROID_TEXTURE_SIZE / 2.0f;
+    SpriteHandle sprite = GetAsteroidSprite();
+    Entity entity = world.Create(PhysicsBodyComponent{},
+                                 HealthComponent{100.0f, 100.0f},
+                                 ContactDamageComponent{mass * 0.5f},
+                                 LifetimeComponent{ASTEROID_LIFETIME});
+    PhysicsBody body;
+    body.is_alive = true;
+    body.type = ObjectType::ASTEROID_TYPE;
+    body.sector = sector;
+    body.position = position;
+    body.center = {half_texture, half_texture};
+    body.width = size / 2.0f;
+    body.height = size / 2.0f;
+    body.mass = mass;
+    body.speed_limit = speed_limit;
+    body.rotation_speed_limit = 200.0f;
+    // Hull of the pixel art around the texture center
+    const Vector2 hull_points[] = {{-3, -2}, {2, -2}, {3, -1}, {3, 1}, {2, 2}, {-3, 2}, {-4, 1}, {-4, -1}};
+    body.collision = ObjectShape::Polygon;
+    body.polygon = ConvexPolygon::Create(hull_points, 8);
+    body.user_data = entity.ToUserData();
+    body.sprite = {sprite, {half_texture, half_texture}, WHITE, RENDER_LAYER_ASTEROID};
+    world.Get<PhysicsBodyComponent>(entity)->handle = PhysicsSystem::GetInstance().CreatePhysicsObject(body);
+    return entity;
+}
+
+#endif // ASTEROID_H
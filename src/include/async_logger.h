@@ -0,0 +1,267 @@
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include "raylib.h"
+#include <atomic>
+#include <chrono>
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+// Messages below this level are compiled out of GAME_LOG calls, arguments included.
+// Release builds raise it to LOG_INFO, see src/CMakeLists.txt.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_DEBUG
+#endif
+
+#define GAME_LOG(level, ...)                          \
+    do                                                \
+    {                                                 \
+        if constexpr ((level) >= LOG_COMPILE_LEVEL)   \
+            TraceLog((level), __VA_ARGS__);           \
+    } while (0)
+
+// Backend of the raylib TraceLog callback. Any thread formats its message into a slot of
+// a bounded lock-free MPSC ring and returns; a background thread writes the slots out
+// in batches with a single flush each. When the ring is full the message is dropped and
+// counted instead of waiting. Each category, the text before its first ':', may log
+// RATE_LIMIT messages per second, the others are counted and reported in one line.
+class AsyncLogger
+{
+public:
+    static constexpr uint32_t CAPACITY = 1024;
+    static constexpr int MESSAGE_SIZE = 120;
+    static constexpr uint32_t RATE_LIMIT = 20;
+    static constexpr int CATEGORY_SLOTS = 64;
+    // Sleep of the writer when the ring is empty
+    static constexpr int WRITE_INTERVAL_MS = 5;
+
+private:
+    struct Record
+    {
+        int level = 0;
+        char text[MESSAGE_SIZE] = {0};
+    };
+    struct Cell
+    {
+        std::atomic<uint32_t> sequence{0};
+        Record record;
+    };
+    struct Category
+    {
+        std::atomic<uint32_t> window{0};
+        std::atomic<uint32_t> count{0};
+    };
+
+    Cell cells[CAPACITY];
+    alignas(64) std::atomic<uint32_t> enqueue_position{0};
+    // Only touched by the writer
+    alignas(64) uint32_t dequeue_position = 0;
+    Category categories[CATEGORY_SLOTS];
+    std::atomic<uint32_t> dropped{0};
+    std::atomic<uint32_t> rate_limited{0};
+    uint32_t reported_dropped = 0;
+    uint32_t reported_rate_limited = 0;
+    uint32_t rate_limit = RATE_LIMIT;
+    std::atomic<bool> is_running{false};
+    std::thread writer;
+    FILE *output = stdout;
+    // Lines of one batch, kept to avoid allocating on every batch
+    std::string batch;
+
+    AsyncLogger()
+    {
+        for (uint32_t i = 0; i < CAPACITY; i++)
+        {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        batch.reserve(CAPACITY * 32);
+    }
+    ~AsyncLogger()
+    {
+        Stop();
+    }
+
+    static inline const char *GetPrefix(int level)
+    {
+        switch (level)
+        {
+        case LOG_INFO:
+            return "[INFO] : ";
+        case LOG_ERROR:
+            return "[ERROR]: ";
+        case LOG_WARNING:
+            return "[WARN] : ";
+        case LOG_DEBUG:
+            return "[DEBUG]: ";
+        default:
+            return nullptr;
+        }
+    }
+
+    // FNV-1a of the text up to its first ':'
+    static inline uint32_t GetCategory(const char *text)
+    {
+        uint32_t hash = 2166136261u;
+        for (const char *c = text; *c && *c != ':'; c++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*c)) * 16777619u;
+        }
+        return hash;
+    }
+
+    inline bool IsRateLimited(const char *text)
+    {
+        Category &category = categories[GetCategory(text) % CATEGORY_SLOTS];
+        const uint32_t window = static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        uint32_t seen = category.window.load(std::memory_order_relaxed);
+        // The first message of a new second opens the window, a race only lets a few more in
+        if (seen != window && category.window.compare_exchange_strong(seen, window, std::memory_order_relaxed))
+            category.count.store(0, std::memory_order_relaxed);
+        if (category.count.fetch_add(1, std::memory_order_relaxed) < rate_limit)
+            return false;
+        rate_limited.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Write out what the ring holds, returns the messages written
+    inline int WriteBatch()
+    {
+        batch.clear();
+        int written = 0;
+        while (true)
+        {
+            Cell &cell = cells[dequeue_position & (CAPACITY - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != dequeue_position + 1)
+                break;
+            batch += GetPrefix(cell.record.level);
+            batch += cell.record.text;
+            batch += '\n';
+            cell.sequence.store(dequeue_position + CAPACITY, std::memory_order_release);
+            dequeue_position++;
+            written++;
+        }
+        const uint32_t now_dropped = dropped.load(std::memory_order_relaxed);
+        const uint32_t now_rate_limited = rate_limited.load(std::memory_order_relaxed);
+        if (now_dropped != reported_dropped || now_rate_limited != reported_rate_limited)
+        {
+            char line[MESSAGE_SIZE];
+            snprintf(line, sizeof(line), "[WARN] : log skipped %u messages (ring full: %u, rate limited: %u)\n",
+                     (now_dropped - reported_dropped) + (now_rate_limited - reported_rate_limited), now_dropped - reported_dropped, now_rate_limited - reported_rate_limited);
+            batch += line;
+            reported_dropped = now_dropped;
+            reported_rate_limited = now_rate_limited;
+        }
+        if (!batch.empty())
+        {
+            fwrite(batch.data(), 1, batch.size(), output);
+            fflush(output);
+        }
+        return written;
+    }
+
+    void WriterLoop()
+    {
+        while (is_running.load(std::memory_order_acquire))
+        {
+            if (WriteBatch() == 0)
+                std::this_thread::sleep_for(std::chrono::milliseconds(WRITE_INTERVAL_MS));
+        }
+        WriteBatch();
+    }
+
+public:
+    static AsyncLogger &GetInstance()
+    {
+        static AsyncLogger instance;
+        return instance;
+    }
+    AsyncLogger(const AsyncLogger &) = delete;
+    AsyncLogger &operator=(const AsyncLogger &) = delete;
+
+    // Start the writer thread. Without it (web build) Pump writes from the game loop.
+    inline void Start()
+    {
+#ifndef __EMSCRIPTEN__
+        if (is_running.exchange(true))
+            return;
+        writer = std::thread(&AsyncLogger::WriterLoop, this);
+#endif
+    }
+    // Write out what is left and stop the writer thread
+    inline void Stop()
+    {
+        if (is_running.exchange(false))
+            writer.join();
+        WriteBatch();
+    }
+    // Write out from the calling thread, only when no writer thread runs
+    inline void Pump()
+    {
+        if (!is_running.load(std::memory_order_acquire))
+            WriteBatch();
+    }
+
+    // Format and queue a message, never blocks. Returns false when it was skipped.
+    inline bool Log(int level, const char *format, va_list args)
+    {
+        if (GetPrefix(level) == nullptr || IsRateLimited(format))
+            return false;
+        uint32_t position = enqueue_position.load(std::memory_order_relaxed);
+        Cell *cell = nullptr;
+        while (true)
+        {
+            cell = &cells[position & (CAPACITY - 1)];
+            const uint32_t sequence = cell->sequence.load(std::memory_order_acquire);
+            const int32_t difference = static_cast<int32_t>(sequence - position);
+            if (difference == 0)
+            {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (difference < 0)
+            {
+                dropped.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            else
+            {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+        cell->record.level = level;
+        vsnprintf(cell->record.text, MESSAGE_SIZE, format, args);
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    inline bool Log(int level, const char *format, ...)
+    {
+        va_list args;
+        va_start(args, format);
+        bool is_queued = Log(level, format, args);
+        va_end(args);
+        return is_queued;
+    }
+
+    // Where the batches go, only while the writer thread is stopped
+    inline void SetOutput(FILE *in_output)
+    {
+        output = in_output;
+    }
+    inline void SetRateLimit(uint32_t messages_per_second)
+    {
+        rate_limit = messages_per_second;
+    }
+    inline uint32_t GetDroppedCount() const
+    {
+        return dropped.load(std::memory_order_relaxed);
+    }
+    inline uint32_t GetRateLimitedCount() const
+    {
+        return rate_limited.load(std::memory_order_relaxed);
+    }
+};
+
+#endif // ASYNC_LOGGER_H
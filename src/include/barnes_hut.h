@@ -0,0 +1,269 @@
+#ifndef BARNES_HUT_H
+#define BARNES_HUT_H
+
+#include "raylib.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+// Pull of a point mass on (x, y), without the gravitational constant. softening keeps
+// the pull finite when two bodies get very close.
+inline void AddGravityPull(float x, float y, float source_x, float source_y, float mass, float softening_sqr, float &acceleration_x, float &acceleration_y)
+{
+    float dx = source_x - x;
+    float dy = source_y - y;
+    float distance_sqr = dx * dx + dy * dy + softening_sqr;
+    float inverse_cube = 1.0f / (distance_sqr * sqrtf(distance_sqr));
+    acceleration_x += mass * dx * inverse_cube;
+    acceleration_y += mass * dy * inverse_cube;
+}
+
+// Reference O(n^2) sum over every body but self, used to validate the tree
+inline Vector2 ComputeGravityBruteForce(const float *x, const float *y, const float *mass, int count, float point_x, float point_y, int self, float softening)
+{
+    float acceleration_x = 0.0f;
+    float acceleration_y = 0.0f;
+    for (int i = 0; i < count; i++)
+    {
+        if (i != self)
+            AddGravityPull(point_x, point_y, x[i], y[i], mass[i], softening * softening, acceleration_x, acceleration_y);
+    }
+    return {acceleration_x, acceleration_y};
+}
+
+// Quadtree of point masses rebuilt every tick. Each cell keeps the total mass and the
+// center of mass of its bodies, a far enough cell pulls as a single body so the pull on
+// one body costs O(log n). theta is the opening angle: a cell of size s at distance d
+// is used whole when s / d < theta, 0 sums every body exactly.
+class BarnesHutTree
+{
+public:
+    // Bodies closer than the cell size at this depth share a leaf
+    static constexpr int MAX_DEPTH = 24;
+    // Bodies summed one by one in a leaf before it is split, small leaves make deep trees
+    static constexpr int LEAF_CAPACITY = 8;
+
+private:
+    struct Node
+    {
+        // Square cell
+        float center_x = 0.0f;
+        float center_y = 0.0f;
+        float half_size = 0.0f;
+        float mass = 0.0f;
+        float mass_x = 0.0f;
+        float mass_y = 0.0f;
+        // The 4 children are stored next to each other, -1 for a leaf
+        int first_child = -1;
+        // Bodies of a leaf: a linked list through next_body while building, then a
+        // range of the packed arrays
+        int first_body = -1;
+        int body_count = 0;
+    };
+
+    std::vector<Node> nodes;
+    std::vector<float> body_x;
+    std::vector<float> body_y;
+    std::vector<float> body_mass;
+    // Id given by the caller, used to skip the body itself
+    std::vector<int> body_id;
+    std::vector<int> next_body;
+    // Bodies reordered leaf by leaf so a leaf is summed from contiguous memory
+    std::vector<float> packed_x;
+    std::vector<float> packed_y;
+    std::vector<float> packed_mass;
+    std::vector<int> packed_id;
+
+    static inline int Quadrant(const Node &node, float x, float y)
+    {
+        return (x >= node.center_x ? 1 : 0) | (y >= node.center_y ? 2 : 0);
+    }
+
+    void Split(int index)
+    {
+        const Node parent = nodes[index];
+        const float quarter = parent.half_size / 2;
+        const int first_child = static_cast<int>(nodes.size());
+        for (int quadrant = 0; quadrant < 4; quadrant++)
+        {
+            Node child;
+            child.center_x = parent.center_x + ((quadrant & 1) ? quarter : -quarter);
+            child.center_y = parent.center_y + ((quadrant & 2) ? quarter : -quarter);
+            child.half_size = quarter;
+            nodes.push_back(child);
+        }
+        nodes[index].first_child = first_child;
+        nodes[index].first_body = -1;
+        nodes[index].body_count = 0;
+        for (int body = parent.first_body; body >= 0;)
+        {
+            int next = next_body[body];
+            Node &child = nodes[first_child + Quadrant(parent, body_x[body], body_y[body])];
+            next_body[body] = child.first_body;
+            child.first_body = body;
+            child.body_count++;
+            body = next;
+        }
+    }
+
+    void Insert(int body)
+    {
+        int index = 0;
+        int depth = 0;
+        while (true)
+        {
+            if (nodes[index].first_child >= 0)
+            {
+                index = nodes[index].first_child + Quadrant(nodes[index], body_x[body], body_y[body]);
+                depth++;
+                continue;
+            }
+            if (nodes[index].body_count < LEAF_CAPACITY || depth >= MAX_DEPTH)
+            {
+                next_body[body] = nodes[index].first_body;
+                nodes[index].first_body = body;
+                nodes[index].body_count++;
+                return;
+            }
+            Split(index);
+        }
+    }
+
+public:
+    void Clear()
+    {
+        nodes.clear();
+        body_x.clear();
+        body_y.clear();
+        body_mass.clear();
+        body_id.clear();
+        next_body.clear();
+    }
+
+    // Gather the bodies of this tick, then Build
+    void AddBody(int id, float x, float y, float mass)
+    {
+        body_id.push_back(id);
+        body_x.push_back(x);
+        body_y.push_back(y);
+        body_mass.push_back(mass);
+    }
+
+    void Build()
+    {
+        nodes.clear();
+        const int count = GetBodyCount();
+        next_body.assign(count, -1);
+        if (count == 0)
+            return;
+        auto [min_x, max_x] = std::minmax_element(body_x.begin(), body_x.end());
+        auto [min_y, max_y] = std::minmax_element(body_y.begin(), body_y.end());
+        Node root;
+        root.center_x = (*min_x + *max_x) / 2;
+        root.center_y = (*min_y + *max_y) / 2;
+        // Slightly larger so the bodies on the max edges stay inside
+        root.half_size = std::max(*max_x - *min_x, *max_y - *min_y) / 2 + 1.0f;
+        nodes.push_back(root);
+        for (int body = 0; body < count; body++)
+        {
+            Insert(body);
+        }
+        packed_x.clear();
+        packed_y.clear();
+        packed_mass.clear();
+        packed_id.clear();
+        for (Node &node : nodes)
+        {
+            if (node.first_child >= 0)
+                continue;
+            int first_packed = static_cast<int>(packed_id.size());
+            for (int body = node.first_body; body >= 0; body = next_body[body])
+            {
+                packed_x.push_back(body_x[body]);
+                packed_y.push_back(body_y[body]);
+                packed_mass.push_back(body_mass[body]);
+                packed_id.push_back(body_id[body]);
+            }
+            node.first_body = first_packed;
+        }
+        // Children always come after their parent, so a reverse walk sums bottom up
+        for (int index = static_cast<int>(nodes.size()) - 1; index >= 0; index--)
+        {
+            Node &node = nodes[index];
+            float mass = 0.0f;
+            float mass_x = 0.0f;
+            float mass_y = 0.0f;
+            if (node.first_child < 0)
+            {
+                for (int body = node.first_body; body < node.first_body + node.body_count; body++)
+                {
+                    mass += packed_mass[body];
+                    mass_x += packed_mass[body] * packed_x[body];
+                    mass_y += packed_mass[body] * packed_y[body];
+                }
+            }
+            else
+            {
+                for (int child = node.first_child; child < node.first_child + 4; child++)
+                {
+                    mass += nodes[child].mass;
+                    mass_x += nodes[child].mass * nodes[child].mass_x;
+                    mass_y += nodes[child].mass * nodes[child].mass_y;
+                }
+            }
+            node.mass = mass;
+            node.mass_x = mass > 0.0f ? mass_x / mass : node.center_x;
+            node.mass_y = mass > 0.0f ? mass_y / mass : node.center_y;
+        }
+    }
+
+    int GetBodyCount() const { return static_cast<int>(body_id.size()); }
+    int GetNodeCount() const { return static_cast<int>(nodes.size()); }
+
+    // Pull of every body but self_id on (x, y), without the gravitational constant.
+    // Read only, several threads can query the built tree at once.
+    Vector2 GetAcceleration(float x, float y, int self_id, float theta, float softening) const
+    {
+        float acceleration_x = 0.0f;
+        float acceleration_y = 0.0f;
+        if (nodes.empty())
+            return {acceleration_x, acceleration_y};
+        const float theta_sqr = theta * theta;
+        const float softening_sqr = softening * softening;
+        int stack[4 * MAX_DEPTH + 4];
+        int stack_size = 0;
+        stack[stack_size++] = 0;
+        while (stack_size > 0)
+        {
+            const Node &node = nodes[stack[--stack_size]];
+            if (node.mass <= 0.0f)
+                continue;
+            if (node.first_child < 0)
+            {
+                for (int body = node.first_body; body < node.first_body + node.body_count; body++)
+                {
+                    if (packed_id[body] != self_id)
+                        AddGravityPull(x, y, packed_x[body], packed_y[body], packed_mass[body], softening_sqr, acceleration_x, acceleration_y);
+                }
+                continue;
+            }
+            float dx = node.mass_x - x;
+            float dy = node.mass_y - y;
+            float size = node.half_size * 2;
+            // A cell holding the point is always opened, it may hold the body itself
+            bool is_inside = fabsf(x - node.center_x) <= node.half_size && fabsf(y - node.center_y) <= node.half_size;
+            if (!is_inside && size * size < theta_sqr * (dx * dx + dy * dy))
+            {
+                AddGravityPull(x, y, node.mass_x, node.mass_y, node.mass, softening_sqr, acceleration_x, acceleration_y);
+                continue;
+            }
+            for (int child = node.first_child; child < node.first_child + 4; child++)
+            {
+                stack[stack_size++] = child;
+            }
+        }
+        return {acceleration_x, acceleration_y};
+    }
+};
+
+#endif // BARNES_HUT_H
@@ -5,22 +5,10 @@
 #include "dynamic_body.h"
 #include <vector>
 #include "physics_system.h"
+#include "sprite_registry.h"
+#include "event_bus.h"
+#include "async_logger.h"
 #include <memory>
-#include <queue>
-#include "astronomical_object.h"
-
-enum class BulletEventType {
-  COLLISION,
-  END_OF_LIFE,
-  UNKNOWN
-};
-struct BulletEvent {
-  BulletEventType type;
-  std::weak_ptr<PhysicsObject> source;
-  std::weak_ptr<PhysicsObject> target;
-  Vector2 position;
-  float timestamp;
-};
 
 
 class Bullet : public DynamicBody
@@ -29,50 +17,58 @@ private:
     float life_time_base = 2.0f;
 
 public:
-    Texture2D bullet_texture;
     bool is_enabled = false;
     bool is_shooting = false;
     float life_time = 2.0f;
     float damage = 100.0f;
-    std::weak_ptr<PhysicsObject> owner;
-    std::queue<BulletEvent> eventQueue;
+    // Body that fired the bullet, credited with the score of its hits
+    PhysicsHandle owner;
+    // Points for the owner on each hit
+    static constexpr int HIT_SCORE = 10;
+    static constexpr int TEXTURE_SIZE = 16;
 
 public:
-    static std::shared_ptr<Bullet> Create(){
-        std::shared_ptr<Bullet> obj = std::make_shared<Bullet>();
-        obj->physics_id = PhysicsObject::CreatePhysicsId(obj);
-        // TraceLog(LOG_INFO, "Object of type Bullet created");
-        return obj;
-    }
-    Bullet()
+    // Bullets are made once by the BulletPool and fired again and again
+    explicit Bullet(SpriteHandle in_sprite)
     {
-        Image bullet_image = GenImageColor(16, 16, BLANK);
-        ImageDrawRectangleV(&bullet_image, {7, 7}, {2, 2}, RED);
-        if (IsWindowReady() == true)
-        {
-            bullet_texture = LoadTextureFromImage(bullet_image);
-        }
-        else
-        {
-            bullet_texture = {0};
-        }
-
+        // Shared by every bullet, in the atlas of the SpriteRegistry
+        body_sprite = {in_sprite, {TEXTURE_SIZE / 2.0f, TEXTURE_SIZE / 2.0f}, WHITE, RENDER_LAYER_BULLET};
         deceleration_multiplier = 0.0f;
-        UnloadImage(bullet_image);
+        speed_limit = 500.0f;
+        is_fast = true;
 
         object_type = ObjectType::BULLET_TYPE;
         height = 2.0f;
         width = 2.0f;
-        center = {bullet_texture.width / 2.0f, bullet_texture.height / 2.0f};
+        center = {TEXTURE_SIZE / 2.0f, TEXTURE_SIZE / 2.0f};
         is_on_screen = true; // remove when I find a way to spawn the bullets on game manager
     };
     ~Bullet()
     {
-        if (bullet_texture.id > 0)
+        GAME_LOG(LOG_DEBUG, "Bullet destroyed");
+    }
+
+    // Pixel art of the bullet, generated once by the SpriteRegistry
+    static SpriteHandle GetSprite()
+    {
+        return SpriteRegistry::GetInstance().GetOrCreate("bullet", 0, []()
         {
-            UnloadTexture(bullet_texture);
-        }
-        TraceLog(LOG_INFO, "Bullet destroyed");
+            Image bullet_image = GenImageColor(TEXTURE_SIZE, TEXTURE_SIZE, BLANK);
+            ImageDrawRectangleV(&bullet_image, {7, 7}, {2, 2}, RED);
+            return bullet_image;
+        });
+    }
+
+    // Take a physics slot at position and fly along direction. The slot goes back to the
+    // PhysicsSystem free list on Destroy.
+    void Fire(WorldSector in_sector, Vector2 in_position, float in_rotation, Vector2 direction, float force)
+    {
+        sector = in_sector;
+        position = in_position;
+        rotation = in_rotation;
+        physics_id = PhysicsObject::CreatePhysicsId(shared_from_this());
+        SetEnabled(true);
+        PhysicsSystem::GetInstance().ApplyForce(physics_id, force, direction);
     }
 
     void Update(float delta_time) override
@@ -83,6 +79,7 @@ public:
         life_time -= delta_time;
         if (life_time <= 0)
         {
+            EventBus::GetInstance().Push(EndOfLifeEvent{physics_id, GetBodyPosition()});
             Destroy();
         }
         rotation = rotation;
@@ -94,30 +91,6 @@ public:
         DynamicBody::FixUpdate(delta_time);
     }
 
-    void Render() override
-    {
-        if (!IsWindowReady())
-            return;
-        if (!is_enabled)
-            return;
-        if (!is_on_screen)
-            return;
-        // Draw rotated texture
-        DrawTexturePro(
-            bullet_texture,
-            Rectangle({0, 0, static_cast<float>(bullet_texture.width), static_cast<float>(bullet_texture.height)}),                   // Source rectangle (full texture)
-            Rectangle({position.x, position.y, static_cast<float>(bullet_texture.width), static_cast<float>(bullet_texture.height)}), // Destination rectangle (position and size)
-            {bullet_texture.width / 2.0f, bullet_texture.height / 2.0f},                                                              // Origin of rotation (center of the texture)
-            rotation,                                                                                                                 // Rotation in degrees
-            WHITE                                                                                                                     // Tint color
-        );
-
-        // Update bullet rotation (optional)
-        // bulletRotation = atan2f(direction.y, bulletDirection.x) * RAD2DEG;
-        // float bullet_color[4] = { 1.0f, 0.0f, 0.0f, 1.0f }; 
-        // float bullet_position[2] = {position.x, position.y};
-    }
-
     void SetEnabled(bool enabled)
     {
         is_enabled = enabled;
@@ -137,28 +110,35 @@ public:
         {
             if(object->is_alive)
             {
-                object->TakeDamage(damage, position);
-                if(std::shared_ptr<PhysicsObject> shared_owner = owner.lock())
-                {
-                    if(shared_owner->object_type == ObjectType::PLAYER_TYPE)
-                    {
-                        // Trigger a collision event
-                        BulletEvent collisionEvent;
-                        collisionEvent.type = BulletEventType::COLLISION;
-                        collisionEvent.source = shared_from_this();
-                        collisionEvent.target = object;
-                        collisionEvent.position = position;
-                        collisionEvent.timestamp = GetTime(); 
-                        eventQueue.push(collisionEvent); 
-                    }
-                }
+                // No contact point on this path, the body is where it hit
+                Vector2 point = GetBodyPosition();
+                object->TakeDamage(damage, point);
+                OnHit(object->physics_id, point);
             }
         }
     }
+    // The bullet reached the body of target at point and is spent. Its body is removed at
+    // once so it leaves the next RenderSnapshot, the owner is paid through the EventBus.
+    void OnHit(PhysicsHandle target, Vector2 point)
+    {
+        if (!is_enabled)
+            return;
+        EventBus &events = EventBus::GetInstance();
+        events.Push(CollisionEvent{physics_id, target, point});
+        if (owner.IsValid())
+            events.Push(ScoreEvent{owner, HIT_SCORE});
+        Destroy();
+    }
+    // Where the physics body is now, position is only the muzzle it was fired from
+    Vector2 GetBodyPosition() const
+    {
+        return PhysicsSystem::GetInstance().GetPhysicsObject(physics_id).position;
+    }
     void Destroy()
     {
+        is_enabled = false;
         PhysicsSystem::GetInstance().RemoveObject(physics_id);
-        physics_id = -1; // reset physics id
+        physics_id = PhysicsHandle(); // reset physics id
     }
 };
 
@@ -0,0 +1,92 @@
+#ifndef BULLET_POOL_H
+#define BULLET_POOL_H
+
+#include "raylib.h"
+#include <memory>
+#include <vector>
+#include "bullet.h"
+#include "physics_system.h"
+
+// Every bullet of the game, made once with one shared sprite. Firing takes a free
+// bullet and a recycled physics slot: no heap allocation and no texture upload per shot.
+class BulletPool
+{
+public:
+    // 2 s of life at a 0.1 s cooldown keeps 20 bullets in flight
+    static constexpr int CAPACITY = 64;
+
+private:
+    std::vector<std::shared_ptr<Bullet>> bullets;
+    std::vector<int> free_bullets;
+    SpriteHandle sprite;
+
+public:
+    BulletPool()
+    {
+        sprite = Bullet::GetSprite();
+        bullets.reserve(CAPACITY);
+        free_bullets.reserve(CAPACITY);
+        for (int i = 0; i < CAPACITY; i++)
+        {
+            bullets.push_back(std::make_shared<Bullet>(sprite));
+        }
+        // Handed out from the back, lowest index first
+        for (int i = CAPACITY - 1; i >= 0; i--)
+        {
+            free_bullets.push_back(i);
+        }
+    }
+    ~BulletPool()
+    {
+        bullets.clear();
+    }
+    BulletPool(const BulletPool &) = delete;
+    BulletPool &operator=(const BulletPool &) = delete;
+
+    // Index of a free bullet, -1 when they are all in flight
+    int Acquire()
+    {
+        if (free_bullets.empty())
+            return -1;
+        int index = free_bullets.back();
+        free_bullets.pop_back();
+        return index;
+    }
+    // Give a bullet back, its physics body is removed if it still has one
+    void Release(int index)
+    {
+        Bullet &bullet = *bullets[index];
+        if (bullet.physics_id.IsValid())
+            bullet.Destroy();
+        bullet.is_enabled = false;
+        bullet.owner = PhysicsHandle();
+        free_bullets.push_back(index);
+    }
+    // Every bullet back to the pool, after the PhysicsSystem was unloaded
+    void Reset()
+    {
+        free_bullets.clear();
+        for (int i = CAPACITY - 1; i >= 0; i--)
+        {
+            bullets[i]->physics_id = PhysicsHandle();
+            bullets[i]->is_enabled = false;
+            bullets[i]->owner = PhysicsHandle();
+            free_bullets.push_back(i);
+        }
+    }
+
+    Bullet &Get(int index)
+    {
+        return *bullets[index];
+    }
+    int GetActiveCount() const
+    {
+        return CAPACITY - static_cast<int>(free_bullets.size());
+    }
+    SpriteHandle GetSprite() const
+    {
+        return sprite;
+    }
+};
+
+#endif // BULLET_POOL_H
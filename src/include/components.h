@@ -0,0 +1,47 @@
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "raylib.h"
+#include "physics_handle.h"
+
+// Components of the game entities, see EntityWorld. The ids are the bits of the
+// archetype masks. Where an entity is and what it looks like live in its physics body,
+// the renderer reads them from the RenderSnapshot.
+enum ComponentId
+{
+    COMPONENT_PHYSICS_BODY,
+    COMPONENT_HEALTH,
+    COMPONENT_CONTACT_DAMAGE,
+    COMPONENT_LIFETIME
+};
+
+// Body simulated by the PhysicsSystem, removed with the entity
+struct PhysicsBodyComponent
+{
+    static constexpr int ID = COMPONENT_PHYSICS_BODY;
+    PhysicsHandle handle;
+};
+
+// Destroyed once life reaches 0
+struct HealthComponent
+{
+    static constexpr int ID = COMPONENT_HEALTH;
+    float life = 100.0f;
+    float max_life = 100.0f;
+};
+
+// Dealt to the player on contact, the entity is destroyed by the hit
+struct ContactDamageComponent
+{
+    static constexpr int ID = COMPONENT_CONTACT_DAMAGE;
+    float damage = 0.0f;
+};
+
+// Destroyed once remaining reaches 0
+struct LifetimeComponent
+{
+    static constexpr int ID = COMPONENT_LIFETIME;
+    float remaining = 0.0f;
+};
+
+#endif // COMPONENTS_H
@@ -0,0 +1,165 @@
+#ifndef CONVEX_POLYGON_H
+#define CONVEX_POLYGON_H
+
+#include "raylib.h"
+#include "raymath.h"
+#include <math.h>
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
+// Convex hull stored inline, no heap memory: vertices are local to the collision
+// center of the body (position + center) in clockwise screen order, and each edge
+// normal is precomputed. Two vertices make a segment (ObjectShape::Lines).
+struct ConvexPolygon
+{
+    static constexpr int MAX_VERTICES = 8;
+    Vector2 vertices[MAX_VERTICES] = {};
+    Vector2 normals[MAX_VERTICES] = {};
+    int count = 0;
+    // Farthest vertex from the local origin, the hull fits in this circle at any rotation
+    float radius = 0.0f;
+
+    // Build a hull from up to MAX_VERTICES convex points in either winding. More points
+    // would be cut to a different hull, the caller has to simplify the shape first.
+    static ConvexPolygon Create(const Vector2 *points, int point_count)
+    {
+        assert(point_count <= MAX_VERTICES && "ConvexPolygon holds at most MAX_VERTICES points");
+        ConvexPolygon polygon;
+        polygon.count = std::min(point_count, MAX_VERTICES);
+        float area = 0.0f;
+        for (int i = 0; i < polygon.count; i++)
+        {
+            polygon.vertices[i] = points[i];
+            const Vector2 &next = points[(i + 1) % polygon.count];
+            area += points[i].x * next.y - next.x * points[i].y;
+            polygon.radius = std::max(polygon.radius, Vector2Length(points[i]));
+        }
+        // Keep one winding so every normal points out of the hull
+        if (area < 0.0f)
+            std::reverse(polygon.vertices, polygon.vertices + polygon.count);
+        for (int i = 0; i < polygon.count; i++)
+        {
+            Vector2 edge = Vector2Subtract(polygon.vertices[(i + 1) % polygon.count], polygon.vertices[i]);
+            polygon.normals[i] = Vector2Normalize({edge.y, -edge.x});
+        }
+        return polygon;
+    }
+    // Regular polygon of vertex_count vertices on a circle of radius
+    static ConvexPolygon CreateRegular(int vertex_count, float in_radius)
+    {
+        Vector2 points[MAX_VERTICES];
+        vertex_count = std::clamp(vertex_count, 3, MAX_VERTICES);
+        for (int i = 0; i < vertex_count; i++)
+        {
+            float angle = 2.0f * PI * i / vertex_count;
+            points[i] = {cosf(angle) * in_radius, sinf(angle) * in_radius};
+        }
+        return Create(points, vertex_count);
+    }
+};
+
+// Hull placed in the world, lives on the stack while two shapes are tested
+struct WorldPolygon
+{
+    Vector2 vertices[ConvexPolygon::MAX_VERTICES];
+    Vector2 normals[ConvexPolygon::MAX_VERTICES];
+    int count = 0;
+
+    // rotation in degrees, clockwise on screen like the body rotation
+    static WorldPolygon FromPolygon(const ConvexPolygon &polygon, Vector2 origin, float rotation)
+    {
+        WorldPolygon world;
+        world.count = polygon.count;
+        float cosine = cosf(rotation * DEG2RAD);
+        float sine = sinf(rotation * DEG2RAD);
+        for (int i = 0; i < polygon.count; i++)
+        {
+            const Vector2 &vertex = polygon.vertices[i];
+            const Vector2 &normal = polygon.normals[i];
+            world.vertices[i] = {origin.x + vertex.x * cosine - vertex.y * sine, origin.y + vertex.x * sine + vertex.y * cosine};
+            world.normals[i] = {normal.x * cosine - normal.y * sine, normal.x * sine + normal.y * cosine};
+        }
+        return world;
+    }
+    static WorldPolygon FromRectangle(Rectangle rectangle)
+    {
+        WorldPolygon world;
+        world.count = 4;
+        world.vertices[0] = {rectangle.x, rectangle.y};
+        world.vertices[1] = {rectangle.x + rectangle.width, rectangle.y};
+        world.vertices[2] = {rectangle.x + rectangle.width, rectangle.y + rectangle.height};
+        world.vertices[3] = {rectangle.x, rectangle.y + rectangle.height};
+        world.normals[0] = {0.0f, -1.0f};
+        world.normals[1] = {1.0f, 0.0f};
+        world.normals[2] = {0.0f, 1.0f};
+        world.normals[3] = {-1.0f, 0.0f};
+        return world;
+    }
+
+    void Project(Vector2 axis, float &min, float &max) const
+    {
+        min = max = Vector2DotProduct(vertices[0], axis);
+        for (int i = 1; i < count; i++)
+        {
+            float projection = Vector2DotProduct(vertices[i], axis);
+            min = std::min(min, projection);
+            max = std::max(max, projection);
+        }
+    }
+};
+
+// Separating axis test over the edge normals of both hulls
+inline bool CheckCollisionPolygons(const WorldPolygon &a, const WorldPolygon &b)
+{
+    if (a.count == 0 || b.count == 0)
+        return false;
+    const WorldPolygon *hulls[2] = {&a, &b};
+    for (const WorldPolygon *hull : hulls)
+    {
+        for (int i = 0; i < hull->count; i++)
+        {
+            float min_a, max_a, min_b, max_b;
+            a.Project(hull->normals[i], min_a, max_a);
+            b.Project(hull->normals[i], min_b, max_b);
+            if (max_a < min_b || max_b < min_a)
+                return false;
+        }
+    }
+    return true;
+}
+
+// Separating axis test with the edge normals and the axis to the closest vertex
+inline bool CheckCollisionPolygonCircle(const WorldPolygon &polygon, Vector2 center, float radius)
+{
+    if (polygon.count == 0)
+        return false;
+    float closest_distance = INFINITY;
+    Vector2 closest_vertex = polygon.vertices[0];
+    for (int i = 0; i < polygon.count; i++)
+    {
+        float distance = Vector2DistanceSqr(polygon.vertices[i], center);
+        if (distance < closest_distance)
+        {
+            closest_distance = distance;
+            closest_vertex = polygon.vertices[i];
+        }
+    }
+    Vector2 axes[ConvexPolygon::MAX_VERTICES + 1];
+    int axis_count = 0;
+    for (int i = 0; i < polygon.count; i++)
+        axes[axis_count++] = polygon.normals[i];
+    if (closest_distance > 0.0f)
+        axes[axis_count++] = Vector2Normalize(Vector2Subtract(center, closest_vertex));
+    for (int i = 0; i < axis_count; i++)
+    {
+        float min, max;
+        polygon.Project(axes[i], min, max);
+        float projected_center = Vector2DotProduct(center, axes[i]);
+        if (projected_center + radius < min || projected_center - radius > max)
+            return false;
+    }
+    return true;
+}
+
+#endif // CONVEX_POLYGON_H
@@ -0,0 +1,444 @@
+#ifndef DYNAMIC_AABB_TREE_H
+#define DYNAMIC_AABB_TREE_H
+
+#include "raylib.h"
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+// Bounding volume hierarchy of axis aligned boxes. Each item is a leaf (proxy) holding a
+// fat box: its bounds grown by a margin and stretched along its last move, so a moving
+// item is only reinserted once it leaves that box. The tree is kept balanced by
+// rotations, a query visits O(log n) nodes whatever the sizes of the items.
+class DynamicAabbTree
+{
+public:
+    static constexpr int NULL_NODE = -1;
+
+    // Per-thread query state, so several threads can query the same tree at once
+    struct QueryContext
+    {
+        std::vector<int> stack;
+    };
+
+private:
+    struct Box
+    {
+        float min_x;
+        float min_y;
+        float max_x;
+        float max_y;
+    };
+    struct Node
+    {
+        Box box;
+        // Next free node while the node is unused
+        int parent = NULL_NODE;
+        int child_1 = NULL_NODE;
+        int child_2 = NULL_NODE;
+        // Leaves are 0, free nodes -1
+        int height = -1;
+        int item = -1;
+
+        bool IsLeaf() const { return child_1 == NULL_NODE; }
+    };
+
+    std::vector<Node> nodes;
+    int root = NULL_NODE;
+    int free_list = NULL_NODE;
+    int proxy_count = 0;
+    // Grown around the bounds of every item
+    float margin;
+    // How many moves ahead the fat box is stretched along the last move
+    float displacement_multiplier;
+    // Context of the single threaded Query overloads
+    QueryContext default_context;
+
+    static inline Box ToBox(Rectangle bounds)
+    {
+        return {bounds.x, bounds.y, bounds.x + bounds.width, bounds.y + bounds.height};
+    }
+    static inline Box Union(const Box &a, const Box &b)
+    {
+        return {std::min(a.min_x, b.min_x), std::min(a.min_y, b.min_y), std::max(a.max_x, b.max_x), std::max(a.max_y, b.max_y)};
+    }
+    static inline float Perimeter(const Box &box)
+    {
+        return 2.0f * ((box.max_x - box.min_x) + (box.max_y - box.min_y));
+    }
+    static inline bool Contains(const Box &outer, const Box &inner)
+    {
+        return outer.min_x <= inner.min_x && outer.min_y <= inner.min_y && inner.max_x <= outer.max_x && inner.max_y <= outer.max_y;
+    }
+    static inline bool Overlaps(const Box &a, const Box &b)
+    {
+        return a.min_x <= b.max_x && b.min_x <= a.max_x && a.min_y <= b.max_y && b.min_y <= a.max_y;
+    }
+
+    // Slab test of the segment start + delta * t, t in [0, max_fraction]
+    static inline bool SegmentOverlaps(const Box &box, Vector2 start, Vector2 delta, float max_fraction)
+    {
+        float enter = 0.0f;
+        float exit = max_fraction;
+        const float starts[2] = {start.x, start.y};
+        const float deltas[2] = {delta.x, delta.y};
+        const float mins[2] = {box.min_x, box.min_y};
+        const float maxs[2] = {box.max_x, box.max_y};
+        for (int axis = 0; axis < 2; axis++)
+        {
+            if (deltas[axis] == 0.0f)
+            {
+                if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+                    return false;
+                continue;
+            }
+            float inverse_delta = 1.0f / deltas[axis];
+            float t0 = (mins[axis] - starts[axis]) * inverse_delta;
+            float t1 = (maxs[axis] - starts[axis]) * inverse_delta;
+            if (t0 > t1)
+                std::swap(t0, t1);
+            enter = std::max(enter, t0);
+            exit = std::min(exit, t1);
+            if (enter > exit)
+                return false;
+        }
+        return true;
+    }
+
+    inline Box Fatten(const Box &box, Vector2 displacement) const
+    {
+        Box fat = {box.min_x - margin, box.min_y - margin, box.max_x + margin, box.max_y + margin};
+        float dx = displacement.x * displacement_multiplier;
+        float dy = displacement.y * displacement_multiplier;
+        if (dx < 0.0f)
+            fat.min_x += dx;
+        else
+            fat.max_x += dx;
+        if (dy < 0.0f)
+            fat.min_y += dy;
+        else
+            fat.max_y += dy;
+        return fat;
+    }
+
+    inline int AllocateNode()
+    {
+        if (free_list == NULL_NODE)
+        {
+            nodes.emplace_back();
+            free_list = static_cast<int>(nodes.size()) - 1;
+            nodes[free_list].parent = NULL_NODE;
+        }
+        int index = free_list;
+        free_list = nodes[index].parent;
+        nodes[index] = Node();
+        nodes[index].height = 0;
+        return index;
+    }
+    inline void FreeNode(int index)
+    {
+        nodes[index].parent = free_list;
+        nodes[index].height = -1;
+        free_list = index;
+    }
+
+    // Walk down to the sibling that grows the total perimeter the least
+    void InsertLeaf(int leaf)
+    {
+        if (root == NULL_NODE)
+        {
+            root = leaf;
+            nodes[root].parent = NULL_NODE;
+            return;
+        }
+        const Box leaf_box = nodes[leaf].box;
+        int index = root;
+        while (!nodes[index].IsLeaf())
+        {
+            const Node &node = nodes[index];
+            float area = Perimeter(node.box);
+            float combined_area = Perimeter(Union(node.box, leaf_box));
+            // Cost of pairing the leaf with this node, and the growth pushed on the ancestors
+            float cost = 2.0f * combined_area;
+            float inheritance_cost = 2.0f * (combined_area - area);
+            float child_costs[2];
+            const int children[2] = {node.child_1, node.child_2};
+            for (int i = 0; i < 2; i++)
+            {
+                const Node &child = nodes[children[i]];
+                float grown = Perimeter(Union(leaf_box, child.box));
+                child_costs[i] = (child.IsLeaf() ? grown : grown - Perimeter(child.box)) + inheritance_cost;
+            }
+            if (cost < child_costs[0] && cost < child_costs[1])
+                break;
+            index = child_costs[0] < child_costs[1] ? children[0] : children[1];
+        }
+
+        int sibling = index;
+        int old_parent = nodes[sibling].parent;
+        int new_parent = AllocateNode();
+        nodes[new_parent].parent = old_parent;
+        nodes[new_parent].box = Union(leaf_box, nodes[sibling].box);
+        nodes[new_parent].height = nodes[sibling].height + 1;
+        nodes[new_parent].child_1 = sibling;
+        nodes[new_parent].child_2 = leaf;
+        nodes[sibling].parent = new_parent;
+        nodes[leaf].parent = new_parent;
+        if (old_parent == NULL_NODE)
+        {
+            root = new_parent;
+        }
+        else if (nodes[old_parent].child_1 == sibling)
+        {
+            nodes[old_parent].child_1 = new_parent;
+        }
+        else
+        {
+            nodes[old_parent].child_2 = new_parent;
+        }
+        Refit(nodes[leaf].parent);
+    }
+
+    void RemoveLeaf(int leaf)
+    {
+        if (leaf == root)
+        {
+            root = NULL_NODE;
+            return;
+        }
+        int parent = nodes[leaf].parent;
+        int grand_parent = nodes[parent].parent;
+        int sibling = nodes[parent].child_1 == leaf ? nodes[parent].child_2 : nodes[parent].child_1;
+        FreeNode(parent);
+        nodes[sibling].parent = grand_parent;
+        if (grand_parent == NULL_NODE)
+        {
+            root = sibling;
+            return;
+        }
+        if (nodes[grand_parent].child_1 == parent)
+            nodes[grand_parent].child_1 = sibling;
+        else
+            nodes[grand_parent].child_2 = sibling;
+        Refit(grand_parent);
+    }
+
+    // Rebalance and recompute boxes and heights from index up to the root
+    inline void Refit(int index)
+    {
+        while (index != NULL_NODE)
+        {
+            index = Balance(index);
+            Node &node = nodes[index];
+            node.height = 1 + std::max(nodes[node.child_1].height, nodes[node.child_2].height);
+            node.box = Union(nodes[node.child_1].box, nodes[node.child_2].box);
+            index = node.parent;
+        }
+    }
+
+    // Rotate the taller child of a up when the heights of its children differ by more than one
+    int Balance(int a)
+    {
+        const Node &node = nodes[a];
+        if (node.IsLeaf() || node.height < 2)
+            return a;
+        int balance = nodes[node.child_2].height - nodes[node.child_1].height;
+        if (balance > 1)
+            return Rotate(a, node.child_2);
+        if (balance < -1)
+            return Rotate(a, node.child_1);
+        return a;
+    }
+    // up takes the place of its parent a, which keeps the lower child of up
+    int Rotate(int a, int up)
+    {
+        Node &node_a = nodes[a];
+        Node &node_up = nodes[up];
+        int other = node_a.child_1 == up ? node_a.child_2 : node_a.child_1;
+        int &up_slot = node_a.child_1 == up ? node_a.child_1 : node_a.child_2;
+        int keep = nodes[node_up.child_1].height > nodes[node_up.child_2].height ? node_up.child_1 : node_up.child_2;
+        int move = keep == node_up.child_1 ? node_up.child_2 : node_up.child_1;
+
+        node_up.child_1 = a;
+        node_up.child_2 = keep;
+        node_up.parent = node_a.parent;
+        node_a.parent = up;
+        if (node_up.parent == NULL_NODE)
+        {
+            root = up;
+        }
+        else if (nodes[node_up.parent].child_1 == a)
+        {
+            nodes[node_up.parent].child_1 = up;
+        }
+        else
+        {
+            nodes[node_up.parent].child_2 = up;
+        }
+        up_slot = move;
+        nodes[move].parent = a;
+
+        node_a.box = Union(nodes[other].box, nodes[move].box);
+        node_a.height = 1 + std::max(nodes[other].height, nodes[move].height);
+        node_up.box = Union(node_a.box, nodes[keep].box);
+        node_up.height = 1 + std::max(node_a.height, nodes[keep].height);
+        return up;
+    }
+
+public:
+    DynamicAabbTree(float in_margin = 2.0f, float in_displacement_multiplier = 2.0f)
+        : margin(in_margin), displacement_multiplier(in_displacement_multiplier) {}
+
+    void Clear()
+    {
+        nodes.clear();
+        root = NULL_NODE;
+        free_list = NULL_NODE;
+        proxy_count = 0;
+    }
+
+    // Add item with its bounds, returns the proxy to move or destroy it later
+    int CreateProxy(Rectangle bounds, int item, Vector2 displacement = {0.0f, 0.0f})
+    {
+        int proxy = AllocateNode();
+        nodes[proxy].box = Fatten(ToBox(bounds), displacement);
+        nodes[proxy].item = item;
+        InsertLeaf(proxy);
+        proxy_count++;
+        return proxy;
+    }
+    void DestroyProxy(int proxy)
+    {
+        RemoveLeaf(proxy);
+        FreeNode(proxy);
+        proxy_count--;
+    }
+    // Returns true when the proxy was reinserted: the bounds left the fat box, or the fat
+    // box is much larger than needed (a fast item that slowed down)
+    bool MoveProxy(int proxy, Rectangle bounds, Vector2 displacement)
+    {
+        const Box box = ToBox(bounds);
+        const Box &tree_box = nodes[proxy].box;
+        Box fat = Fatten(box, displacement);
+        if (Contains(tree_box, box))
+        {
+            const float slack = 4.0f * margin;
+            Box huge = {fat.min_x - slack, fat.min_y - slack, fat.max_x + slack, fat.max_y + slack};
+            if (Contains(huge, tree_box))
+                return false;
+        }
+        RemoveLeaf(proxy);
+        nodes[proxy].box = fat;
+        InsertLeaf(proxy);
+        return true;
+    }
+
+    // Move every box by offset when the coordinates the items use change origin. The
+    // shape of the tree does not depend on the origin, nothing is reinserted.
+    void ShiftOrigin(Vector2 offset)
+    {
+        for (Node &node : nodes)
+        {
+            if (node.height < 0)
+                continue;
+            node.box.min_x += offset.x;
+            node.box.min_y += offset.y;
+            node.box.max_x += offset.x;
+            node.box.max_y += offset.y;
+        }
+    }
+
+    Rectangle GetFatBounds(int proxy) const
+    {
+        const Box &box = nodes[proxy].box;
+        return {box.min_x, box.min_y, box.max_x - box.min_x, box.max_y - box.min_y};
+    }
+    int GetItem(int proxy) const { return nodes[proxy].item; }
+    int GetProxyCount() const { return proxy_count; }
+    // Longest path from the root to a leaf, 0 for a single item
+    int GetHeight() const { return root == NULL_NODE ? 0 : nodes[root].height; }
+
+    // Call callback(item) once for every item whose fat box overlaps bounds
+    template <typename Callback>
+    void Query(Rectangle bounds, Callback callback)
+    {
+        Query(bounds, default_context, callback);
+    }
+
+    // Same as Query, safe to call from several threads with one context each
+    // as long as nothing is inserted or moved meanwhile
+    template <typename Callback>
+    void Query(Rectangle bounds, QueryContext &context, Callback callback) const
+    {
+        if (root == NULL_NODE)
+            return;
+        const Box box = ToBox(bounds);
+        std::vector<int> &stack = context.stack;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            const Node &node = nodes[stack.back()];
+            stack.pop_back();
+            if (!Overlaps(node.box, box))
+                continue;
+            if (node.IsLeaf())
+            {
+                callback(node.item);
+            }
+            else
+            {
+                stack.push_back(node.child_1);
+                stack.push_back(node.child_2);
+            }
+        }
+    }
+
+    // Call callback(item, max_fraction) for every item whose fat box the segment from start
+    // to end crosses before max_fraction. callback returns the fraction of its own hit to
+    // clip the segment, or max_fraction to keep it, so boxes behind the closest hit are skipped.
+    template <typename Callback>
+    void RayCast(Vector2 start, Vector2 end, QueryContext &context, Callback callback) const
+    {
+        if (root == NULL_NODE)
+            return;
+        const Vector2 delta = {end.x - start.x, end.y - start.y};
+        float max_fraction = 1.0f;
+        std::vector<int> &stack = context.stack;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            const Node &node = nodes[stack.back()];
+            stack.pop_back();
+            if (!SegmentOverlaps(node.box, start, delta, max_fraction))
+                continue;
+            if (node.IsLeaf())
+            {
+                max_fraction = std::min(max_fraction, callback(node.item, max_fraction));
+                // Nothing can be closer than a hit at the start
+                if (max_fraction <= 0.0f)
+                    return;
+            }
+            else
+            {
+                stack.push_back(node.child_1);
+                stack.push_back(node.child_2);
+            }
+        }
+    }
+
+    // Call callback(item) for every item whose fat box holds point
+    template <typename Callback>
+    void QueryPoint(Vector2 point, QueryContext &context, Callback callback) const
+    {
+        Query({point.x, point.y, 0.0f, 0.0f}, context, callback);
+    }
+    template <typename Callback>
+    void QueryPoint(Vector2 point, Callback callback)
+    {
+        QueryPoint(point, default_context, callback);
+    }
+};
+
+#endif // DYNAMIC_AABB_TREE_H
@@ -30,11 +30,6 @@ public:
         PhysicsObject::FixUpdate(delta_time);
     }
 
-    void Render() override
-    {
-        // Call the base class version
-        PhysicsObject::Render();
-    }
     void EnterCollision(std::shared_ptr<PhysicsObject> other) override
     {
         // Call the base class version
@@ -0,0 +1,122 @@
+#ifndef ENTITY_LIFECYCLE_H
+#define ENTITY_LIFECYCLE_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "entity_world.h"
+#include "components.h"
+#include "physics_object.h"
+#include "physics_system.h"
+
+// Destroy an entity with its physics body
+inline void DestroyEntity(EntityWorld &world, Entity entity)
+{
+    if (PhysicsBodyComponent *body = world.Get<PhysicsBodyComponent>(entity))
+        PhysicsSystem::GetInstance().RemoveObject(body->handle);
+    world.Destroy(entity);
+}
+
+// Entities and game objects are not destroyed where they die: they are queued here and
+// released together at the end of the frame, within a time budget. What does not fit
+// in the budget waits for the next frame, so a wave of deaths never spikes a frame.
+// Lists are compacted by swap-and-pop, so nothing dead is kept around.
+class EntityLifecycle
+{
+public:
+    // End of frame time given to releasing, in seconds
+    static constexpr double DEFAULT_BUDGET = 0.001;
+    // Releases between two reads of the clock
+    static constexpr int CLOCK_STRIDE = 32;
+
+private:
+    std::vector<Entity> pending_entities;
+    // Generation + 1 of the queued entity per index, 0 when not queued
+    std::vector<uint32_t> pending_marks;
+    std::vector<std::shared_ptr<PhysicsObject>> pending_objects;
+    int destroyed_count = 0;
+
+public:
+    // Queue an entity, asking twice or for a dead entity does nothing
+    inline void QueueDestroy(const EntityWorld &world, Entity entity)
+    {
+        if (!world.IsAlive(entity) || IsPendingDestroy(entity))
+            return;
+        if (entity.index >= pending_marks.size())
+            pending_marks.resize(entity.index + 1, 0);
+        pending_marks[entity.index] = entity.generation + 1;
+        pending_entities.push_back(entity);
+    }
+    // Queue a game object, removed from the list it lives in when released
+    inline void QueueDestroy(std::shared_ptr<PhysicsObject> object)
+    {
+        if (!object)
+            return;
+        for (const std::shared_ptr<PhysicsObject> &pending : pending_objects)
+        {
+            if (pending == object)
+                return;
+        }
+        pending_objects.push_back(object);
+    }
+    inline bool IsPendingDestroy(Entity entity) const
+    {
+        return entity.index < pending_marks.size() && pending_marks[entity.index] == entity.generation + 1;
+    }
+
+    // Release what is queued until budget seconds are spent, returns how many were
+    // released. Game objects go first: there are few and they hold the most.
+    inline int Flush(EntityWorld &world, std::vector<std::shared_ptr<PhysicsObject>> &objects, double budget = DEFAULT_BUDGET)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        int released = 0;
+        for (const std::shared_ptr<PhysicsObject> &object : pending_objects)
+        {
+            PhysicsSystem::GetInstance().RemoveObject(object->physics_id);
+            for (size_t i = 0; i < objects.size(); i++)
+            {
+                if (objects[i] != object)
+                    continue;
+                objects[i] = objects.back();
+                objects.pop_back();
+                break;
+            }
+            released++;
+        }
+        pending_objects.clear();
+        while (!pending_entities.empty())
+        {
+            if (released % CLOCK_STRIDE == 0 && released > 0)
+            {
+                std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+                if (elapsed.count() >= budget)
+                    break;
+            }
+            Entity entity = pending_entities.back();
+            pending_entities.pop_back();
+            pending_marks[entity.index] = 0;
+            DestroyEntity(world, entity);
+            released++;
+        }
+        destroyed_count += released;
+        return released;
+    }
+    // Release everything queued, whatever it takes
+    inline int FlushAll(EntityWorld &world, std::vector<std::shared_ptr<PhysicsObject>> &objects)
+    {
+        return Flush(world, objects, 1.0e30);
+    }
+
+    inline int GetPendingCount() const
+    {
+        return static_cast<int>(pending_entities.size() + pending_objects.size());
+    }
+    // Released since the start
+    inline int GetDestroyedCount() const
+    {
+        return destroyed_count;
+    }
+};
+
+#endif // ENTITY_LIFECYCLE_H
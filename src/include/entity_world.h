@@ -0,0 +1,341 @@
+#ifndef ENTITY_WORLD_H
+#define ENTITY_WORLD_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Generational id of an entity, recycled like a PhysicsHandle: the index is reused
+// once the entity is destroyed, the generation is not.
+struct Entity
+{
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    inline bool IsValid() const
+    {
+        return index != INVALID_INDEX;
+    }
+    inline bool operator==(const Entity &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    inline bool operator!=(const Entity &other) const
+    {
+        return !(*this == other);
+    }
+    // Packed for PhysicsBody::user_data, generations start at 1 so 0 is never an entity
+    inline uint64_t ToUserData() const
+    {
+        return (static_cast<uint64_t>(generation) << 32) | index;
+    }
+    static inline Entity FromUserData(uint64_t user_data)
+    {
+        return {static_cast<uint32_t>(user_data), static_cast<uint32_t>(user_data >> 32)};
+    }
+};
+
+// Components are plain data, moved with memcpy when an entity changes archetype. Each
+// one names its slot in the mask: static constexpr int ID, below MAX_COMPONENTS.
+using ComponentMask = uint32_t;
+constexpr int MAX_COMPONENTS = 32;
+
+template <typename T>
+inline constexpr ComponentMask ComponentBit()
+{
+    static_assert(std::is_trivially_copyable<T>::value, "components are copied with memcpy");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "column rows must stay aligned");
+    static_assert(T::ID >= 0 && T::ID < MAX_COMPONENTS, "component id out of range");
+    return 1u << T::ID;
+}
+
+template <typename... Ts>
+inline constexpr ComponentMask ComponentMaskOf()
+{
+    return (ComponentMask(0) | ... | ComponentBit<Ts>());
+}
+
+// One component of every entity of an archetype, rows in the order of the entities
+class ComponentColumn
+{
+private:
+    std::vector<unsigned char> data;
+    size_t element_size = 0;
+
+public:
+    ComponentColumn() = default;
+    explicit ComponentColumn(size_t in_element_size) : element_size(in_element_size) {}
+
+    inline void *At(int row)
+    {
+        return data.data() + row * element_size;
+    }
+    inline const void *At(int row) const
+    {
+        return data.data() + row * element_size;
+    }
+    inline void PushBack(const void *element)
+    {
+        size_t offset = data.size();
+        data.resize(offset + element_size);
+        std::memcpy(data.data() + offset, element, element_size);
+    }
+    // The last row takes the place of the removed one
+    inline void SwapRemove(int row)
+    {
+        size_t last = data.size() - element_size;
+        if (row * element_size != last)
+            std::memcpy(data.data() + row * element_size, data.data() + last, element_size);
+        data.resize(last);
+    }
+    inline void Clear()
+    {
+        data.clear();
+    }
+    inline bool IsUsed() const
+    {
+        return element_size > 0;
+    }
+};
+
+// Every entity with exactly the same set of components. Columns are contiguous so a
+// system walks one component of many entities with no indirection.
+struct Archetype
+{
+    ComponentMask mask = 0;
+    std::vector<Entity> entities;
+    ComponentColumn columns[MAX_COMPONENTS];
+
+    inline int GetCount() const
+    {
+        return static_cast<int>(entities.size());
+    }
+    template <typename T>
+    inline T *GetColumn()
+    {
+        return static_cast<T *>(columns[T::ID].At(0));
+    }
+};
+
+// Entities stored by archetype. Creating, destroying or changing the components of an
+// entity moves rows around: do it outside ForEach, or gather the entities first.
+class EntityWorld
+{
+private:
+    struct EntityLocation
+    {
+        int archetype = -1;
+        int row = -1;
+    };
+
+    std::vector<Archetype> archetypes;
+    std::vector<uint32_t> generations;
+    std::vector<EntityLocation> locations;
+    std::vector<uint32_t> free_indices;
+    int entity_count = 0;
+
+    // Column sizes of the components in mask, filled in by each typed call
+    size_t component_sizes[MAX_COMPONENTS] = {};
+
+    template <typename... Ts>
+    inline void RegisterSizes()
+    {
+        ((component_sizes[Ts::ID] = sizeof(Ts)), ...);
+    }
+
+    inline int FindOrCreateArchetype(ComponentMask mask)
+    {
+        for (size_t i = 0; i < archetypes.size(); i++)
+        {
+            if (archetypes[i].mask == mask)
+                return static_cast<int>(i);
+        }
+        Archetype archetype;
+        archetype.mask = mask;
+        for (int id = 0; id < MAX_COMPONENTS; id++)
+        {
+            if (mask & (1u << id))
+                archetype.columns[id] = ComponentColumn(component_sizes[id]);
+        }
+        archetypes.push_back(std::move(archetype));
+        return static_cast<int>(archetypes.size()) - 1;
+    }
+
+    inline Entity AllocateEntity()
+    {
+        Entity entity;
+        if (free_indices.empty())
+        {
+            entity.index = static_cast<uint32_t>(generations.size());
+            generations.push_back(1);
+            locations.push_back(EntityLocation());
+        }
+        else
+        {
+            entity.index = free_indices.back();
+            free_indices.pop_back();
+        }
+        entity.generation = generations[entity.index];
+        entity_count++;
+        return entity;
+    }
+
+    // Remove a row, the last entity of the archetype moves into it
+    inline void RemoveRow(int archetype_index, int row)
+    {
+        Archetype &archetype = archetypes[archetype_index];
+        for (int id = 0; id < MAX_COMPONENTS; id++)
+        {
+            if (archetype.columns[id].IsUsed())
+                archetype.columns[id].SwapRemove(row);
+        }
+        Entity moved = archetype.entities.back();
+        archetype.entities[row] = moved;
+        archetype.entities.pop_back();
+        if (row < archetype.GetCount())
+            locations[moved.index].row = row;
+    }
+
+    // Copy the shared components of an entity to another archetype, then drop the old row
+    inline void MoveEntity(Entity entity, int to_index)
+    {
+        EntityLocation &location = locations[entity.index];
+        Archetype &from = archetypes[location.archetype];
+        Archetype &to = archetypes[to_index];
+        for (int id = 0; id < MAX_COMPONENTS; id++)
+        {
+            if (from.columns[id].IsUsed() && to.columns[id].IsUsed())
+                to.columns[id].PushBack(from.columns[id].At(location.row));
+        }
+        to.entities.push_back(entity);
+        int from_index = location.archetype;
+        int from_row = location.row;
+        location = {to_index, to.GetCount() - 1};
+        RemoveRow(from_index, from_row);
+    }
+
+public:
+    template <typename... Ts>
+    inline Entity Create(const Ts &...components)
+    {
+        RegisterSizes<Ts...>();
+        int archetype_index = FindOrCreateArchetype(ComponentMaskOf<Ts...>());
+        Archetype &archetype = archetypes[archetype_index];
+        Entity entity = AllocateEntity();
+        (archetype.columns[Ts::ID].PushBack(&components), ...);
+        archetype.entities.push_back(entity);
+        locations[entity.index] = {archetype_index, archetype.GetCount() - 1};
+        return entity;
+    }
+
+    inline bool IsAlive(Entity entity) const
+    {
+        return entity.index < generations.size() && generations[entity.index] == entity.generation && locations[entity.index].archetype >= 0;
+    }
+
+    // Stale entities are ignored, like removed physics handles
+    inline void Destroy(Entity entity)
+    {
+        if (!IsAlive(entity))
+            return;
+        EntityLocation location = locations[entity.index];
+        RemoveRow(location.archetype, location.row);
+        locations[entity.index] = EntityLocation();
+        generations[entity.index]++;
+        free_indices.push_back(entity.index);
+        entity_count--;
+    }
+
+    template <typename T>
+    inline bool Has(Entity entity) const
+    {
+        return IsAlive(entity) && (archetypes[locations[entity.index].archetype].mask & ComponentBit<T>());
+    }
+
+    // nullptr when the entity is gone or lacks the component. Valid until the next
+    // structural change.
+    template <typename T>
+    inline T *Get(Entity entity)
+    {
+        if (!Has<T>(entity))
+            return nullptr;
+        const EntityLocation &location = locations[entity.index];
+        return static_cast<T *>(archetypes[location.archetype].columns[T::ID].At(location.row));
+    }
+
+    // Add a component, or overwrite it when the entity already has one
+    template <typename T>
+    inline void Add(Entity entity, const T &component)
+    {
+        if (!IsAlive(entity))
+            return;
+        if (T *existing = Get<T>(entity))
+        {
+            *existing = component;
+            return;
+        }
+        RegisterSizes<T>();
+        int to_index = FindOrCreateArchetype(archetypes[locations[entity.index].archetype].mask | ComponentBit<T>());
+        archetypes[to_index].columns[T::ID].PushBack(&component);
+        MoveEntity(entity, to_index);
+    }
+
+    template <typename T>
+    inline void Remove(Entity entity)
+    {
+        if (!Has<T>(entity))
+            return;
+        int to_index = FindOrCreateArchetype(archetypes[locations[entity.index].archetype].mask & ~ComponentBit<T>());
+        MoveEntity(entity, to_index);
+    }
+
+    // Call f(count, entities, columns...) once per archetype holding every component of
+    // Ts, with the columns in the order of Ts
+    template <typename... Ts, typename F>
+    inline void ForEach(F &&f)
+    {
+        const ComponentMask mask = ComponentMaskOf<Ts...>();
+        for (Archetype &archetype : archetypes)
+        {
+            if ((archetype.mask & mask) != mask || archetype.entities.empty())
+                continue;
+            f(archetype.GetCount(), archetype.entities.data(), archetype.GetColumn<Ts>()...);
+        }
+    }
+
+    inline int GetCount() const
+    {
+        return entity_count;
+    }
+    inline int GetArchetypeCount() const
+    {
+        return static_cast<int>(archetypes.size());
+    }
+
+    // Destroy every entity, archetypes and their capacity are kept for the next run
+    inline void Clear()
+    {
+        for (Archetype &archetype : archetypes)
+        {
+            for (Entity entity : archetype.entities)
+            {
+                locations[entity.index] = EntityLocation();
+                generations[entity.index]++;
+                free_indices.push_back(entity.index);
+            }
+            archetype.entities.clear();
+            for (ComponentColumn &column : archetype.columns)
+            {
+                column.Clear();
+            }
+        }
+        entity_count = 0;
+    }
+};
+
+#endif // ENTITY_WORLD_H
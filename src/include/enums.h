@@ -16,7 +16,8 @@ enum class ObjectShape
     Circle,
     Rectangle,
     Triangle,
-    Lines
+    Lines,
+    Polygon
 };
 
 #endif // ENUMS_H
@@ -0,0 +1,168 @@
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include "raylib.h"
+#include <cstdint>
+#include <tuple>
+#include "physics_handle.h"
+
+// Events name bodies by their PhysicsHandle: copying one never touches a refcount and a
+// handle whose body is gone simply fails to resolve.
+
+// A bullet reached what it was fired at
+struct CollisionEvent
+{
+    PhysicsHandle source;
+    PhysicsHandle target;
+    Vector2 position = {0.0f, 0.0f};
+};
+
+// Life taken from target
+struct DamageEvent
+{
+    PhysicsHandle source;
+    PhysicsHandle target;
+    float amount = 0.0f;
+    Vector2 position = {0.0f, 0.0f};
+};
+
+// target ran out of life
+struct DeathEvent
+{
+    PhysicsHandle source;
+    PhysicsHandle target;
+};
+
+// Points earned by the body that fired, see Player
+struct ScoreEvent
+{
+    PhysicsHandle source;
+    int points = 0;
+};
+
+// source timed out without hitting anything
+struct EndOfLifeEvent
+{
+    PhysicsHandle source;
+    Vector2 position = {0.0f, 0.0f};
+};
+
+// Fixed capacity queue of one event type. Events pushed once it is full are dropped and
+// counted, it never allocates after construction.
+template <typename T, uint32_t CAPACITY>
+class EventRing
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "EventRing capacity must be a power of two");
+
+private:
+    T events[CAPACITY];
+    uint32_t head = 0;
+    uint32_t count = 0;
+    uint32_t dropped = 0;
+
+public:
+    inline bool Push(const T &event)
+    {
+        if (count == CAPACITY)
+        {
+            dropped++;
+            return false;
+        }
+        events[(head + count) & (CAPACITY - 1)] = event;
+        count++;
+        return true;
+    }
+
+    // Call f(event) on every event, oldest first, and empty the ring
+    template <typename F>
+    inline void Drain(F &&f)
+    {
+        for (uint32_t i = 0; i < count; i++)
+        {
+            f(static_cast<const T &>(events[(head + i) & (CAPACITY - 1)]));
+        }
+        head = (head + count) & (CAPACITY - 1);
+        count = 0;
+    }
+
+    inline void Clear()
+    {
+        head = 0;
+        count = 0;
+    }
+    inline uint32_t GetCount() const
+    {
+        return count;
+    }
+    inline uint32_t GetDroppedCount() const
+    {
+        return dropped;
+    }
+    static constexpr uint32_t GetCapacity()
+    {
+        return CAPACITY;
+    }
+};
+
+// One ring per event type. Gameplay and physics code push as things happen, each
+// consumer drains all of its type once per frame, skipped events included, so events of
+// a step are read on the next frame. Nothing else clears the rings until game over.
+class EventBus
+{
+public:
+    static constexpr uint32_t CAPACITY = 256;
+
+private:
+    std::tuple<EventRing<CollisionEvent, CAPACITY>,
+               EventRing<DamageEvent, CAPACITY>,
+               EventRing<DeathEvent, CAPACITY>,
+               EventRing<ScoreEvent, CAPACITY>,
+               EventRing<EndOfLifeEvent, CAPACITY>>
+        rings;
+
+    EventBus() = default;
+
+public:
+    static EventBus &GetInstance()
+    {
+        static EventBus instance;
+        return instance;
+    }
+    EventBus(const EventBus &) = delete;
+    EventBus &operator=(const EventBus &) = delete;
+
+    template <typename T>
+    inline EventRing<T, CAPACITY> &Get()
+    {
+        return std::get<EventRing<T, CAPACITY>>(rings);
+    }
+    template <typename T>
+    inline bool Push(const T &event)
+    {
+        return Get<T>().Push(event);
+    }
+    template <typename T, typename F>
+    inline void Drain(F &&f)
+    {
+        Get<T>().Drain(f);
+    }
+
+    inline void Clear()
+    {
+        std::apply([](auto &...ring)
+        {
+            (ring.Clear(), ...);
+        }, rings);
+    }
+    inline uint32_t GetDroppedCount()
+    {
+        uint32_t dropped = 0;
+        std::apply([&dropped](auto &...ring)
+        {
+            ((dropped += ring.GetDroppedCount()), ...);
+        }, rings);
+        return dropped;
+    }
+};
+
+#endif // EVENT_BUS_H
@@ -0,0 +1,80 @@
+#ifndef FIXED_TIMESTEP_H
+#define FIXED_TIMESTEP_H
+
+#include <algorithm>
+
+// Turns variable frame times into a whole number of fixed simulation steps.
+// The remainder stays in the accumulator and GetAlpha tells how far the frame is
+// between the last two steps, so rendering can interpolate body states.
+class FixedTimestep
+{
+private:
+    float step = 0.02f;
+    int max_steps_per_frame = 5;
+    float accumulator = 0.0f;
+    // Frame time thrown away because a frame needed more than max_steps_per_frame steps
+    float dropped_time = 0.0f;
+
+public:
+    FixedTimestep(float tick_rate = 50.0f, int in_max_steps_per_frame = 5)
+    {
+        SetTickRate(tick_rate);
+        SetMaxStepsPerFrame(in_max_steps_per_frame);
+    }
+
+    void SetTickRate(float tick_rate)
+    {
+        if (tick_rate <= 0.0f)
+            return;
+        step = 1.0f / tick_rate;
+        accumulator = std::min(accumulator, step);
+    }
+    void SetMaxStepsPerFrame(int max_steps)
+    {
+        max_steps_per_frame = std::max(max_steps, 1);
+    }
+
+    float GetStep() const { return step; }
+    float GetTickRate() const { return 1.0f / step; }
+    int GetMaxStepsPerFrame() const { return max_steps_per_frame; }
+    float GetDroppedTime() const { return dropped_time; }
+
+    // Add the frame time and return how many steps to simulate this frame.
+    // Frames longer than max_steps_per_frame steps are clamped so a slow frame
+    // never snowballs into more and more steps (spiral of death).
+    int Advance(float frame_time)
+    {
+        if (frame_time < 0.0f)
+            frame_time = 0.0f;
+        float max_frame_time = step * max_steps_per_frame;
+        if (frame_time > max_frame_time)
+        {
+            dropped_time += frame_time - max_frame_time;
+            frame_time = max_frame_time;
+        }
+        accumulator += frame_time;
+        int steps = 0;
+        while (accumulator >= step && steps < max_steps_per_frame)
+        {
+            accumulator -= step;
+            steps++;
+        }
+        // Never carry more than one step over to the next frame
+        accumulator = std::min(accumulator, step);
+        return steps;
+    }
+
+    // Fraction of a step elapsed since the last simulated step, in [0, 1]
+    float GetAlpha() const
+    {
+        return std::min(accumulator / step, 1.0f);
+    }
+
+    void Reset()
+    {
+        accumulator = 0.0f;
+        dropped_time = 0.0f;
+    }
+};
+
+#endif // FIXED_TIMESTEP_H
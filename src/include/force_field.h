@@ -0,0 +1,400 @@
+#ifndef FORCE_FIELD_H
+#define FORCE_FIELD_H
+
+#include "raylib.h"
+#include "world_position.h"
+#include <math.h>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+// Static or slow moving influence baked into the force field
+enum class ForceSourceType
+{
+    Well, // pull towards position, like a planet
+    Drag, // slows bodies down, like a nebula
+    Wind  // pushes along direction, like a solar wind
+};
+
+struct ForceSource
+{
+    ForceSourceType type = ForceSourceType::Well;
+    // Offset from the corner of sector
+    WorldSector sector;
+    Vector2 position = {0.0f, 0.0f};
+    // Nothing is felt past reach, the influence fades out smoothly towards it
+    float reach = 0.0f;
+    // Well: gravitational constant times mass. Drag: fraction of the velocity lost per
+    // second. Wind: acceleration.
+    float strength = 0.0f;
+    // Well: the pull stops growing inside this radius. Wind: unit direction.
+    float core_radius = 0.0f;
+    Vector2 direction = {0.0f, 0.0f};
+    bool is_active = true;
+
+    static ForceSource Well(Vector2 in_position, float in_mass, float in_core_radius, float in_reach)
+    {
+        ForceSource source;
+        source.type = ForceSourceType::Well;
+        source.position = in_position;
+        source.strength = in_mass;
+        source.core_radius = in_core_radius;
+        source.reach = in_reach;
+        return source;
+    }
+    static ForceSource Drag(Vector2 in_position, float in_drag, float in_reach)
+    {
+        ForceSource source;
+        source.type = ForceSourceType::Drag;
+        source.position = in_position;
+        source.strength = in_drag;
+        source.reach = in_reach;
+        return source;
+    }
+    static ForceSource Wind(Vector2 in_position, Vector2 in_direction, float in_acceleration, float in_reach)
+    {
+        ForceSource source;
+        source.type = ForceSourceType::Wind;
+        source.position = in_position;
+        source.direction = in_direction;
+        source.strength = in_acceleration;
+        source.reach = in_reach;
+        return source;
+    }
+};
+
+// Acceleration and drag at one point of the field
+struct ForceSample
+{
+    float acceleration_x = 0.0f;
+    float acceleration_y = 0.0f;
+    float drag = 0.0f;
+};
+
+// Sum of the force sources baked on a grid, one grid per WorldSector, and
+// sampled with bilinear interpolation so a body pays the same few loads whatever the
+// number of sources. Only sectors some source reaches are stored, a sector is baked
+// again when a source reaching it is added, moved or removed.
+class ForceField
+{
+public:
+    static constexpr float SECTOR_SIZE = WORLD_SECTOR_SIZE;
+    // Grid nodes are CELL_SIZE apart, the edges of a sector are shared with its
+    // neighbours so a sample never reads across two sectors
+    static constexpr int CELLS_PER_SECTOR = 32;
+    static constexpr int NODES_PER_SIDE = CELLS_PER_SECTOR + 1;
+    static constexpr float CELL_SIZE = SECTOR_SIZE / CELLS_PER_SECTOR;
+
+private:
+    struct Sector
+    {
+        int sector_x = 0;
+        int sector_y = 0;
+        bool is_dirty = true;
+        // Row by row, the values of a node next to each other so a sample reads two
+        // short runs of memory
+        std::vector<ForceSample> nodes;
+    };
+
+    std::vector<ForceSource> sources;
+    std::vector<Sector> sectors;
+    std::unordered_map<uint64_t, int> sector_lookup;
+    std::vector<int> dirty_sectors;
+    // Flat index of the sectors over their bounding box, -1 where no source reaches,
+    // so sampling skips the hash lookup. Sources spread too far apart keep the lookup.
+    static constexpr int MAX_INDEXED_SECTORS = 1 << 20;
+    std::vector<int> sector_index;
+    int index_min_x = 0;
+    int index_min_y = 0;
+    int index_width = 0;
+    int index_height = 0;
+    bool is_indexed = false;
+    bool is_index_stale = false;
+    // Felt everywhere, the old global gravity
+    float uniform_x = 0.0f;
+    float uniform_y = 0.0f;
+    int bake_count = 0;
+
+    static inline uint64_t SectorKey(int sector_x, int sector_y)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(sector_x)) << 32) | static_cast<uint32_t>(sector_y);
+    }
+    static inline int SectorCoordinate(int32_t sector, float offset)
+    {
+        return sector + static_cast<int>(floorf(offset / SECTOR_SIZE));
+    }
+
+    // Every sector the reach of source overlaps has to be baked again
+    void Invalidate(const ForceSource &source)
+    {
+        const int min_x = SectorCoordinate(source.sector.x, source.position.x - source.reach);
+        const int max_x = SectorCoordinate(source.sector.x, source.position.x + source.reach);
+        const int min_y = SectorCoordinate(source.sector.y, source.position.y - source.reach);
+        const int max_y = SectorCoordinate(source.sector.y, source.position.y + source.reach);
+        for (int sector_y = min_y; sector_y <= max_y; sector_y++)
+        {
+            for (int sector_x = min_x; sector_x <= max_x; sector_x++)
+            {
+                auto [it, is_new] = sector_lookup.try_emplace(SectorKey(sector_x, sector_y), static_cast<int>(sectors.size()));
+                if (is_new)
+                {
+                    Sector sector;
+                    sector.sector_x = sector_x;
+                    sector.sector_y = sector_y;
+                    sector.is_dirty = false;
+                    sectors.push_back(std::move(sector));
+                    is_index_stale = true;
+                }
+                Sector &sector = sectors[it->second];
+                if (!sector.is_dirty)
+                {
+                    sector.is_dirty = true;
+                    dirty_sectors.push_back(it->second);
+                }
+            }
+        }
+    }
+
+    // Influence of one source at a grid node, both relative to the same sector
+    static void AddSource(const ForceSource &source, Vector2 source_position, float x, float y, ForceSample &sample)
+    {
+        float dx = source_position.x - x;
+        float dy = source_position.y - y;
+        float distance_sqr = dx * dx + dy * dy;
+        float reach_sqr = source.reach * source.reach;
+        if (distance_sqr >= reach_sqr)
+            return;
+        float fade = 1.0f - distance_sqr / reach_sqr;
+        fade *= fade;
+        switch (source.type)
+        {
+        case ForceSourceType::Well:
+        {
+            float softened = distance_sqr + source.core_radius * source.core_radius;
+            float pull = softened > 0.0f ? source.strength * fade / (softened * sqrtf(softened)) : 0.0f;
+            sample.acceleration_x += dx * pull;
+            sample.acceleration_y += dy * pull;
+            break;
+        }
+        case ForceSourceType::Drag:
+            sample.drag += source.strength * fade;
+            break;
+        case ForceSourceType::Wind:
+            sample.acceleration_x += source.direction.x * source.strength * fade;
+            sample.acceleration_y += source.direction.y * source.strength * fade;
+            break;
+        }
+    }
+
+    void BakeSector(Sector &sector)
+    {
+        sector.nodes.assign(NODES_PER_SIDE * NODES_PER_SIDE, ForceSample());
+        const WorldSector origin = {sector.sector_x, sector.sector_y};
+        for (const ForceSource &source : sources)
+        {
+            if (!source.is_active)
+                continue;
+            // Sources far from this sector cannot reach it, skip them before the
+            // float offset loses precision
+            const int64_t sector_distance = std::max(std::abs(static_cast<int64_t>(source.sector.x) - origin.x), std::abs(static_cast<int64_t>(source.sector.y) - origin.y));
+            if (sector_distance > 1 + static_cast<int64_t>(source.reach / SECTOR_SIZE))
+                continue;
+            const Vector2 position = WorldPosition{source.sector, source.position}.RelativeTo(origin);
+            // Only the nodes inside the reach of the source
+            const float reach = source.reach;
+            const int min_x = std::max(0, static_cast<int>(ceilf((position.x - reach) / CELL_SIZE)));
+            const int max_x = std::min(NODES_PER_SIDE - 1, static_cast<int>(floorf((position.x + reach) / CELL_SIZE)));
+            const int min_y = std::max(0, static_cast<int>(ceilf((position.y - reach) / CELL_SIZE)));
+            const int max_y = std::min(NODES_PER_SIDE - 1, static_cast<int>(floorf((position.y + reach) / CELL_SIZE)));
+            for (int node_y = min_y; node_y <= max_y; node_y++)
+            {
+                for (int node_x = min_x; node_x <= max_x; node_x++)
+                {
+                    AddSource(source, position, node_x * CELL_SIZE, node_y * CELL_SIZE, sector.nodes[node_y * NODES_PER_SIDE + node_x]);
+                }
+            }
+        }
+        sector.is_dirty = false;
+        bake_count++;
+    }
+
+    void BuildIndex()
+    {
+        is_index_stale = false;
+        is_indexed = false;
+        sector_index.clear();
+        if (sectors.empty())
+            return;
+        int min_x = sectors[0].sector_x, max_x = min_x;
+        int min_y = sectors[0].sector_y, max_y = min_y;
+        for (const Sector &sector : sectors)
+        {
+            min_x = std::min(min_x, sector.sector_x);
+            max_x = std::max(max_x, sector.sector_x);
+            min_y = std::min(min_y, sector.sector_y);
+            max_y = std::max(max_y, sector.sector_y);
+        }
+        const int64_t area = (static_cast<int64_t>(max_x) - min_x + 1) * (static_cast<int64_t>(max_y) - min_y + 1);
+        if (area > MAX_INDEXED_SECTORS)
+            return;
+        index_min_x = min_x;
+        index_min_y = min_y;
+        index_width = max_x - min_x + 1;
+        index_height = max_y - min_y + 1;
+        sector_index.assign(static_cast<size_t>(area), -1);
+        for (int i = 0; i < static_cast<int>(sectors.size()); i++)
+            sector_index[(sectors[i].sector_y - min_y) * index_width + sectors[i].sector_x - min_x] = i;
+        is_indexed = true;
+    }
+    const Sector *FindSector(int sector_x, int sector_y) const
+    {
+        if (is_indexed)
+        {
+            // Unsigned so one compare also rejects the sectors before the box
+            const unsigned int x = static_cast<unsigned int>(sector_x - index_min_x);
+            const unsigned int y = static_cast<unsigned int>(sector_y - index_min_y);
+            if (x >= static_cast<unsigned int>(index_width) || y >= static_cast<unsigned int>(index_height))
+                return nullptr;
+            const int index = sector_index[y * index_width + x];
+            return index >= 0 ? &sectors[index] : nullptr;
+        }
+        if (sectors.empty())
+            return nullptr;
+        auto it = sector_lookup.find(SectorKey(sector_x, sector_y));
+        return it != sector_lookup.end() ? &sectors[it->second] : nullptr;
+    }
+
+public:
+    // Returns the id of the source, ids stay valid until Clear
+    int AddSource(const ForceSource &source)
+    {
+        sources.push_back(source);
+        sources.back().is_active = true;
+        NormalizeSectorOffset(sources.back().sector.x, sources.back().position.x);
+        NormalizeSectorOffset(sources.back().sector.y, sources.back().position.y);
+        Invalidate(sources.back());
+        return static_cast<int>(sources.size()) - 1;
+    }
+    // position is an offset from the corner of sector
+    void MoveSource(int id, Vector2 position, WorldSector sector = WorldSector())
+    {
+        if (id < 0 || id >= static_cast<int>(sources.size()) || !sources[id].is_active)
+            return;
+        const WorldPosition target = WorldPosition::FromOffset(sector, position);
+        if (sources[id].sector == target.sector && sources[id].position.x == target.local.x && sources[id].position.y == target.local.y)
+            return;
+        Invalidate(sources[id]);
+        sources[id].sector = target.sector;
+        sources[id].position = target.local;
+        Invalidate(sources[id]);
+    }
+    void RemoveSource(int id)
+    {
+        if (id < 0 || id >= static_cast<int>(sources.size()) || !sources[id].is_active)
+            return;
+        Invalidate(sources[id]);
+        sources[id].is_active = false;
+    }
+    const ForceSource *GetSource(int id) const
+    {
+        if (id < 0 || id >= static_cast<int>(sources.size()) || !sources[id].is_active)
+            return nullptr;
+        return &sources[id];
+    }
+    void Clear()
+    {
+        sources.clear();
+        sectors.clear();
+        sector_lookup.clear();
+        dirty_sectors.clear();
+        BuildIndex();
+    }
+
+    void SetUniformAcceleration(float x, float y)
+    {
+        uniform_x = x;
+        uniform_y = y;
+    }
+
+    // Bake the sectors invalidated since the last call, before any thread samples
+    void Bake()
+    {
+        for (int index : dirty_sectors)
+            BakeSector(sectors[index]);
+        dirty_sectors.clear();
+        if (is_index_stale)
+            BuildIndex();
+    }
+    bool IsBaked() const
+    {
+        return dirty_sectors.empty() && !is_index_stale;
+    }
+    int GetSectorCount() const
+    {
+        return static_cast<int>(sectors.size());
+    }
+    // Sectors baked since the start, to check sources only rebake when they move
+    int GetBakeCount() const
+    {
+        return bake_count;
+    }
+
+    // Keeps the sector of the last sample, bodies sampled in order are mostly in the
+    // same sector as the previous one. One cursor per thread.
+    struct Cursor
+    {
+        int sector_x = 0;
+        int sector_y = 0;
+        const Sector *sector = nullptr;
+        bool is_valid = false;
+    };
+
+    // Field at an offset from the corner of a sector. Read only on a baked field,
+    // several threads can sample at once.
+    ForceSample Sample(WorldSector in_sector, float x, float y, Cursor &cursor) const
+    {
+        ForceSample sample;
+        sample.acceleration_x = uniform_x;
+        sample.acceleration_y = uniform_y;
+        int32_t sector_x = in_sector.x;
+        int32_t sector_y = in_sector.y;
+        NormalizeSectorOffset(sector_x, x);
+        NormalizeSectorOffset(sector_y, y);
+        if (!cursor.is_valid || cursor.sector_x != sector_x || cursor.sector_y != sector_y)
+        {
+            cursor.sector = FindSector(sector_x, sector_y);
+            cursor.sector_x = sector_x;
+            cursor.sector_y = sector_y;
+            cursor.is_valid = true;
+        }
+        // Not baked yet
+        if (cursor.sector == nullptr || cursor.sector->nodes.empty())
+            return sample;
+        const Sector &sector = *cursor.sector;
+        const float local_x = x / CELL_SIZE;
+        const float local_y = y / CELL_SIZE;
+        const int cell_x = std::min(static_cast<int>(local_x), CELLS_PER_SECTOR - 1);
+        const int cell_y = std::min(static_cast<int>(local_y), CELLS_PER_SECTOR - 1);
+        const float tx = local_x - cell_x;
+        const float ty = local_y - cell_y;
+        const ForceSample *row = &sector.nodes[cell_y * NODES_PER_SIDE + cell_x];
+        const ForceSample *next_row = row + NODES_PER_SIDE;
+        const float w00 = (1.0f - tx) * (1.0f - ty);
+        const float w10 = tx * (1.0f - ty);
+        const float w01 = (1.0f - tx) * ty;
+        const float w11 = tx * ty;
+        sample.acceleration_x += row[0].acceleration_x * w00 + row[1].acceleration_x * w10 + next_row[0].acceleration_x * w01 + next_row[1].acceleration_x * w11;
+        sample.acceleration_y += row[0].acceleration_y * w00 + row[1].acceleration_y * w10 + next_row[0].acceleration_y * w01 + next_row[1].acceleration_y * w11;
+        sample.drag = row[0].drag * w00 + row[1].drag * w10 + next_row[0].drag * w01 + next_row[1].drag * w11;
+        return sample;
+    }
+    ForceSample Sample(WorldSector sector, float x, float y) const
+    {
+        Cursor cursor;
+        return Sample(sector, x, y, cursor);
+    }
+};
+
+#endif // FORCE_FIELD_H
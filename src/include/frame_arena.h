@@ -0,0 +1,208 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "physics_thread_pool.h"
+
+// Bump allocator for data that only lives until the end of the frame. Allocating moves
+// an offset, nothing is freed one by one: Reset gives everything back at once. When a
+// frame needs more than the block holds, the extra comes from the heap and the block is
+// grown to the high-water mark on Reset, so a steady frame does no heap allocation.
+class FrameArena
+{
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024;
+    static constexpr size_t DEFAULT_ALIGNMENT = alignof(std::max_align_t);
+
+private:
+    std::unique_ptr<unsigned char[]> block;
+    size_t capacity = 0;
+    size_t offset = 0;
+    // Allocations that did not fit in the block this frame
+    std::vector<std::unique_ptr<unsigned char[]>> overflow_blocks;
+    size_t overflow_bytes = 0;
+    size_t high_water = 0;
+    // Heap allocations made by the arena since it was created
+    int heap_allocations = 0;
+
+    static inline size_t AlignUp(uintptr_t value, size_t alignment)
+    {
+        return static_cast<size_t>((value + alignment - 1) & ~static_cast<uintptr_t>(alignment - 1));
+    }
+
+public:
+    explicit FrameArena(size_t in_capacity = DEFAULT_CAPACITY)
+    {
+        capacity = in_capacity;
+        block.reset(new unsigned char[capacity]);
+        heap_allocations++;
+    }
+    FrameArena(const FrameArena &) = delete;
+    FrameArena &operator=(const FrameArena &) = delete;
+
+    // size bytes aligned to alignment, a power of two. Valid until Reset.
+    inline void *Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT)
+    {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(block.get());
+        const size_t begin = AlignUp(base + offset, alignment) - base;
+        if (begin + size <= capacity)
+        {
+            offset = begin + size;
+            return block.get() + begin;
+        }
+        overflow_blocks.emplace_back(new unsigned char[size + alignment]);
+        heap_allocations++;
+        overflow_bytes += size + alignment;
+        const uintptr_t overflow = reinterpret_cast<uintptr_t>(overflow_blocks.back().get());
+        return reinterpret_cast<void *>(AlignUp(overflow, alignment));
+    }
+    template <typename T>
+    inline T *Allocate(size_t count)
+    {
+        return static_cast<T *>(Allocate(count * sizeof(T), alignof(T)));
+    }
+
+    // Give back everything allocated since the last Reset
+    inline void Reset()
+    {
+        const size_t used = offset + overflow_bytes;
+        high_water = std::max(high_water, used);
+        if (!overflow_blocks.empty())
+        {
+            overflow_blocks.clear();
+            overflow_bytes = 0;
+            // One bigger block instead of the same overflows every frame
+            size_t grown = capacity;
+            while (grown < high_water)
+                grown *= 2;
+            block.reset(new unsigned char[grown]);
+            heap_allocations++;
+            capacity = grown;
+        }
+        offset = 0;
+    }
+
+    // Bytes allocated since the last Reset
+    inline size_t GetUsed() const
+    {
+        return offset + overflow_bytes;
+    }
+    inline size_t GetCapacity() const
+    {
+        return capacity;
+    }
+    // Most bytes a frame used, up to the last Reset
+    inline size_t GetHighWater() const
+    {
+        return high_water;
+    }
+    inline int GetHeapAllocationCount() const
+    {
+        return heap_allocations;
+    }
+};
+
+// STL allocator drawing from a FrameArena, deallocate does nothing. Containers using it
+// must not outlive the frame.
+template <typename T>
+struct FrameAllocator
+{
+    using value_type = T;
+
+    FrameArena *arena = nullptr;
+
+    explicit FrameAllocator(FrameArena &in_arena) : arena(&in_arena) {}
+    template <typename U>
+    FrameAllocator(const FrameAllocator<U> &other) : arena(other.arena) {}
+
+    inline T *allocate(size_t count)
+    {
+        return arena->Allocate<T>(count);
+    }
+    inline void deallocate(T *, size_t) {}
+
+    template <typename U>
+    inline bool operator==(const FrameAllocator<U> &other) const
+    {
+        return arena == other.arena;
+    }
+    template <typename U>
+    inline bool operator!=(const FrameAllocator<U> &other) const
+    {
+        return arena != other.arena;
+    }
+};
+
+template <typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+// One arena per worker of the thread pools, worker 0 being the main thread, so jobs
+// allocate without locking. Every arena is reset together once the frame is over.
+class FrameArenas
+{
+public:
+    static constexpr int MAX_ARENAS = PhysicsThreadPool::MAX_THREADS;
+
+private:
+    std::unique_ptr<FrameArena> arenas[MAX_ARENAS];
+
+    FrameArenas()
+    {
+        arenas[0].reset(new FrameArena());
+    }
+
+public:
+    static FrameArenas &GetInstance()
+    {
+        static FrameArenas instance;
+        return instance;
+    }
+    FrameArenas(const FrameArenas &) = delete;
+    FrameArenas &operator=(const FrameArenas &) = delete;
+
+    // Arena of a worker, made the first time that worker asks
+    inline FrameArena &Get(int worker = 0)
+    {
+        if (!arenas[worker])
+            arenas[worker].reset(new FrameArena());
+        return *arenas[worker];
+    }
+
+    // End of frame, no job may be running
+    inline void ResetAll()
+    {
+        for (std::unique_ptr<FrameArena> &arena : arenas)
+        {
+            if (arena)
+                arena->Reset();
+        }
+    }
+
+    inline size_t GetUsed() const
+    {
+        size_t used = 0;
+        for (const std::unique_ptr<FrameArena> &arena : arenas)
+            used += arena ? arena->GetUsed() : 0;
+        return used;
+    }
+    inline size_t GetHighWater() const
+    {
+        size_t high_water = 0;
+        for (const std::unique_ptr<FrameArena> &arena : arenas)
+            high_water += arena ? arena->GetHighWater() : 0;
+        return high_water;
+    }
+    inline int GetHeapAllocationCount() const
+    {
+        int count = 0;
+        for (const std::unique_ptr<FrameArena> &arena : arenas)
+            count += arena ? arena->GetHeapAllocationCount() : 0;
+        return count;
+    }
+};
+
+#endif // FRAME_ARENA_H
@@ -11,35 +11,106 @@
 #include "player.h"
 #include "input_manager.h"
 #include "star_builder.h"
-#include "astronomical_object.h"
+#include "asteroid.h"
 #include "planet.h"
+#include "entity_world.h"
+#include "game_systems.h"
+#include "simulation_thread.h"
 
 #include "physics_system.h"
 #include "physics_object.h"
 
+// What Render shows of the game while it is played. The simulation thread publishes it
+// whole after each step through a TripleBuffer, so Render never reads state the
+// simulation is writing. Without the thread Render captures it from the live game and
+// draws the RenderSnapshot of the PhysicsSystem in place, the snapshot here stays empty.
+struct WorldState
+{
+    RenderSnapshot snapshot;
+    Camera2D camera = {};
+    WorldSector camera_sector;
+    PhysicsHandle player;
+    Vector2 player_position = {0.0f, 0.0f};
+    GunSight gun_sight;
+    float health = 0.0f;
+    float energy = 0.0f;
+    int score = 0;
+    // SimulationThread::Now of the step, the render thread interpolates from it
+    double step_time = 0.0;
+    // Debug overlay
+    int candidate_pairs = 0;
+    int body_count = 0;
+    int stale_handle_accesses = 0;
+    int tier_counts[SIM_TIER_COUNT] = {};
+    int entity_count = 0;
+    int archetype_count = 0;
+    int bullet_count = 0;
+    int live_count = 0;
+    int pending_count = 0;
+    int destroyed_count = 0;
+    int hit_count = 0;
+    int miss_count = 0;
+    int kill_count = 0;
+    uint32_t events_dropped = 0;
+};
+
 class GameManager
 {
+public:
+    // Frames of input the simulation thread may fall behind before commands are dropped
+    static constexpr uint32_t INPUT_QUEUE_CAPACITY = 64;
+
 private:
     bool is_debug = false;
     int frameCounter = 0;
+    // Counted from the EventBus, once per frame
+    int hit_count = 0;
+    int miss_count = 0;
+    int kill_count = 0;
     std::string map_name = "01";
     Camera2D camera;
+    // Sector the camera and everything rendered are relative to, the sector of the player
+    WorldSector camera_sector;
     std::shared_ptr<Player> player;
     StarBuilder *star_builder = nullptr;
     InputManager *input_manager = nullptr;
     std::shared_ptr<Planet> planet;
     std::vector<std::shared_ptr<PhysicsObject>> physic_objects;
+    // Asteroids and the other entities driven by systems instead of virtual calls
+    EntityWorld entities;
+    BodyLinkSystem body_link_system;
+    LifetimeSystem lifetime_system;
+    DamageSystem damage_system;
+    // Dead entities and objects, released at the end of the frame
+    EntityLifecycle lifecycle;
+    // Render queue of the frame, flushed once per BeginMode2D
+    SpriteBatch sprite_batch;
+    // Bullets of the player, recycled shot after shot
+    BulletPool bullet_pool;
 
     float asteriod_cooldown = 0.0f;
     float asteriod_cooldown_time = 1.0f;
     bool is_menu = true;
     // menu position stars
     std::vector<Vector2> menu_stars;
+    // Simulation on its own thread while playing: input goes in through the queue, the
+    // states to render come back through the triple buffer
+    bool is_threaded_simulation = false;
+    FixedTimestep simulation_timestep;
+    SimulationThread simulation;
+    SpscQueue<InputCommand, INPUT_QUEUE_CAPACITY> input_commands;
+    TripleBuffer<WorldState> world_states;
+    // Sector the stars are relative to, follows the rendered state
+    WorldSector star_sector;
+    // Live state of the frame without the simulation thread, never holds a snapshot
+    WorldState live_state;
 
 public:
     GameManager();
     ~GameManager()
     {
+        // Nothing may step while the game is torn down
+        simulation.Stop();
         if (star_builder != nullptr)
         {
             delete star_builder;
@@ -50,26 +121,59 @@ public:
         }
         physic_objects.clear();
         player.reset();
+        // The handlers point to this manager
+        PhysicsSystem::GetInstance().SetContactHandler(ObjectType::BULLET_TYPE, ObjectType::ASTEROID_TYPE, nullptr);
+        PhysicsSystem::GetInstance().SetContactHandler(ObjectType::ASTEROID_TYPE, ObjectType::PLAYER_TYPE, nullptr);
+        entities.Clear();
         PhysicsSystem::GetInstance().Unload();
+        SpriteRegistry::GetInstance().Unload();
         TraceLog(LOG_INFO, "GameManager destroyed");
     }
 
 private:
     bool isGameOver_;
     int score;
-    void RelocateOriginBasedOnPlayerPosition();
+    // Move the camera to the sector of the player body after a physics step
+    void FollowPlayer(const RenderProxy &player_proxy);
+    // Route the contacts with asteroid entities to the damage system
+    void RegisterContactHandlers();
     bool LoadMap();
     // draw buttoms for a menu using Rectangle
     int MenuButtom(Rectangle buttom, const char *buttom_text);
 
     // Spawn asteroid for testing
     void SpawnAsteroid(float delta_time);
+    // Game logic of a frame, on the thread that owns the simulation
+    void UpdateGame(float delta_time);
+    // One physics step and the systems that follow it
+    void Step(float delta_time);
+    // Everything of one step on the simulation thread, false once the player is dead
+    bool SimulateStep(float step);
+    static bool SimulationStep(void *context, float step);
+    // Snapshot, view and debug counters of the last step, on the simulation thread
+    void PublishState(WorldState &state);
+    // Camera, player and score of the game as it is now
+    void CaptureView(WorldState &state);
+    // Counters of the debug overlay as they are now
+    void CaptureStats(WorldState &state);
+    // Stars only decorate the view, they follow the state being drawn
+    void UpdateStars(const WorldState &state, float delta_time);
 
 public:
     int getScore() { return score; }
+    // Leave the menu with a new player, the world is set up again after a game over
+    void StartGame();
+    // Planet of the map, its body and gravity well live in the PhysicsSystem
+    const std::shared_ptr<Planet> &GetPlanet() const { return planet; }
+    // Run the simulation on its own thread while playing, where threads are available
+    void SetThreadedSimulation(bool enabled, FixedTimestep timestep = FixedTimestep());
+    bool IsSimulationThreaded() const { return simulation.IsStarted(); }
     void Update(float delta_time);
     void FixUpdate(float delta_time);
-    void Render();
+    // alpha: fraction of a physics step elapsed since the last FixUpdate
+    void Render(float alpha = 1.0f);
+    // Release what died during the frame, once it was drawn
+    void EndFrame();
     bool isGameOver();
 };
 
@@ -0,0 +1,87 @@
+#ifndef GAME_SYSTEMS_H
+#define GAME_SYSTEMS_H
+
+#include "raylib.h"
+#include <vector>
+#include "entity_world.h"
+#include "components.h"
+#include "physics_system.h"
+#include "entity_lifecycle.h"
+#include "event_bus.h"
+
+// Systems run by the GameManager over the entities, one pass over the columns of each
+// archetype. Entities dying in a pass are queued to the EntityLifecycle, which destroys
+// them at the end of the frame.
+
+// Entity owning a body, invalid for bodies of PhysicsObjects
+inline Entity GetBodyEntity(PhysicsHandle handle)
+{
+    uint64_t user_data = PhysicsSystem::GetInstance().GetUserData(handle);
+    return user_data == 0 ? Entity() : Entity::FromUserData(user_data);
+}
+
+// Entities whose body was removed behind them go with it. Only the handles are checked,
+// the bodies themselves are drawn from the RenderSnapshot.
+class BodyLinkSystem
+{
+public:
+    void Update(EntityWorld &world, EntityLifecycle &lifecycle)
+    {
+        PhysicsSystem &physics = PhysicsSystem::GetInstance();
+        world.ForEach<PhysicsBodyComponent>([&](int count, const Entity *entities, PhysicsBodyComponent *bodies)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                if (!physics.IsValid(bodies[i].handle))
+                    lifecycle.QueueDestroy(world, entities[i]);
+            }
+        });
+    }
+};
+
+class LifetimeSystem
+{
+public:
+    void Update(EntityWorld &world, float delta_time, EntityLifecycle &lifecycle)
+    {
+        world.ForEach<LifetimeComponent>([&](int count, const Entity *entities, LifetimeComponent *lifetimes)
+        {
+            for (int i = 0; i < count; i++)
+            {
+                lifetimes[i].remaining -= delta_time;
+                if (lifetimes[i].remaining <= 0.0f)
+                    lifecycle.QueueDestroy(world, entities[i]);
+            }
+        });
+    }
+};
+
+// DamageEvents are pushed while the contacts are dispatched, then applied together to
+// the entities owning the target bodies. A killing hit is told with a DeathEvent.
+class DamageSystem
+{
+public:
+    void Update(EntityWorld &world, EntityLifecycle &lifecycle)
+    {
+        EventBus &events = EventBus::GetInstance();
+        events.Drain<DamageEvent>([&](const DamageEvent &hit)
+        {
+            Entity target = GetBodyEntity(hit.target);
+            HealthComponent *health = world.Get<HealthComponent>(target);
+            if (health == nullptr || health->life <= 0.0f)
+                return;
+            health->life -= hit.amount;
+            if (health->life > 0.0f)
+                return;
+            lifecycle.QueueDestroy(world, target);
+            events.Push(DeathEvent{hit.source, hit.target});
+        });
+    }
+
+    void Clear()
+    {
+        EventBus::GetInstance().Get<DamageEvent>().Clear();
+    }
+};
+
+#endif // GAME_SYSTEMS_H
@@ -4,9 +4,32 @@
 #include "raylib.h"
 #include "raymath.h"
 #include "player.h"
+#include "sprite_registry.h"
 #include <memory>
 #include "global.h"
 
+// Controls held during one frame, bits of InputCommand::actions
+enum InputAction : uint8_t
+{
+    INPUT_ACCELERATE = 1 << 0,
+    INPUT_DECELERATE = 1 << 1,
+    INPUT_TURN_LEFT = 1 << 2,
+    INPUT_TURN_RIGHT = 1 << 3,
+    INPUT_SHOOT = 1 << 4
+};
+
+// What the player asked for in one frame. Read from the devices on the main thread and
+// applied to the Player where the simulation runs, see GameManager.
+struct InputCommand
+{
+    uint8_t actions = 0;
+
+    inline bool Has(InputAction action) const
+    {
+        return (actions & action) != 0;
+    }
+};
+
 class InputManager
 {
 public:
@@ -24,13 +47,10 @@ private:
     Rectangle touch_right_area = Rectangle();
     Rectangle touch_up_area = Rectangle();
     Rectangle touch_shoot_area = Rectangle();
-    Image turn_image;
-    Image shoot_image;
-
-    Texture2D turn_left_texture;
-    Texture2D turn_right_texture;
-    Texture2D accelerate_texture;
-    Texture2D shoot_texture;
+    SpriteHandle turn_left_sprite;
+    SpriteHandle turn_right_sprite;
+    SpriteHandle accelerate_sprite;
+    SpriteHandle shoot_sprite;
     float size = 50.0f;
     bool is_initialized = false;
 
@@ -38,25 +58,6 @@ public:
     InputManager() = default;
     ~InputManager()
     {
-
-        if (IsWindowReady() == false)
-            return;
-        if (turn_left_texture.id > 0)
-        {
-            UnloadTexture(turn_left_texture);
-        }
-        if (turn_right_texture.id > 0)
-        {
-            UnloadTexture(turn_right_texture);
-        }
-        if (accelerate_texture.id > 0)
-        {
-            UnloadTexture(accelerate_texture);
-        }
-        if (shoot_texture.id > 0)
-        {
-            UnloadTexture(shoot_texture);
-        }
         TraceLog(LOG_INFO, "InputManager destroyed");
     }
 
@@ -75,27 +76,44 @@ public:
         touch_up_area = {static_cast<float>(virtual_screen_width) - (size + 10), static_cast<float>(virtual_screen_height) - (size + 20), size, size};
         touch_shoot_area = {static_cast<float>(virtual_screen_width) - (size * 2 + 20), static_cast<float>(virtual_screen_height) - (size + 20), size, size};
 
-        turn_image = GenImageColor(size, size, BLANK);
-        ImageDrawTextEx(&turn_image, GetFontDefault(), "<", {16 * size / 50.0f, 3 * size / 50.0f}, size, 0.0f, WHITE);
-        turn_left_texture = LoadTextureFromImage(turn_image);
-
-        ImageRotate(&turn_image, 180.0f);
-        turn_right_texture = LoadTextureFromImage(turn_image);
-
-        ImageRotate(&turn_image, -90.0f);
-        accelerate_texture = LoadTextureFromImage(turn_image);
-
-        shoot_image = GenImageColor(size, size, BLANK);
-        ImageDrawTextEx(&shoot_image, GetFontDefault(), "+", {13 * size / 50.0f, 2 * size / 50.0f}, size, 1.0f, WHITE);
-        shoot_texture = LoadTextureFromImage(shoot_image);
-
-        UnloadImage(shoot_image);
-        UnloadImage(turn_image);
+        // The buttons scale with the screen, the size is part of the sprite key
+        SpriteRegistry &registry = SpriteRegistry::GetInstance();
+        const float button_size = size;
+        const uint32_t seed = static_cast<uint32_t>(size);
+        turn_left_sprite = registry.GetOrCreate("gui_turn_left", seed, [button_size]()
+        {
+            return GenerateArrowImage(button_size, 0);
+        });
+        turn_right_sprite = registry.GetOrCreate("gui_turn_right", seed, [button_size]()
+        {
+            return GenerateArrowImage(button_size, 180);
+        });
+        accelerate_sprite = registry.GetOrCreate("gui_accelerate", seed, [button_size]()
+        {
+            return GenerateArrowImage(button_size, 90);
+        });
+        shoot_sprite = registry.GetOrCreate("gui_shoot", seed, [button_size]()
+        {
+            Image shoot_image = GenImageColor(button_size, button_size, BLANK);
+            ImageDrawTextEx(&shoot_image, GetFontDefault(), "+", {13 * button_size / 50.0f, 2 * button_size / 50.0f}, button_size, 1.0f, WHITE);
+            return shoot_image;
+        });
+    }
+    // "<" turned by rotation degrees
+    static Image GenerateArrowImage(float button_size, int rotation)
+    {
+        Image turn_image = GenImageColor(button_size, button_size, BLANK);
+        ImageDrawTextEx(&turn_image, GetFontDefault(), "<", {16 * button_size / 50.0f, 3 * button_size / 50.0f}, button_size, 0.0f, WHITE);
+        if (rotation != 0)
+            ImageRotate(&turn_image, rotation);
+        return turn_image;
     }
-    void Update(float delta_time)
+    // Read the devices, main thread only since raylib polls them there
+    InputCommand Poll()
     {
+        InputCommand command;
         if (!is_initialized)
-            return;
+            return command;
         if (!is_touch_enabled && GetTouchPointCount() > 0)
         {
             is_touch_enabled = true;
@@ -106,14 +124,32 @@ public:
             LoadGUI();
         }
 
+        // Touch buttons
+        UpdateTouchButtons();
         // Keyboard controls
-        HandleKeyboardInput();
+        HandleKeyboardInput(command);
         // Touch controls
-        HandleTouchInput();
+        HandleTouchInput(command);
+        return command;
     }
-    void FixUpdate()
+    // Act on a command, on the thread that owns the player
+    static void Apply(const InputCommand &command, Player &player)
+    {
+        if (command.Has(INPUT_ACCELERATE))
+            player.Accelerate();
+        if (command.Has(INPUT_DECELERATE))
+            player.Decelerate();
+        if (command.Has(INPUT_TURN_LEFT))
+            player.TurnLeft();
+        if (command.Has(INPUT_TURN_RIGHT))
+            player.TurnRight();
+        if (command.Has(INPUT_SHOOT))
+            player.Shoot();
+    }
+
+private:
+    void UpdateTouchButtons()
     {
-        if (!is_initialized) return;
         if (!is_touch_enabled) return;
         if (IsButtonPressed(touch_left_area))
         {
@@ -149,8 +185,7 @@ public:
         }
     }
 
-private:
-    void HandleKeyboardInput()
+    void HandleKeyboardInput(InputCommand &command)
     {
         if (is_touch_enabled)
         {
@@ -167,60 +202,54 @@ private:
                 return;
             }
         }
-        if (auto shared_player = player.lock())
+        // Forward movement
+        if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP))
         {
-            // Forward movement
-            if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP))
-            {
-                shared_player->Accelerate();
-            }
+            command.actions |= INPUT_ACCELERATE;
+        }
 
-            // Backward movement
-            if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN))
-            {
-                shared_player->Decelerate();
-            }
+        // Backward movement
+        if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN))
+        {
+            command.actions |= INPUT_DECELERATE;
+        }
 
-            // Rotation left
-            if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
-            {
-                shared_player->TurnLeft();
-            }
+        // Rotation left
+        if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT))
+        {
+            command.actions |= INPUT_TURN_LEFT;
+        }
 
-            // Rotation right
-            if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
-            {
-                shared_player->TurnRight();
-            }
+        // Rotation right
+        if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT))
+        {
+            command.actions |= INPUT_TURN_RIGHT;
+        }
 
-            // Shot
-            if (IsKeyDown(KEY_SPACE))
-            {
-                shared_player->Shoot();
-            }
+        // Shot
+        if (IsKeyDown(KEY_SPACE))
+        {
+            command.actions |= INPUT_SHOOT;
         }
     }
 
-    void HandleTouchInput()
+    void HandleTouchInput(InputCommand &command)
     {
-        if (auto shared_player = player.lock())
+        if (is_turning_left)
         {
-            if (is_turning_left)
-            {
-                shared_player->TurnLeft();
-            }
-            if (is_turning_right)
-            {
-                shared_player->TurnRight();
-            }
-            if (is_accelerating)
-            {
-                shared_player->Accelerate();
-            }
-            if (is_shooting)
-            {
-                shared_player->Shoot();
-            }
+            command.actions |= INPUT_TURN_LEFT;
+        }
+        if (is_turning_right)
+        {
+            command.actions |= INPUT_TURN_RIGHT;
+        }
+        if (is_accelerating)
+        {
+            command.actions |= INPUT_ACCELERATE;
+        }
+        if (is_shooting)
+        {
+            command.actions |= INPUT_SHOOT;
         }
     }
     // Check if mouse or touching is pressing a buttom
@@ -247,7 +276,8 @@ private:
     }
 
 public:
-    void Render()
+    // health and energy in [0, 1], as published by the simulation
+    void Render(float health, float energy)
     {
         if (!is_initialized)
             return;
@@ -255,21 +285,18 @@ public:
         {
             // Set style for touch buttons
             DrawRectangleRec(touch_left_area, {0, 0, 0, 10});
-            DrawTexture(turn_left_texture, touch_left_area.x, touch_left_area.y, WHITE);
+            SpriteRegistry::GetInstance().Draw(turn_left_sprite, {touch_left_area.x, touch_left_area.y}, {0.0f, 0.0f}, 0.0f, WHITE);
             DrawRectangleRec(touch_right_area, {0, 0, 0, 10});;
-            DrawTexture(turn_right_texture, touch_right_area.x, touch_right_area.y, WHITE);
+            SpriteRegistry::GetInstance().Draw(turn_right_sprite, {touch_right_area.x, touch_right_area.y}, {0.0f, 0.0f}, 0.0f, WHITE);
             DrawRectangleRec(touch_up_area, {0, 0, 0, 10});
-            DrawTexture(accelerate_texture, touch_up_area.x, touch_up_area.y, WHITE);
+            SpriteRegistry::GetInstance().Draw(accelerate_sprite, {touch_up_area.x, touch_up_area.y}, {0.0f, 0.0f}, 0.0f, WHITE);
             DrawRectangleRec(touch_shoot_area, {0, 0, 0, 10});;
-            DrawTexture(shoot_texture, touch_shoot_area.x, touch_shoot_area.y, WHITE);
-        }
-        if (auto shared_player = player.lock())
-        {
-            DrawRectangle(20, 20, 50, 20, GRAY);
-            DrawRectangle(21, 21, 48 * shared_player->GetPercentHealth(), 18, RED);
-            DrawRectangle(20, 20 + 22, 50, 20, GRAY);
-            DrawRectangle(21, 21 + 22, 48 * shared_player->GetPercentEnergy(), 18, YELLOW);
+            SpriteRegistry::GetInstance().Draw(shoot_sprite, {touch_shoot_area.x, touch_shoot_area.y}, {0.0f, 0.0f}, 0.0f, WHITE);
         }
+        DrawRectangle(20, 20, 50, 20, GRAY);
+        DrawRectangle(21, 21, 48 * health, 18, RED);
+        DrawRectangle(20, 20 + 22, 50, 20, GRAY);
+        DrawRectangle(21, 21 + 22, 48 * energy, 18, YELLOW);
     }
 };
 
@@ -0,0 +1,366 @@
+#ifndef PHYSICS_BODY_STORE_H
+#define PHYSICS_BODY_STORE_H
+
+#include "raylib.h"
+#include <cstdint>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <utility>
+#include "physics_object.h"
+#include "physics_kernels.h"
+#include "convex_polygon.h"
+#include "world_position.h"
+#include "render_snapshot.h"
+#include "enums.h"
+
+// Description of a body used to create it and to read it back from the PhysicsSystem
+struct PhysicsBody
+{
+    // Offset from the corner of sector. Bodies are stored with the offset folded into
+    // the sector, so a body read back may have another sector than it was created with.
+    WorldSector sector;
+    Vector2 position{};
+    Vector2 center{};
+    float rotation = 0;
+    float rotation_torque = 0;
+    float speed_limit = 0;
+    float deceleration_multiplier = 0;
+    float rotation_speed_limit = 0;
+    // Source and receiver of the n-body gravity, 0 for none
+    float mass = 1.0f;
+    Vector2 velocity{};
+    ObjectShape collision = ObjectShape::Circle;
+    // Hull used when collision is Triangle, Lines or Polygon
+    ConvexPolygon polygon;
+    ObjectType type = ObjectType::UNKNOWN_TYPE;
+    float width = 0.0f;
+    float height = 0.0f;
+    bool is_alive = false;
+    bool is_on_screen = false;
+    bool is_collision_enabled = false;
+    bool is_accelerating = false;
+    bool is_applying_torque = false;
+    bool is_rotating_left = false;
+    bool is_rotating_right = false;
+    // Moves far enough in one tick to tunnel, collisions are swept over the tick
+    bool is_fast = false;
+    // Rarely moving bodies (planets, stations) kept in the static broadphase tree
+    bool is_static = false;
+    // Bit mask matched against the layer_mask of spatial queries
+    uint32_t layer = 1;
+    std::weak_ptr<PhysicsObject> game_object;
+    // Owner that is not a PhysicsObject, the packed Entity of an EntityWorld, 0 for none
+    uint64_t user_data = 0;
+    // Published to the RenderSnapshot when valid
+    BodySprite sprite;
+};
+
+// Shapes tested with their convex hull
+inline bool IsPolygonShape(ObjectShape shape)
+{
+    return shape == ObjectShape::Triangle || shape == ObjectShape::Lines || shape == ObjectShape::Polygon;
+}
+
+// Body state packed in one bitfield per body
+enum PhysicsBodyFlag : uint16_t
+{
+    BODY_ALIVE = 1 << 0,
+    BODY_ON_SCREEN = 1 << 1,
+    BODY_COLLISION_ENABLED = 1 << 2,
+    BODY_ACCELERATING = 1 << 3,
+    BODY_APPLYING_TORQUE = 1 << 4,
+    BODY_ROTATING_LEFT = 1 << 5,
+    BODY_ROTATING_RIGHT = 1 << 6,
+    BODY_FAST = 1 << 7,
+    // Skipped by the integration kernels this tick, see PhysicsSystem simulation LOD
+    BODY_LOD_DEFERRED = 1 << 8,
+    BODY_STATIC = 1 << 9
+};
+
+// Bodies kept as parallel dense arrays, see PhysicsSystem for the handle to index mapping.
+// The integration loop only touches the hot streams and flags, the collision pass the
+// shape streams, and the game object back-references live apart so they never share
+// cache lines with simulation data.
+struct PhysicsBodyStore
+{
+    // Hot: read and written every tick. Positions are offsets inside the sector of the body.
+    std::vector<float> position_x;
+    std::vector<float> position_y;
+    std::vector<int32_t> sector_x;
+    std::vector<int32_t> sector_y;
+    std::vector<float> velocity_x;
+    std::vector<float> velocity_y;
+    std::vector<float> rotation;
+    std::vector<float> rotation_torque;
+    std::vector<uint16_t> flags;
+    // Acceleration from the force field, sampled at the start of every tick
+    std::vector<float> acceleration_x;
+    std::vector<float> acceleration_y;
+    // Warm: read every tick
+    std::vector<float> speed_limit;
+    std::vector<float> deceleration_multiplier;
+    std::vector<float> rotation_speed_limit;
+    std::vector<float> mass;
+    // Collision shape
+    std::vector<float> center_x;
+    std::vector<float> center_y;
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<ObjectShape> collision;
+    std::vector<ObjectType> type;
+    std::vector<uint32_t> layer;
+    // Index in polygons of the hull of polygon bodies, -1 for the others
+    std::vector<int32_t> polygon_index;
+    // Leaf of the body in its broadphase tree, -1 while not inserted
+    std::vector<int32_t> proxy;
+    // State at the start of the last tick, read when rendering between two ticks
+    std::vector<float> previous_position_x;
+    std::vector<float> previous_position_y;
+    std::vector<float> previous_rotation;
+    // Simulation LOD: tier and, for deferred bodies, the time their state is at
+    std::vector<uint8_t> lod_tier;
+    std::vector<double> lod_time;
+    // Cold: only used when dispatching collisions
+    std::vector<std::weak_ptr<PhysicsObject>> game_object;
+    std::vector<uint64_t> user_data;
+    // Only read when the RenderSnapshot is published
+    std::vector<BodySprite> sprite;
+    // Handle slot owning each dense body
+    std::vector<uint32_t> slot;
+    // Hulls of the polygon bodies, kept apart so circles and rectangles pay nothing.
+    // Freed entries are reused, the pool only grows with the peak polygon count.
+    std::vector<ConvexPolygon> polygons;
+    std::vector<int32_t> free_polygons;
+
+    // Call f on every stream, to keep them the same size
+    template <typename F>
+    inline void ForEachStream(F f)
+    {
+        f(position_x);
+        f(position_y);
+        f(sector_x);
+        f(sector_y);
+        f(velocity_x);
+        f(velocity_y);
+        f(rotation);
+        f(rotation_torque);
+        f(flags);
+        f(acceleration_x);
+        f(acceleration_y);
+        f(speed_limit);
+        f(deceleration_multiplier);
+        f(rotation_speed_limit);
+        f(mass);
+        f(center_x);
+        f(center_y);
+        f(width);
+        f(height);
+        f(collision);
+        f(type);
+        f(layer);
+        f(polygon_index);
+        f(proxy);
+        f(previous_position_x);
+        f(previous_position_y);
+        f(previous_rotation);
+        f(lod_tier);
+        f(lod_time);
+        f(game_object);
+        f(user_data);
+        f(sprite);
+        f(slot);
+    }
+
+    inline int Size() const
+    {
+        return static_cast<int>(flags.size());
+    }
+
+    inline bool HasFlag(int id, uint16_t flag) const
+    {
+        return (flags[id] & flag) != 0;
+    }
+
+    inline void SetFlag(int id, uint16_t flag, bool value)
+    {
+        if (value)
+            flags[id] |= flag;
+        else
+            flags[id] &= ~flag;
+    }
+
+    inline void PushBack(const PhysicsBody &body)
+    {
+        ForEachStream([](auto &stream) { stream.emplace_back(); });
+        polygon_index.back() = -1;
+        proxy.back() = -1;
+        Set(Size() - 1, body);
+    }
+
+    // Move the last body into id and drop the last one
+    inline void RemoveSwapBack(int id)
+    {
+        const int last = Size() - 1;
+        FreePolygon(id);
+        ForEachStream([id, last](auto &stream)
+        {
+            if (id != last)
+                stream[id] = std::move(stream[last]);
+            stream.pop_back();
+        });
+    }
+
+    inline void Set(int id, const PhysicsBody &body)
+    {
+        const WorldPosition world = WorldPosition::FromOffset(body.sector, body.position);
+        position_x[id] = world.local.x;
+        position_y[id] = world.local.y;
+        sector_x[id] = world.sector.x;
+        sector_y[id] = world.sector.y;
+        velocity_x[id] = body.velocity.x;
+        velocity_y[id] = body.velocity.y;
+        rotation[id] = body.rotation;
+        rotation_torque[id] = body.rotation_torque;
+        uint16_t body_flags = 0;
+        if (body.is_alive) body_flags |= BODY_ALIVE;
+        if (body.is_on_screen) body_flags |= BODY_ON_SCREEN;
+        if (body.is_collision_enabled) body_flags |= BODY_COLLISION_ENABLED;
+        if (body.is_accelerating) body_flags |= BODY_ACCELERATING;
+        if (body.is_applying_torque) body_flags |= BODY_APPLYING_TORQUE;
+        if (body.is_rotating_left) body_flags |= BODY_ROTATING_LEFT;
+        if (body.is_rotating_right) body_flags |= BODY_ROTATING_RIGHT;
+        if (body.is_fast) body_flags |= BODY_FAST;
+        if (body.is_static) body_flags |= BODY_STATIC;
+        flags[id] = body_flags;
+        speed_limit[id] = body.speed_limit;
+        deceleration_multiplier[id] = body.deceleration_multiplier;
+        rotation_speed_limit[id] = body.rotation_speed_limit;
+        mass[id] = body.mass;
+        center_x[id] = body.center.x;
+        center_y[id] = body.center.y;
+        width[id] = body.width;
+        height[id] = body.height;
+        collision[id] = body.collision;
+        type[id] = body.type;
+        layer[id] = body.layer;
+        if (IsPolygonShape(body.collision))
+        {
+            if (polygon_index[id] < 0)
+                polygon_index[id] = AllocatePolygon();
+            polygons[polygon_index[id]] = body.polygon;
+        }
+        else
+        {
+            FreePolygon(id);
+        }
+        game_object[id] = body.game_object;
+        user_data[id] = body.user_data;
+        sprite[id] = body.sprite;
+        // A new or teleported body has no motion to interpolate
+        previous_position_x[id] = world.local.x;
+        previous_position_y[id] = world.local.y;
+        previous_rotation[id] = body.rotation;
+    }
+
+    // Remember the current state before a tick moves the bodies
+    inline void SavePreviousState()
+    {
+        std::copy(position_x.begin(), position_x.end(), previous_position_x.begin());
+        std::copy(position_y.begin(), position_y.end(), previous_position_y.begin());
+        std::copy(rotation.begin(), rotation.end(), previous_rotation.begin());
+    }
+
+    inline IntegrationStreams GetIntegrationStreams()
+    {
+        return {position_x.data(), position_y.data(), velocity_x.data(), velocity_y.data(),
+                rotation.data(), rotation_torque.data(), flags.data(),
+                acceleration_x.data(), acceleration_y.data(), speed_limit.data(), deceleration_multiplier.data(), rotation_speed_limit.data()};
+    }
+
+    // Gather every stream of a body back into a PhysicsBody
+    inline PhysicsBody Get(int id) const
+    {
+        PhysicsBody body;
+        body.sector = {sector_x[id], sector_y[id]};
+        body.position = {position_x[id], position_y[id]};
+        body.velocity = {velocity_x[id], velocity_y[id]};
+        body.rotation = rotation[id];
+        body.rotation_torque = rotation_torque[id];
+        body.is_alive = HasFlag(id, BODY_ALIVE);
+        body.is_on_screen = HasFlag(id, BODY_ON_SCREEN);
+        body.is_collision_enabled = HasFlag(id, BODY_COLLISION_ENABLED);
+        body.is_accelerating = HasFlag(id, BODY_ACCELERATING);
+        body.is_applying_torque = HasFlag(id, BODY_APPLYING_TORQUE);
+        body.is_rotating_left = HasFlag(id, BODY_ROTATING_LEFT);
+        body.is_rotating_right = HasFlag(id, BODY_ROTATING_RIGHT);
+        body.is_fast = HasFlag(id, BODY_FAST);
+        body.is_static = HasFlag(id, BODY_STATIC);
+        body.speed_limit = speed_limit[id];
+        body.deceleration_multiplier = deceleration_multiplier[id];
+        body.rotation_speed_limit = rotation_speed_limit[id];
+        body.mass = mass[id];
+        body.center = {center_x[id], center_y[id]};
+        body.width = width[id];
+        body.height = height[id];
+        body.collision = collision[id];
+        body.type = type[id];
+        body.layer = layer[id];
+        if (polygon_index[id] >= 0)
+            body.polygon = polygons[polygon_index[id]];
+        body.game_object = game_object[id];
+        body.user_data = user_data[id];
+        body.sprite = sprite[id];
+        return body;
+    }
+
+    // Fold a body that moved out of its sector into the sector it is in now. The
+    // previous state moves with it so interpolation and sweeps stay in one sector.
+    inline void CarrySector(int id)
+    {
+        const int32_t old_x = sector_x[id];
+        const int32_t old_y = sector_y[id];
+        NormalizeSectorOffset(sector_x[id], position_x[id]);
+        NormalizeSectorOffset(sector_y[id], position_y[id]);
+        previous_position_x[id] -= static_cast<float>(sector_x[id] - old_x) * WORLD_SECTOR_SIZE;
+        previous_position_y[id] -= static_cast<float>(sector_y[id] - old_y) * WORLD_SECTOR_SIZE;
+    }
+    // Bodies of [begin, end) that left their sector, after the integration
+    inline void CarrySectors(int begin, int end)
+    {
+        for (int i = begin; i < end; i++)
+        {
+            if (position_x[i] < 0.0f || position_x[i] >= WORLD_SECTOR_SIZE || position_y[i] < 0.0f || position_y[i] >= WORLD_SECTOR_SIZE)
+                CarrySector(i);
+        }
+    }
+
+    inline void Clear()
+    {
+        ForEachStream([](auto &stream) { stream.clear(); });
+        polygons.clear();
+        free_polygons.clear();
+    }
+
+private:
+    inline int32_t AllocatePolygon()
+    {
+        if (!free_polygons.empty())
+        {
+            int32_t index = free_polygons.back();
+            free_polygons.pop_back();
+            return index;
+        }
+        polygons.emplace_back();
+        return static_cast<int32_t>(polygons.size()) - 1;
+    }
+    inline void FreePolygon(int id)
+    {
+        if (polygon_index[id] < 0)
+            return;
+        free_polygons.push_back(polygon_index[id]);
+        polygon_index[id] = -1;
+    }
+};
+
+#endif // PHYSICS_BODY_STORE_H
@@ -0,0 +1,43 @@
+#ifndef PHYSICS_CONTACT_H
+#define PHYSICS_CONTACT_H
+
+#include "raylib.h"
+#include <functional>
+#include "enums.h"
+#include "physics_handle.h"
+
+constexpr int OBJECT_TYPE_COUNT = static_cast<int>(ObjectType::UNKNOWN_TYPE) + 1;
+
+// Collision found by the narrowphase. Detection only appends contacts, they are
+// dispatched once the whole tick is detected.
+struct PhysicsContact
+{
+    PhysicsHandle handle_a;
+    PhysicsHandle handle_b;
+    ObjectType type_a = ObjectType::UNKNOWN_TYPE;
+    ObjectType type_b = ObjectType::UNKNOWN_TYPE;
+    // Point on the surface of a closest to b
+    Vector2 point = {0.0f, 0.0f};
+    // Unit vector from a towards b
+    Vector2 normal = {0.0f, 0.0f};
+    // b is notified about a too (asteroid <-> asteroid)
+    bool is_mutual = false;
+
+    // Grouped by type pair, then by handle so the order never depends on threads
+    bool operator<(const PhysicsContact &other) const
+    {
+        if (type_a != other.type_a)
+            return type_a < other.type_a;
+        if (type_b != other.type_b)
+            return type_b < other.type_b;
+        if (handle_a.index != other.handle_a.index)
+            return handle_a.index < other.handle_a.index;
+        return handle_b.index < other.handle_b.index;
+    }
+};
+
+// Called once per tick with every contact of one type pair. A handler may remove
+// bodies, so contacts later in the batch can reference handles that are no longer valid.
+using ContactHandler = std::function<void(const PhysicsContact *contacts, int count)>;
+
+#endif // PHYSICS_CONTACT_H
@@ -0,0 +1,30 @@
+#ifndef PHYSICS_HANDLE_H
+#define PHYSICS_HANDLE_H
+
+#include <cstdint>
+
+// Generational handle to a body in the PhysicsSystem.
+// The slot index is recycled after a body is removed, the generation is not, so a handle
+// kept after RemoveObject no longer matches and every access can detect it.
+struct PhysicsHandle
+{
+    static constexpr uint32_t INVALID_INDEX = 0xFFFFFFFFu;
+
+    uint32_t index = INVALID_INDEX;
+    uint32_t generation = 0;
+
+    inline bool IsValid() const
+    {
+        return index != INVALID_INDEX;
+    }
+    inline bool operator==(const PhysicsHandle &other) const
+    {
+        return index == other.index && generation == other.generation;
+    }
+    inline bool operator!=(const PhysicsHandle &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+#endif // PHYSICS_HANDLE_H
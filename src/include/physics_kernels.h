@@ -0,0 +1,53 @@
+#ifndef PHYSICS_KERNELS_H
+#define PHYSICS_KERNELS_H
+
+#include <cstdint>
+
+// Instruction set used by the physics kernels
+enum class SimdPath
+{
+    Scalar,
+    SSE2,
+    AVX2,
+    WasmSimd128
+};
+
+// Body streams integrated by the integration kernel, see PhysicsBodyStore
+struct IntegrationStreams
+{
+    float *position_x;
+    float *position_y;
+    float *velocity_x;
+    float *velocity_y;
+    float *rotation;
+    float *rotation_torque;
+    uint16_t *flags;
+    const float *acceleration_x;
+    const float *acceleration_y;
+    const float *speed_limit;
+    const float *deceleration_multiplier;
+    const float *rotation_speed_limit;
+};
+
+// Kernels for one instruction set. Every path produces bit-identical results to the
+// scalar one: same operation order, no fused multiply-add and IEEE sqrt/div only.
+struct PhysicsKernels
+{
+    SimdPath path;
+    const char *name;
+    // Rotation wrap, speed clamp, friction, position/rotation update and the force field
+    // acceleration for the alive bodies in [begin, end) not deferred by the simulation LOD
+    void (*integrate)(const IntegrationStreams &streams, int begin, int end, float delta_time);
+    // hits[i] = 1 when the circle (x, y, radius) overlaps circle i
+    void (*circle_circle)(float x, float y, float radius, const float *other_x, const float *other_y, const float *other_radius, int count, uint8_t *hits);
+    // hits[i] = 1 when the circle (x, y, radius) overlaps rectangle i
+    void (*circle_rect)(float x, float y, float radius, const float *rect_x, const float *rect_y, const float *rect_width, const float *rect_height, int count, uint8_t *hits);
+};
+
+bool IsSimdPathSupported(SimdPath path);
+// Best path supported by the running CPU, detected once
+const PhysicsKernels &GetPhysicsKernels();
+// Kernels of a given path, falls back to scalar when the CPU does not support it
+const PhysicsKernels &GetPhysicsKernels(SimdPath path);
+
+#endif // PHYSICS_KERNELS_H
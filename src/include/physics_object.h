@@ -7,6 +7,11 @@
 #include <vector>
 #include <memory>
 #include "enums.h"
+#include "physics_handle.h"
+#include "convex_polygon.h"
+#include "world_position.h"
+#include "render_snapshot.h"
+#include "async_logger.h"
 
 class PhysicsObject : public std::enable_shared_from_this<PhysicsObject> 
 {
@@ -15,9 +20,11 @@ private:
     std::vector<std::weak_ptr<PhysicsObject>> colliding_objects;
 
 public:
-    int physics_id = -1;
+    PhysicsHandle physics_id;
 
     // Properties
+    // Sector the position is an offset from, see world_position.h
+    WorldSector sector;
     Vector2 position = {0.0f, 0.0f};
     Vector2 velocity = {0.0f, 0.0f};
     int id = -1;
@@ -35,21 +42,25 @@ public:
     bool is_collision_enabled = false;
 
     ObjectShape shape = ObjectShape::Circle;
+    // Collision hull around position + center, used by Triangle, Lines and Polygon shapes
+    ConvexPolygon hull;
     bool is_static = false;
+    // Fast bodies (bullets) get swept collision tests so they never tunnel
+    bool is_fast = false;
+    // Layer bits seen by the spatial queries of the PhysicsSystem
+    uint32_t layer = 1;
     bool is_colliding = false;
     ObjectType object_type;
     bool is_on_screen = false;
     bool is_alive = true; // TODO: change it
-    
-    bool is_rotating_left = false;
-    bool is_rotating_right = false;
-    bool is_accelerating = false;
+    // Sprite drawn for the body, see RenderSnapshot
+    BodySprite body_sprite;
 public:
     PhysicsObject() = default;
     static std::shared_ptr<PhysicsObject> Create(){
         std::shared_ptr<PhysicsObject> obj = std::make_shared<PhysicsObject>();
         obj->physics_id = CreatePhysicsId(obj);
-        TraceLog(LOG_INFO, "Object of type PhysicsObject created");
+        GAME_LOG(LOG_DEBUG, "Object of type PhysicsObject created");
         return obj;
     }
 
@@ -57,7 +68,7 @@ public:
     {
         colliding_objects.clear();
 
-        TraceLog(LOG_INFO, "PhysicsObject destroyed");
+        GAME_LOG(LOG_DEBUG, "PhysicsObject destroyed");
     };
 
     inline virtual void Update(float delta_time)
@@ -151,6 +162,18 @@ public:
         shape = s;
     }
 
+    // Set a convex hull local to position + center, the shape follows the vertex count
+    inline void SetHull(const Vector2 *points, int count)
+    {
+        hull = ConvexPolygon::Create(points, count);
+        if (hull.count == 2)
+            shape = ObjectShape::Lines;
+        else if (hull.count == 3)
+            shape = ObjectShape::Triangle;
+        else
+            shape = ObjectShape::Polygon;
+    }
+
     inline bool AddCollidingObject(std::shared_ptr<PhysicsObject> other){
         
         for (auto &object : colliding_objects)
@@ -179,35 +202,9 @@ public:
         colliding_objects.pop_back();
     }
 
-    // debug render shape of object and if is colliding
-    inline virtual void Render()
-    {
-        if (shape == ObjectShape::Rectangle)
-        {
-            if (is_colliding)
-            {
-                DrawRectangleRec(Rectangle({position.x, position.y, width, height}), RED);
-            }
-            else
-            {
-                DrawRectangleRec(Rectangle({position.x, position.y, width, height}), {0, 255, 0, 100});
-            }
-        }
-        else if (shape == ObjectShape::Circle)
-        {
-            if (is_colliding)
-            {
-                DrawCircleV(position, width / 2, RED);
-            }
-            else
-            {
-                DrawCircleV(position, width / 2, {0, 255, 0, 100});
-            }
-        }
-    }
     virtual void TakeDamage(float damage, Vector2 point){};
 protected:
-    static int CreatePhysicsId(std::shared_ptr<PhysicsObject> shared_physic_object);
+    static PhysicsHandle CreatePhysicsId(std::shared_ptr<PhysicsObject> shared_physic_object);
 private:
     // Check if is current colliding
     inline bool IsColliding(std::shared_ptr<PhysicsObject> other)
@@ -243,69 +240,6 @@ private:
             EnterCollision(other);
         return is_local_colliding;
     }
-    bool CheckCollisionPolygons(const std::vector<Vector2> &poly1, const std::vector<Vector2> &poly2)
-    {
-        if (poly1.size() < 3 || poly2.size() < 3)
-        {
-            return false; // Polygons must have at least 3 vertices
-        }
-        std::vector<Vector2> allVertices;
-        allVertices.insert(allVertices.end(), poly1.begin(), poly1.end());
-        allVertices.insert(allVertices.end(), poly2.begin(), poly2.end());
-
-        auto getNormals = [](const std::vector<Vector2> &poly)
-        {
-            std::vector<Vector2> normals;
-            for (size_t  i = 0; i < poly.size(); ++i)
-            {
-                Vector2 edge = poly[(i + 1) % poly.size()] - poly[i];
-                normals.push_back({-edge.y, edge.x}); // 90-degree rotation for normal
-            }
-            return normals;
-        };
-
-        std::vector<Vector2> normals1 = getNormals(poly1);
-        std::vector<Vector2> normals2 = getNormals(poly2);
-
-        auto projectPolygon = [](const std::vector<Vector2> &poly, const Vector2 &axis)
-        {
-            float min = 1e9f, max = -1e9f;
-            for (const auto &vertex : poly)
-            {
-                float projection = Vector2DotProduct(vertex, axis);
-                min = std::min(min, projection);
-                max = std::max(max, projection);
-            }
-            return std::make_pair(min, max);
-        };
-
-        for (const auto &normal : normals1)
-        {
-            auto [minA, maxA] = projectPolygon(poly1, normal);
-            auto [minB, maxB] = projectPolygon(poly2, normal);
-            if (!Intersect(minA, maxA, minB, maxB))
-            {
-                return false;
-            }
-        }
-
-        for (const auto &normal : normals2)
-        {
-            auto [minA, maxA] = projectPolygon(poly1, normal);
-            auto [minB, maxB] = projectPolygon(poly2, normal);
-            if (!Intersect(minA, maxA, minB, maxB))
-            {
-                return false;
-            }
-        }
-
-        return true;
-    }
-
-    bool Intersect(float minA, float maxA, float minB, float maxB)
-    {
-        return !(maxB < minA || maxA < minB);
-    }
 };
 
 #endif // PHYSICS_OBJECT_H
\ No newline at end of file
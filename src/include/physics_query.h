@@ -0,0 +1,39 @@
+#ifndef PHYSICS_QUERY_H
+#define PHYSICS_QUERY_H
+
+#include "raylib.h"
+#include <cstdint>
+#include "enums.h"
+#include "physics_handle.h"
+
+constexpr uint32_t QUERY_ALL = 0xFFFFFFFF;
+
+inline constexpr uint32_t ObjectTypeBit(ObjectType type)
+{
+    return 1u << static_cast<uint32_t>(type);
+}
+
+// Which bodies a spatial query reports. Only live bodies in the broadphase are seen,
+// the ones with collision enabled.
+struct QueryFilter
+{
+    // ObjectTypeBit of every accepted type
+    uint32_t type_mask = QUERY_ALL;
+    // Accepts bodies whose layer shares a bit with this mask
+    uint32_t layer_mask = QUERY_ALL;
+    // Skipped, usually the body running the query
+    PhysicsHandle ignore;
+};
+
+// Closest body along a ray
+struct RaycastHit
+{
+    PhysicsHandle handle;
+    ObjectType type = ObjectType::UNKNOWN_TYPE;
+    Vector2 point = {0.0f, 0.0f};
+    // Surface normal at point, facing the ray
+    Vector2 normal = {0.0f, 0.0f};
+    float distance = 0.0f;
+};
+
+#endif // PHYSICS_QUERY_H
@@ -1,76 +1,215 @@
 #ifndef PHYSICS_SYSTEM_H
 #define PHYSICS_SYSTEM_H
 
+#include <algorithm>
+#include <atomic>
 #include <vector>
 #include <map>
+#include <functional>
 #include <memory>
 #include "physics_object.h"
+#include "physics_body_store.h"
+#include "physics_kernels.h"
+#include "dynamic_aabb_tree.h"
+#include "physics_thread_pool.h"
+#include "physics_contact.h"
+#include "physics_query.h"
+#include "barnes_hut.h"
+#include "force_field.h"
+#include "world_position.h"
+#include "swept_collision.h"
 #include "enums.h"
 #include "global.h"
 
-struct PhysicsBody
+// Simulation LOD tiers, by distance from the view center
+enum SimulationTier : uint8_t
 {
-    Vector2 position{};
-    Vector2 center{};
-    float rotation = 0;
-    float rotation_torque = 0;
-    float speed_limit = 0;
-    float deceleration_multiplier = 0;
-    float rotation_speed_limit = 0;
-    Vector2 velocity{};
-    ObjectShape collision = ObjectShape::Circle;
-    ObjectType type = ObjectType::UNKNOWN_TYPE;
-    float width = 0.0f;
-    float height = 0.0f;
-    bool is_alive = false;
-    bool is_on_screen = false;
-    bool is_collision_enabled = false;
-    bool is_accelerating = false;
-    bool is_applying_torque = false;
-    bool is_rotating_left = false;
-    bool is_rotating_right = false;
-    std::weak_ptr<PhysicsObject> game_object;
+    SIM_TIER_NEAR, // integrated every tick
+    SIM_TIER_MID,  // integrated every few ticks with the time accumulated meanwhile
+    SIM_TIER_FAR,  // only accumulates time, caught up when back in range
+    SIM_TIER_COUNT
 };
 
 class PhysicsSystem
 {
 private:
-    float m_gravity_x;
-    float m_gravity_y;
-    // unique player for now
-    int player_id;
-    std::vector<PhysicsBody> physics_body_list;
+    // Bodies stored as parallel dense arrays, iterated without holes
+    PhysicsBodyStore bodies;
+    // Slot map from handle index to dense index, the generation of a slot changes every
+    // time its body is removed so stale handles are detected
+    std::vector<uint32_t> slot_generations;
+    std::vector<int> slot_to_dense;
+    std::vector<uint32_t> free_slots;
+    // Bodies removed since the last tick, compacted at the start of the next FixUpdate
+    // so removing from a collision callback never moves bodies under the running loops
+    std::vector<int> pending_removals;
+    // Accesses through a handle whose body was already removed (debug)
+    mutable int stale_handle_accesses = 0;
+    // Broadphase trees of the bodies that have collision enabled, updated incrementally.
+    // Static bodies get their own tree so moving bodies never rebalance around them.
+    // Leaves hold the slot of the body, which stays the same when bodies are compacted.
+    DynamicAabbTree dynamic_tree;
+    DynamicAabbTree static_tree;
+    // Pairs that passed the broadphase on the last tick (debug)
+    int candidate_pairs = 0;
+    // Integration and narrowphase kernels for the instruction set picked at startup
+    const PhysicsKernels *kernels = &GetPhysicsKernels();
 
-    inline bool IsPositionOnScreen(Vector2 world_position, Vector2 camera_position)
+    // Candidates of one body gathered by shape so the narrowphase kernels test them in batches
+    struct NarrowphaseBatch
     {
-        if (world_position.x >= camera_position.x && world_position.x <= camera_position.x + virtual_screen_width &&
-            world_position.y >= camera_position.y && world_position.y <= camera_position.y + virtual_screen_height)
+        std::vector<int> circle_ids;
+        std::vector<float> circle_x;
+        std::vector<float> circle_y;
+        std::vector<float> circle_radius;
+        std::vector<int> rect_ids;
+        std::vector<float> rect_x;
+        std::vector<float> rect_y;
+        std::vector<float> rect_width;
+        std::vector<float> rect_height;
+        // Hulls have no batched kernel, they go through the scalar SAT tests
+        std::vector<int> polygon_ids;
+        std::vector<uint8_t> hits;
+        std::vector<int> hit_ids;
+        // Fraction of the tick where each hit happened, 1 for the end of tick overlap tests
+        std::vector<float> hit_times;
+
+        void Clear()
         {
-            return true; // Position is on screen
+            circle_ids.clear();
+            circle_x.clear();
+            circle_y.clear();
+            circle_radius.clear();
+            rect_ids.clear();
+            rect_x.clear();
+            rect_y.clear();
+            rect_width.clear();
+            rect_height.clear();
+            polygon_ids.clear();
+            hit_ids.clear();
+            hit_times.clear();
         }
-        else
+        // position: of the body relative to the frame sector
+        void Add(const PhysicsBodyStore &store, int id, Vector2 position)
         {
-            return false; // Position is off screen
+            if (store.collision[id] == ObjectShape::Circle)
+            {
+                circle_ids.push_back(id);
+                circle_x.push_back(position.x + store.center_x[id]);
+                circle_y.push_back(position.y + store.center_y[id]);
+                circle_radius.push_back(store.width[id] / 2);
+            }
+            else if (store.collision[id] == ObjectShape::Rectangle)
+            {
+                rect_ids.push_back(id);
+                rect_x.push_back(position.x);
+                rect_y.push_back(position.y);
+                rect_width.push_back(store.width[id]);
+                rect_height.push_back(store.height[id]);
+            }
+            else if (IsPolygonShape(store.collision[id]))
+            {
+                polygon_ids.push_back(id);
+            }
+        }
+    };
+
+    // Scratch state owned by one thread during the narrowphase
+    struct CollisionWorker
+    {
+        DynamicAabbTree::QueryContext query;
+        NarrowphaseBatch narrowphase;
+        std::vector<PhysicsContact> contacts;
+        int candidate_pairs = 0;
+    };
+    // Bodies integrated and sources tested per chunk handed to a thread
+    static constexpr int INTEGRATION_CHUNK_SIZE = 4096;
+    static constexpr int NARROWPHASE_CHUNK_SIZE = 256;
+    PhysicsThreadPool thread_pool{PhysicsThreadPool::GetHardwareThreadCount()};
+    std::vector<CollisionWorker> collision_workers;
+    // Simulation LOD settings and the body count per tier
+    bool is_lod_enabled = true;
+    float lod_near_distance = 1000.0f;
+    float lod_mid_distance = 3000.0f;
+    int lod_mid_interval = 4;
+    unsigned int tick_index = 0;
+    // Time simulated since the start, deferred bodies remember up to when they are simulated
+    double simulated_time = 0.0;
+    int tier_counts[SIM_TIER_COUNT] = {};
+    // Contacts of every worker merged and grouped by type pair
+    std::vector<PhysicsContact> contacts;
+    // Handler per (type_a, type_b), pairs without one notify the game objects
+    ContactHandler contact_handlers[OBJECT_TYPE_COUNT][OBJECT_TYPE_COUNT];
+    // Traversal stack of the public spatial queries, which run on the game thread
+    mutable DynamicAabbTree::QueryContext query_context;
+    // Mutual gravity of the bodies with mass, through a Barnes-Hut tree rebuilt every tick
+    BarnesHutTree gravity_tree;
+    bool is_n_body_enabled = false;
+    float gravity_constant = 1.0f;
+    float gravity_theta = 0.5f;
+    float gravity_softening = 10.0f;
+    uint32_t gravity_type_mask = ObjectTypeBit(ObjectType::PLAYER_TYPE) | ObjectTypeBit(ObjectType::ASTEROID_TYPE);
+    // Planet wells, nebula drag and solar wind baked per sector, plus the uniform gravity
+    ForceField force_field;
+    // Sources that follow a body, moved with it and removed with it
+    struct AttachedForceSource
+    {
+        int source = -1;
+        PhysicsHandle body;
+        // Source position relative to the body position
+        Vector2 offset = {0.0f, 0.0f};
+    };
+    std::vector<AttachedForceSource> attached_sources;
+    // Sector of the view on the last tick. Collision tests, the broadphase trees and
+    // the spatial queries work in floats relative to its corner, which are exact
+    // around the view where they matter.
+    WorldSector frame_sector;
+    // Published at the end of every tick
+    RenderSnapshot render_snapshot;
+
+    // Collision is only enabled for bodies on screen, written without branches since
+    // it runs for every body every tick. view is relative to the frame sector.
+    inline void UpdateScreenFlags(int begin, int end, Rectangle view)
+    {
+        const float right = view.x + view.width;
+        const float bottom = view.y + view.height;
+        const uint16_t screen_flags = BODY_ON_SCREEN | BODY_COLLISION_ENABLED;
+        for (int i = begin; i < end; i++)
+        {
+            const float x = static_cast<float>(bodies.sector_x[i] - frame_sector.x) * WORLD_SECTOR_SIZE + bodies.position_x[i];
+            const float y = static_cast<float>(bodies.sector_y[i] - frame_sector.y) * WORLD_SECTOR_SIZE + bodies.position_y[i];
+            const uint16_t flags = bodies.flags[i];
+            const bool is_on_screen = (flags & BODY_ALIVE) & (x >= view.x) & (x <= right) & (y >= view.y) & (y <= bottom);
+            bodies.flags[i] = static_cast<uint16_t>((flags & ~screen_flags) | (is_on_screen ? screen_flags : 0));
         }
     }
 public:
-    inline int CreatePhysicsObject(PhysicsBody body)
-    {
-        int index_saved = static_cast<int>(physics_body_list.size());
-        for (int i=0;i<index_saved;i++){
-            if(!physics_body_list[i].is_alive){
-                physics_body_list[i] = body;
-                if(body.type == ObjectType::PLAYER_TYPE){
-                    player_id = i;
-                }
-                return i;
-            }
+    inline PhysicsHandle CreatePhysicsObject(PhysicsBody body)
+    {
+        uint32_t slot;
+        if (!free_slots.empty())
+        {
+            slot = free_slots.back();
+            free_slots.pop_back();
         }
-        physics_body_list.push_back(body);
-        if(body.type == ObjectType::PLAYER_TYPE){
-            player_id = index_saved;
+        else
+        {
+            slot = static_cast<uint32_t>(slot_generations.size());
+            slot_generations.push_back(0);
+            slot_to_dense.push_back(-1);
         }
-        return index_saved;
+        slot_to_dense[slot] = bodies.Size();
+        bodies.PushBack(body);
+        tier_counts[SIM_TIER_NEAR]++;
+        bodies.slot.back() = slot;
+        return {slot, slot_generations[slot]};
+    }
+
+    // True while the body the handle was created for has not been removed
+    inline bool IsValid(PhysicsHandle handle) const
+    {
+        return handle.IsValid() && handle.index < slot_generations.size() &&
+               slot_generations[handle.index] == handle.generation && slot_to_dense[handle.index] >= 0;
     }
 
     static PhysicsSystem &GetInstance(float gravity_x = 0.0f, float gravity_y = 0.0f)
@@ -79,154 +218,415 @@ public:
         return instance;
     }
 
-    inline PhysicsBody& GetPhysicsObject(int id)
+    // Copy of the body, a removed body reads back as not alive
+    inline PhysicsBody GetPhysicsObject(PhysicsHandle handle) const
     {
-        return physics_body_list[id];
+        int id = GetDenseIndex(handle);
+        if (id < 0)
+            return PhysicsBody();
+        return bodies.Get(id);
+    }
+    // Copy of the body with position and rotation blended between the last two ticks,
+    // alpha 0 is the previous tick and 1 the current one
+    inline PhysicsBody GetInterpolatedPhysicsObject(PhysicsHandle handle, float alpha) const
+    {
+        int id = GetDenseIndex(handle);
+        if (id < 0)
+            return PhysicsBody();
+        PhysicsBody body = bodies.Get(id);
+        body.position = Vector2Lerp({bodies.previous_position_x[id], bodies.previous_position_y[id]}, body.position, alpha);
+        body.rotation = LerpRotation(bodies.previous_rotation[id], body.rotation, alpha);
+        return body;
     }
 
     // Delete copy constructor and assignment operator
     PhysicsSystem(const PhysicsSystem &) = delete;
     PhysicsSystem &operator=(const PhysicsSystem &) = delete;
 
-    inline void FixUpdate(float delta_time, Vector2 camera_with_offset)
+    inline int GetCandidatePairCount() const
     {
-        for (PhysicsBody& body : physics_body_list)
-        {
-            if (body.is_alive)
-            {
-                Move(delta_time, body);
-                body.velocity.y += m_gravity_y * delta_time;
-                body.velocity.x += m_gravity_x * delta_time;
-                body.is_on_screen = IsPositionOnScreen(body.position, camera_with_offset);
-                if (body.is_on_screen)
-                {
-                    body.is_collision_enabled = true;
-                    if(body.type == ObjectType::ASTEROID_TYPE){
-                        CheckAstronomicalObjectCollisions(body);
-                    }else if(body.type == ObjectType::BULLET_TYPE){
-                        CheckBulletCollisions(body);
-                    }
-                }
-                else
-                {
-                    body.is_collision_enabled = false;
-                }
-            }
-        }
+        return candidate_pairs;
+    }
+    inline int GetBodyCount() const
+    {
+        return bodies.Size();
+    }
+    inline int GetStaleHandleAccessCount() const
+    {
+        return stale_handle_accesses;
     }
-    inline void Move(float delta_time, PhysicsBody& body){
-        
-        // ensure our angle is between -180 and +180
-        if (body.rotation > 180.0f)
-            body.rotation -= 360.0f;
 
-        if (body.rotation < -180.0f)
-            body.rotation += 360.0f;
+    // Force an instruction set for the kernels, unsupported ones fall back to scalar
+    inline void SetSimdPath(SimdPath path)
+    {
+        kernels = &GetPhysicsKernels(path);
+    }
+    inline const char *GetSimdPathName() const
+    {
+        return kernels->name;
+    }
+    // Handle every contact of a type pair in one call, instead of EnterCollision on both
+    // game objects. Contacts are oriented as detected: bullet -> asteroid,
+    // asteroid -> player and asteroid -> asteroid. An empty handler restores the default.
+    inline void SetContactHandler(ObjectType type_a, ObjectType type_b, ContactHandler handler)
+    {
+        contact_handlers[static_cast<int>(type_a)][static_cast<int>(type_b)] = std::move(handler);
+    }
+    // Default dispatch: EnterCollision on the game objects, skipped once a callback
+    // removed one of the bodies. Handlers call it for the contacts they leave alone.
+    inline void NotifyCollision(const PhysicsContact &contact)
+    {
+        if (!IsValid(contact.handle_a) || !IsValid(contact.handle_b))
+            return;
+        std::shared_ptr<PhysicsObject> object_a = GetGameObject(contact.handle_a);
+        std::shared_ptr<PhysicsObject> object_b = GetGameObject(contact.handle_b);
+        if (object_a)
+            object_a->EnterCollision(object_b);
+        if (contact.is_mutual && object_b && IsValid(contact.handle_a) && IsValid(contact.handle_b))
+            object_b->EnterCollision(object_a);
+    }
+    // Contacts dispatched on the last tick
+    inline const std::vector<PhysicsContact> &GetContacts() const
+    {
+        return contacts;
+    }
+    inline std::shared_ptr<PhysicsObject> GetGameObject(PhysicsHandle handle) const
+    {
+        int id = GetDenseIndex(handle);
+        if (id < 0)
+            return nullptr;
+        return bodies.game_object[id].lock();
+    }
+    // Owner set in PhysicsBody::user_data, 0 for an invalid handle
+    inline uint64_t GetUserData(PhysicsHandle handle) const
+    {
+        int id = GetDenseIndex(handle);
+        if (id < 0)
+            return 0;
+        return bodies.user_data[id];
+    }
 
-        // Limit speed
-        if (Vector2Length(body.velocity) > body.speed_limit)
-        {
-            body.velocity = Vector2Normalize(body.velocity);
-            body.velocity = Vector2Scale(body.velocity, body.speed_limit);
-        }
+    // Spatial queries over the broadphase trees. Results go to buffers owned by the
+    // caller, nothing is allocated once the traversal stack has grown. Positions are
+    // relative to the frame sector, like the positions of the contacts.
 
-        // Update position if velocity is different then 0
-        if (Vector2Length(body.velocity) > 0.0f)
+    // Closest body crossed by the segment from start to end
+    inline bool Raycast(Vector2 start, Vector2 end, const QueryFilter &filter, RaycastHit &hit) const
+    {
+        bool is_hit = false;
+        float closest_time = 1.0f;
+        auto visit = [&](int slot, float max_fraction) -> float
         {
-            // Friction
-            body.velocity = Vector2Scale(body.velocity, 1 - body.deceleration_multiplier * delta_time);
-            body.position = Vector2Add(body.position, Vector2Scale(body.velocity, delta_time));
-        }else{
-            body.is_accelerating = false;
-        }
-        // adjust rotation_torque to rotation_speed_limit
-        if (body.rotation_torque > body.rotation_speed_limit)
+            int id = slot_to_dense[slot];
+            float time = 0.0f;
+            Vector2 normal;
+            if (!PassesFilter(id, filter) || !RaycastBody(id, start, end, time, normal) || time > closest_time)
+                return max_fraction;
+            is_hit = true;
+            closest_time = time;
+            hit.handle = GetHandle(id);
+            hit.type = bodies.type[id];
+            hit.point = Vector2Lerp(start, end, time);
+            hit.normal = normal;
+            hit.distance = time * Vector2Distance(start, end);
+            return time;
+        };
+        dynamic_tree.RayCast(start, end, query_context, visit);
+        static_tree.RayCast(start, end, query_context, visit);
+        return is_hit;
+    }
+    // Bodies overlapping the circle, returns how many were written to results
+    inline int OverlapCircle(Vector2 center, float radius, const QueryFilter &filter, PhysicsHandle *results, int max_results) const
+    {
+        int count = 0;
+        const Rectangle bounds = {center.x - radius, center.y - radius, radius * 2, radius * 2};
+        auto visit = [&](int slot)
         {
-            body.rotation_torque = body.rotation_speed_limit;
-        }
-        else if (body.rotation_torque < -body.rotation_speed_limit)
+            int id = slot_to_dense[slot];
+            if (count < max_results && PassesFilter(id, filter) && OverlapsCircle(id, center, radius))
+                results[count++] = GetHandle(id);
+        };
+        dynamic_tree.Query(bounds, query_context, visit);
+        static_tree.Query(bounds, query_context, visit);
+        return count;
+    }
+    // Bodies overlapping the rectangle, returns how many were written to results
+    inline int OverlapAABB(Rectangle bounds, const QueryFilter &filter, PhysicsHandle *results, int max_results) const
+    {
+        int count = 0;
+        auto visit = [&](int slot)
+        {
+            int id = slot_to_dense[slot];
+            if (count < max_results && PassesFilter(id, filter) && OverlapsRectangle(id, bounds))
+                results[count++] = GetHandle(id);
+        };
+        dynamic_tree.Query(bounds, query_context, visit);
+        static_tree.Query(bounds, query_context, visit);
+        return count;
+    }
+    // Up to k bodies whose collision center is within max_distance of point, closest
+    // first. distances receives the distance of each result.
+    inline int KNearest(Vector2 point, float max_distance, const QueryFilter &filter, int k, PhysicsHandle *results, float *distances) const
+    {
+        if (k <= 0)
+            return 0;
+        int count = 0;
+        const float max_distance_sqr = max_distance * max_distance;
+        const Rectangle bounds = {point.x - max_distance, point.y - max_distance, max_distance * 2, max_distance * 2};
+        auto visit = [&](int slot)
+        {
+            int id = slot_to_dense[slot];
+            if (!PassesFilter(id, filter))
+                return;
+            // Squared distances while searching
+            float distance = Vector2DistanceSqr(GetCollisionCenter(id), point);
+            if (distance > max_distance_sqr || (count == k && distance >= distances[k - 1]))
+                return;
+            // Insertion into the sorted results, the farthest drops out once k are found
+            int i = count < k ? count++ : k - 1;
+            while (i > 0 && distances[i - 1] > distance)
+            {
+                distances[i] = distances[i - 1];
+                results[i] = results[i - 1];
+                i--;
+            }
+            distances[i] = distance;
+            results[i] = GetHandle(id);
+        };
+        dynamic_tree.Query(bounds, query_context, visit);
+        static_tree.Query(bounds, query_context, visit);
+        for (int i = 0; i < count; i++)
+            distances[i] = sqrtf(distances[i]);
+        return count;
+    }
+
+    // Bodies closer than near_distance to the view tick every step, the ones closer than
+    // mid_distance every mid_interval steps, the rest only when they come back in range.
+    // Deferred bodies check their distance on the steps they are due, every mid_interval.
+    inline void SetSimulationLod(float near_distance, float mid_distance, int mid_interval)
+    {
+        lod_near_distance = near_distance;
+        lod_mid_distance = std::max(mid_distance, near_distance);
+        // Rounded up to a power of two so the per-body due check is a mask
+        lod_mid_interval = 1;
+        while (lod_mid_interval < mid_interval)
+            lod_mid_interval *= 2;
+    }
+    // Disabled, every body is near
+    inline void SetSimulationLodEnabled(bool enabled)
+    {
+        if (!enabled && is_lod_enabled)
         {
-            body.rotation_torque = -body.rotation_speed_limit;
+            // Catch every deferred body up, the kernels integrate all of them from now on
+            for (int i = 0; i < bodies.Size(); i++)
+            {
+                if (bodies.lod_tier[i] != SIM_TIER_NEAR)
+                    AdvanceBody(i, static_cast<float>(simulated_time - bodies.lod_time[i]));
+                bodies.lod_tier[i] = SIM_TIER_NEAR;
+                bodies.SetFlag(i, BODY_LOD_DEFERRED, false);
+            }
+            tier_counts[SIM_TIER_NEAR] = bodies.Size();
+            tier_counts[SIM_TIER_MID] = 0;
+            tier_counts[SIM_TIER_FAR] = 0;
         }
-        // Update rotation if rotational_velocity is different then 0
-        if (body.rotation_torque != 0.0f)
+        is_lod_enabled = enabled;
+    }
+    inline int GetTierCount(SimulationTier tier) const
+    {
+        return tier_counts[tier];
+    }
+
+    // Threads used by FixUpdate, including the calling one
+    inline void SetThreadCount(int thread_count)
+    {
+        thread_pool.SetThreadCount(thread_count);
+    }
+    inline int GetThreadCount() const
+    {
+        return thread_pool.GetThreadCount();
+    }
+
+    // camera_with_offset: top left of the view, relative to the corner of view_sector
+    inline void FixUpdate(float delta_time, Vector2 camera_with_offset, WorldSector view_sector = WorldSector())
+    {
+        FlushRemovals();
+        SetFrameSector(view_sector);
+        bodies.SavePreviousState();
+        tick_index++;
+        simulated_time += delta_time;
+        Vector2 view_center = {camera_with_offset.x + virtual_screen_width / 2.0f, camera_with_offset.y + virtual_screen_height / 2.0f};
+        const Rectangle view = {camera_with_offset.x, camera_with_offset.y, static_cast<float>(virtual_screen_width), static_cast<float>(virtual_screen_height)};
+        std::atomic<int> tier_changes[SIM_TIER_COUNT] = {{0}, {0}, {0}};
+        UpdateForceSources();
+        if (is_n_body_enabled)
+            BuildGravityTree();
+        IntegrationStreams streams = bodies.GetIntegrationStreams();
+        // Integration only touches the streams of the body itself, chunks run in parallel
+        thread_pool.ParallelFor(bodies.Size(), INTEGRATION_CHUNK_SIZE, [&](int begin, int end, int)
         {
-            body.rotation += body.rotation_torque * delta_time;
-            // Update rotational velocity
-            if (!body.is_applying_torque)
+            if (is_lod_enabled)
             {
-                body.rotation_torque = body.rotation_torque * (1 - body.deceleration_multiplier * delta_time);
+                // Only the bodies due this tick are looked at, one every lod_mid_interval
+                int chunk_changes[SIM_TIER_COUNT] = {};
+                const int mask = lod_mid_interval - 1;
+                for (int i = begin + ((-(begin + static_cast<int>(tick_index))) & mask); i < end; i += lod_mid_interval)
+                {
+                    if (!bodies.HasFlag(i, BODY_ALIVE))
+                        continue;
+                    int previous_tier = bodies.lod_tier[i];
+                    int tier = UpdateSimulationTier(i, delta_time, view_center);
+                    chunk_changes[previous_tier]--;
+                    chunk_changes[tier]++;
+                }
+                for (int tier = 0; tier < SIM_TIER_COUNT; tier++)
+                    tier_changes[tier] += chunk_changes[tier];
             }
-            body.is_applying_torque = false;
-        }
-        // // check if still colliding
-        // for (int i = body.colliding_objects.size() - 1; i >= 0; i--)
-        // {
-        //     if (auto shared_object = body.colliding_objects[i].lock())
-        //     {
-        //         if (!body.IsColliding(shared_object))
-        //         {
-        //             body.ExitCollision(shared_object);
-        //         }
-        //     }
-        //     else
-        //     {
-        //         body.colliding_objects.erase(body.colliding_objects.begin() + i);
-        //         if (colliding_objects.size() == 0)
-        //             body.is_colliding = false;
-        //     }
-        // }
-    }
-    inline void RemoveObject(int object_id)
-    {
-        if (object_id < 0)
-            return;
-        PhysicsBody& body = physics_body_list[object_id];
-        if (!body.is_alive)
+            if (is_n_body_enabled)
+                ApplyNBodyGravity(begin, end, delta_time);
+            ApplyForceField(begin, end, delta_time);
+            kernels->integrate(streams, begin, end, delta_time);
+            bodies.CarrySectors(begin, end);
+            UpdateScreenFlags(begin, end, view);
+        });
+        for (int tier = 0; tier < SIM_TIER_COUNT; tier++)
+            tier_counts[tier] += tier_changes[tier];
+        UpdateBroadphase();
+        CheckCollisions();
+        PublishRenderSnapshot();
+    }
+    // Bodies with a sprite as this tick left them, read by the renderer until the next tick
+    inline const RenderSnapshot &GetRenderSnapshot() const
+    {
+        return render_snapshot;
+    }
+    inline void RemoveObject(PhysicsHandle handle)
+    {
+        int id = GetDenseIndex(handle);
+        if (id < 0)
             return;
-        body.is_alive = false;
-        body.game_object.reset();
+        // Invalidate the handle now, the slot is recycled once the body is compacted
+        slot_generations[handle.index]++;
+        bodies.SetFlag(id, BODY_ALIVE, false);
+        bodies.game_object[id].reset();
+        pending_removals.push_back(id);
     }
 
+    // Uniform acceleration felt by every moving body, on top of the force sources
     inline void SetGravity(float x, float y)
     {
-        m_gravity_x = x;
-        m_gravity_y = y;
+        force_field.SetUniformAcceleration(x, y);
+    }
+    // Static or slow moving influence, baked in the force field. A source attached to a
+    // body follows it from one tick to the next and goes away with it. Returns the id of
+    // the source, valid until Unload.
+    inline int AddForceSource(const ForceSource &source, PhysicsHandle body = PhysicsHandle())
+    {
+        int id = force_field.AddSource(source);
+        int dense = GetDenseIndex(body);
+        if (dense >= 0)
+        {
+            Vector2 source_position = WorldPosition{source.sector, source.position}.RelativeTo({bodies.sector_x[dense], bodies.sector_y[dense]});
+            attached_sources.push_back({id, body, {source_position.x - bodies.position_x[dense], source_position.y - bodies.position_y[dense]}});
+        }
+        return id;
+    }
+    // Only the sectors the source reaches, before and after, are baked again
+    inline void MoveForceSource(int id, Vector2 position, WorldSector sector = WorldSector())
+    {
+        force_field.MoveSource(id, position, sector);
+    }
+    inline void RemoveForceSource(int id)
+    {
+        force_field.RemoveSource(id);
+    }
+    // Field as baked for the last tick, sectors invalidated since then are baked on the next one
+    inline ForceSample SampleForceField(Vector2 position, WorldSector sector = WorldSector()) const
+    {
+        return force_field.Sample(sector, position.x, position.y);
+    }
+    inline const ForceField &GetForceField() const
+    {
+        return force_field;
+    }
+    // Bodies of the types in type_mask with a mass pull each other. Static bodies pull
+    // through the force field instead, deferred LOD bodies neither pull the others nor
+    // get pulled.
+    inline void SetNBodyGravity(bool enabled, float in_gravity_constant = 1.0f, uint32_t type_mask = ObjectTypeBit(ObjectType::PLAYER_TYPE) | ObjectTypeBit(ObjectType::ASTEROID_TYPE))
+    {
+        is_n_body_enabled = enabled;
+        gravity_constant = in_gravity_constant;
+        gravity_type_mask = type_mask;
+        if (!enabled)
+            gravity_tree.Clear();
+    }
+    // theta: opening angle of the Barnes-Hut tree, lower is more accurate and slower.
+    // softening: distance under which the pull stops growing.
+    inline void SetNBodyAccuracy(float theta, float softening)
+    {
+        gravity_theta = std::max(theta, 0.0f);
+        gravity_softening = std::max(softening, 0.0f);
+    }
+    inline float GetNBodyTheta() const
+    {
+        return gravity_theta;
     }
 
-    inline void ApplyForce(int object_id, float force)
+    // Teleport a body to an offset from the corner of sector, it is not swept or
+    // interpolated from its old position
+    inline void SetTransform(PhysicsHandle handle, Vector2 position, float rotation, WorldSector sector = WorldSector())
     {
-        if (object_id < 0)
+        int id = GetDenseIndex(handle);
+        if (id < 0)
             return;
-        PhysicsBody& body = physics_body_list[object_id];
-        if (!body.is_alive)
+        const WorldPosition world = WorldPosition::FromOffset(sector, position);
+        bodies.position_x[id] = bodies.previous_position_x[id] = world.local.x;
+        bodies.position_y[id] = bodies.previous_position_y[id] = world.local.y;
+        bodies.sector_x[id] = world.sector.x;
+        bodies.sector_y[id] = world.sector.y;
+        bodies.rotation[id] = bodies.previous_rotation[id] = rotation;
+    }
+    // Sector the spatial queries and the collision contacts are relative to
+    inline WorldSector GetFrameSector() const
+    {
+        return frame_sector;
+    }
+    // The view moved to another sector: move the boxes of the broadphase trees to the
+    // new frame, only the bodies on screen are in them. FixUpdate does it for its view.
+    inline void SetFrameSector(WorldSector sector)
+    {
+        if (sector == frame_sector)
             return;
-        Vector2 direction = {sinf(body.rotation * DEG2RAD), -cosf(body.rotation * DEG2RAD)};
-        body.velocity = Vector2Scale(direction, force);
-        body.is_accelerating = true;
+        Vector2 offset = frame_sector.OffsetFrom(sector);
+        dynamic_tree.ShiftOrigin(offset);
+        static_tree.ShiftOrigin(offset);
+        frame_sector = sector;
     }
-    inline void ApplyForce(int object_id, float force, Vector2 direction)
+    inline void ApplyForce(PhysicsHandle handle, float force)
     {
-        if (object_id < 0)
+        int id = GetDenseIndex(handle);
+        if (id < 0)
             return;
-        PhysicsBody& body = physics_body_list[object_id];
-        if (!body.is_alive)
+        float rotation = bodies.rotation[id];
+        Vector2 direction = {sinf(rotation * DEG2RAD), -cosf(rotation * DEG2RAD)};
+        SetVelocity(id, Vector2Scale(direction, force));
+    }
+    inline void ApplyForce(PhysicsHandle handle, float force, Vector2 direction)
+    {
+        int id = GetDenseIndex(handle);
+        if (id < 0)
             return;
         // move forward based on rotation angle
-        body.velocity = Vector2Scale(direction, force);
-        body.is_accelerating = true;
+        SetVelocity(id, Vector2Scale(direction, force));
     }
-    inline void ApplyTorque(int object_id, float torque)
+    inline void ApplyTorque(PhysicsHandle handle, float torque)
     {
-        if (object_id < 0)
-            return;
-        PhysicsBody& body = physics_body_list[object_id];
-        if (!body.is_alive)
+        int id = GetDenseIndex(handle);
+        if (id < 0)
             return;
-        body.rotation_torque += torque;
-        body.is_applying_torque = true;
-        body.is_rotating_left = torque < 0;
-        body.is_rotating_right = torque > 0;
+        bodies.rotation_torque[id] += torque;
+        bodies.SetFlag(id, BODY_APPLYING_TORQUE, true);
+        bodies.SetFlag(id, BODY_ROTATING_LEFT, torque < 0);
+        bodies.SetFlag(id, BODY_ROTATING_RIGHT, torque > 0);
     }
 
     // Destructor
@@ -236,70 +636,684 @@ public:
     }
     void Unload()
     {
-        physics_body_list.clear();
+        // Keep the generations so handles from before the unload stay invalid
+        free_slots.clear();
+        // Pushed from the back so slots are handed out again in ascending order
+        for (uint32_t slot = static_cast<uint32_t>(slot_generations.size()); slot-- > 0;)
+        {
+            if (slot_to_dense[slot] >= 0)
+            {
+                slot_generations[slot]++;
+                slot_to_dense[slot] = -1;
+            }
+            free_slots.push_back(slot);
+        }
+        pending_removals.clear();
+        bodies.Clear();
+        dynamic_tree.Clear();
+        static_tree.Clear();
+        force_field.Clear();
+        attached_sources.clear();
+        frame_sector = WorldSector();
+        render_snapshot.Clear();
+        std::fill(std::begin(tier_counts), std::end(tier_counts), 0);
     }
 
 private:
     // Private constructor
     PhysicsSystem(float gravity_x = 0.0f, float gravity_y = 0.0f)
-        : m_gravity_x(gravity_x), m_gravity_y(gravity_y) {}
+    {
+        force_field.SetUniformAcceleration(gravity_x, gravity_y);
+    }
+
+    // Dense index of a live handle, -1 for an invalid or stale one
+    inline int GetDenseIndex(PhysicsHandle handle) const
+    {
+        if (!handle.IsValid() || handle.index >= slot_generations.size())
+            return -1;
+        if (slot_generations[handle.index] != handle.generation)
+        {
+            stale_handle_accesses++;
+            return -1;
+        }
+        return slot_to_dense[handle.index];
+    }
+    // Pack the alive bodies with a sprite, in dense order, once the tick is over
+    inline void PublishRenderSnapshot()
+    {
+        render_snapshot.Begin(tick_index);
+        for (int id = 0; id < bodies.Size(); id++)
+        {
+            if (!bodies.sprite[id].sprite.IsValid() || !bodies.HasFlag(id, BODY_ALIVE))
+                continue;
+            RenderProxy proxy;
+            proxy.handle = {bodies.slot[id], slot_generations[bodies.slot[id]]};
+            proxy.sector = {bodies.sector_x[id], bodies.sector_y[id]};
+            proxy.previous_position = {bodies.previous_position_x[id], bodies.previous_position_y[id]};
+            proxy.position = {bodies.position_x[id], bodies.position_y[id]};
+            proxy.previous_rotation = bodies.previous_rotation[id];
+            proxy.rotation = bodies.rotation[id];
+            proxy.sprite = bodies.sprite[id];
+            proxy.is_on_screen = bodies.HasFlag(id, BODY_ON_SCREEN);
+            proxy.is_accelerating = bodies.HasFlag(id, BODY_ACCELERATING);
+            proxy.is_rotating_left = bodies.HasFlag(id, BODY_ROTATING_LEFT);
+            proxy.is_rotating_right = bodies.HasFlag(id, BODY_ROTATING_RIGHT);
+            render_snapshot.Add(proxy);
+        }
+    }
 
-    inline void CheckBulletCollisions(PhysicsBody& bullet)
+    // Swap-and-pop the bodies removed since the last tick and recycle their slots
+    inline void FlushRemovals()
     {
-        for (PhysicsBody& body : physics_body_list)
+        if (pending_removals.empty())
+            return;
+        // Highest index first so the body moved into a hole is never one still to remove
+        std::sort(pending_removals.begin(), pending_removals.end(), std::greater<int>());
+        for (int id : pending_removals)
         {
-            if (body.is_alive && body.type == ObjectType::ASTEROID_TYPE)
+            uint32_t slot = bodies.slot[id];
+            tier_counts[bodies.lod_tier[id]]--;
+            RemoveProxy(id);
+            bodies.RemoveSwapBack(id);
+            if (id < bodies.Size())
             {
-                CheckCollision(bullet, body);
+                slot_to_dense[bodies.slot[id]] = id;
             }
+            slot_to_dense[slot] = -1;
+            free_slots.push_back(slot);
+        }
+        pending_removals.clear();
+    }
+
+    // Pick the tier of a due body and catch it up with the time it skipped when needed.
+    // Near bodies are left to the kernels, the others are deferred until they are due again.
+    inline int UpdateSimulationTier(int id, float delta_time, Vector2 view_center)
+    {
+        const int previous_tier = bodies.lod_tier[id];
+        // Time this body has not been simulated for, up to the end of this tick
+        const float pending_time = previous_tier == SIM_TIER_NEAR ? delta_time : static_cast<float>(simulated_time - bodies.lod_time[id]);
+        // Deferred bodies have not moved for a while, estimate where they are by now
+        Vector2 position = GetFramePosition(id);
+        float dx = position.x + bodies.velocity_x[id] * pending_time - view_center.x;
+        float dy = position.y + bodies.velocity_y[id] * pending_time - view_center.y;
+        float distance_squared = dx * dx + dy * dy;
+        int tier = SIM_TIER_NEAR;
+        if (distance_squared > lod_mid_distance * lod_mid_distance)
+            tier = SIM_TIER_FAR;
+        else if (distance_squared > lod_near_distance * lod_near_distance)
+            tier = SIM_TIER_MID;
+
+        if (tier == SIM_TIER_NEAR)
+        {
+            // Back in range: catch up to the start of the tick, the kernels do this tick
+            if (previous_tier != SIM_TIER_NEAR)
+                AdvanceBody(id, pending_time - delta_time);
         }
+        else if (tier == SIM_TIER_MID)
+        {
+            AdvanceBody(id, pending_time);
+            bodies.lod_time[id] = simulated_time;
+        }
+        else if (previous_tier == SIM_TIER_NEAR)
+        {
+            // Leaving range: frozen at the start of this tick
+            bodies.lod_time[id] = simulated_time - delta_time;
+        }
+        bodies.SetFlag(id, BODY_LOD_DEFERRED, tier != SIM_TIER_NEAR);
+        bodies.lod_tier[id] = static_cast<uint8_t>(tier);
+        return tier;
     }
-    inline void CheckAstronomicalObjectCollisions(PhysicsBody& astronomical_object)
+    // Closed form of what the integration kernel does over time, with friction as an
+    // exponential decay so a long catch up stays stable
+    inline void AdvanceBody(int id, float time)
     {
-        if (astronomical_object.is_alive)
+        float velocity_x = bodies.velocity_x[id];
+        float velocity_y = bodies.velocity_y[id];
+        float length = sqrtf(velocity_x * velocity_x + velocity_y * velocity_y);
+        if (length > bodies.speed_limit[id])
+        {
+            float scale = length > 0.0f ? bodies.speed_limit[id] / length : 0.0f;
+            velocity_x *= scale;
+            velocity_y *= scale;
+        }
+        float deceleration = bodies.deceleration_multiplier[id];
+        float decay = expf(-deceleration * time);
+        // Distance covered per unit of initial speed
+        float travel = deceleration > 0.0f ? (1.0f - decay) / deceleration : time;
+        // The field where the body is now, held constant over the catch up. Its drag
+        // slows the motion on top of the friction.
+        ForceSample field;
+        if (!bodies.HasFlag(id, BODY_STATIC))
+            field = force_field.Sample({bodies.sector_x[id], bodies.sector_y[id]}, bodies.position_x[id] + bodies.center_x[id], bodies.position_y[id] + bodies.center_y[id]);
+        float damping = deceleration + field.drag;
+        float motion_decay = expf(-damping * time);
+        float motion_travel = damping > 0.0f ? (1.0f - motion_decay) / damping : time;
+        // Distance covered per unit of constant acceleration
+        float drift = damping > 0.0f ? (time - motion_travel) / damping : 0.5f * time * time;
+        bodies.position_x[id] += velocity_x * motion_travel + field.acceleration_x * drift;
+        bodies.position_y[id] += velocity_y * motion_travel + field.acceleration_y * drift;
+        bodies.velocity_x[id] = velocity_x * motion_decay + field.acceleration_x * motion_travel;
+        bodies.velocity_y[id] = velocity_y * motion_decay + field.acceleration_y * motion_travel;
+        bodies.CarrySector(id);
+        if (velocity_x == 0.0f && velocity_y == 0.0f)
+            bodies.SetFlag(id, BODY_ACCELERATING, false);
+
+        float limit = bodies.rotation_speed_limit[id];
+        float torque = Clamp(bodies.rotation_torque[id], -limit, limit);
+        if (bodies.HasFlag(id, BODY_APPLYING_TORQUE))
         {
-            if (physics_body_list[player_id].is_alive)
+            bodies.rotation[id] += torque * time;
+        }
+        else
+        {
+            bodies.rotation[id] += torque * travel;
+            torque *= decay;
+        }
+        bodies.rotation[id] = remainderf(bodies.rotation[id], 360.0f);
+        bodies.rotation_torque[id] = torque;
+        if (torque != 0.0f)
+            bodies.SetFlag(id, BODY_APPLYING_TORQUE, false);
+    }
+
+    inline void SetVelocity(int id, Vector2 velocity)
+    {
+        bodies.velocity_x[id] = velocity.x;
+        bodies.velocity_y[id] = velocity.y;
+        bodies.SetFlag(id, BODY_ACCELERATING, true);
+    }
+
+    // World bounds used by the broadphase, matching the shapes tested in Overlaps.
+    // Fast bodies cover their whole move of the tick.
+    inline Rectangle GetBounds(int id) const
+    {
+        Vector2 position = GetFramePosition(id);
+        Rectangle bounds = GetBoundsAt(id, position.x, position.y);
+        if (bodies.HasFlag(id, BODY_FAST))
+        {
+            Vector2 previous_position = GetPreviousFramePosition(id);
+            Rectangle start = GetBoundsAt(id, previous_position.x, previous_position.y);
+            float min_x = std::min(bounds.x, start.x);
+            float min_y = std::min(bounds.y, start.y);
+            float max_x = std::max(bounds.x + bounds.width, start.x + start.width);
+            float max_y = std::max(bounds.y + bounds.height, start.y + start.height);
+            bounds = {min_x, min_y, max_x - min_x, max_y - min_y};
+        }
+        return bounds;
+    }
+    inline Rectangle GetBoundsAt(int id, float position_x, float position_y) const
+    {
+        if (bodies.collision[id] == ObjectShape::Circle)
+        {
+            float radius = bodies.width[id] / 2;
+            float center_x = position_x + bodies.center_x[id];
+            float center_y = position_y + bodies.center_y[id];
+            return Rectangle({center_x - radius, center_y - radius, radius * 2, radius * 2});
+        }
+        if (bodies.polygon_index[id] >= 0)
+        {
+            // Circle holding the hull at any rotation, no need to transform the vertices
+            float radius = bodies.polygons[bodies.polygon_index[id]].radius;
+            float center_x = position_x + bodies.center_x[id];
+            float center_y = position_y + bodies.center_y[id];
+            return Rectangle({center_x - radius, center_y - radius, radius * 2, radius * 2});
+        }
+        return Rectangle({position_x, position_y, bodies.width[id], bodies.height[id]});
+    }
+    // Bodies simulated this tick with a mass become point masses of the tree
+    inline void BuildGravityTree()
+    {
+        gravity_tree.Clear();
+        const int count = bodies.Size();
+        for (int i = 0; i < count; i++)
+        {
+            if (IsGravitySource(i))
+                gravity_tree.AddBody(i, GetFramePosition(i).x + bodies.center_x[i], GetFramePosition(i).y + bodies.center_y[i], bodies.mass[i]);
+        }
+        gravity_tree.Build();
+    }
+    inline bool IsGravitySource(int id) const
+    {
+        return (bodies.flags[id] & (BODY_ALIVE | BODY_LOD_DEFERRED | BODY_STATIC)) == BODY_ALIVE && bodies.mass[id] > 0.0f &&
+               (gravity_type_mask & ObjectTypeBit(bodies.type[id]));
+    }
+    // Runs in the integration chunks, the tree only holds copies of the positions
+    inline void ApplyNBodyGravity(int begin, int end, float delta_time)
+    {
+        const float impulse_scale = gravity_constant * delta_time;
+        for (int i = begin; i < end; i++)
+        {
+            if (!IsGravitySource(i))
+                continue;
+            Vector2 center = GetCollisionCenter(i);
+            Vector2 acceleration = gravity_tree.GetAcceleration(center.x, center.y, i, gravity_theta, gravity_softening);
+            bodies.velocity_x[i] += acceleration.x * impulse_scale;
+            bodies.velocity_y[i] += acceleration.y * impulse_scale;
+        }
+    }
+    // Follow the bodies the sources are attached to and bake what they invalidated
+    inline void UpdateForceSources()
+    {
+        for (size_t i = 0; i < attached_sources.size();)
+        {
+            const AttachedForceSource &attached = attached_sources[i];
+            int id = GetDenseIndex(attached.body);
+            if (id < 0)
             {
-                CheckCollision(astronomical_object, physics_body_list[player_id]);
+                force_field.RemoveSource(attached.source);
+                attached_sources[i] = attached_sources.back();
+                attached_sources.pop_back();
+                continue;
             }
+            force_field.MoveSource(attached.source, {bodies.position_x[id] + attached.offset.x, bodies.position_y[id] + attached.offset.y}, {bodies.sector_x[id], bodies.sector_y[id]});
+            i++;
         }
+        force_field.Bake();
     }
-      inline virtual bool CheckCollision(PhysicsBody& source, PhysicsBody& dest)
+    // Runs in the integration chunks before the kernels, which add the sampled
+    // acceleration. Drag becomes an acceleration against the velocity.
+    inline void ApplyForceField(int begin, int end, float delta_time)
     {
-        if (!source.is_alive || dest.is_alive)
-            return false;
-        bool is_colliding = false;
-        Vector2 temp_position = source.position + source.center;
-        Vector2 other_position = dest.position + dest.center;
-        if (source.collision == ObjectShape::Circle)
+        ForceField::Cursor cursor;
+        // Drag never reverses the velocity within a tick
+        const float max_drag = 1.0f / delta_time;
+        for (int i = begin; i < end; i++)
         {
-            if (dest.collision == ObjectShape::Circle)
+            if ((bodies.flags[i] & (BODY_ALIVE | BODY_LOD_DEFERRED | BODY_STATIC)) != BODY_ALIVE)
             {
-                is_colliding = CheckCollisionCircles(temp_position, source.width / 2, other_position, dest.width / 2);
+                bodies.acceleration_x[i] = 0.0f;
+                bodies.acceleration_y[i] = 0.0f;
+                continue;
             }
-            else if (dest.collision == ObjectShape::Rectangle)
+            ForceSample sample = force_field.Sample({bodies.sector_x[i], bodies.sector_y[i]}, bodies.position_x[i] + bodies.center_x[i], bodies.position_y[i] + bodies.center_y[i], cursor);
+            float drag = std::min(sample.drag, max_drag);
+            bodies.acceleration_x[i] = sample.acceleration_x - bodies.velocity_x[i] * drag;
+            bodies.acceleration_y[i] = sample.acceleration_y - bodies.velocity_y[i] * drag;
+        }
+    }
+    inline DynamicAabbTree &GetTree(int id)
+    {
+        return bodies.HasFlag(id, BODY_STATIC) ? static_tree : dynamic_tree;
+    }
+    inline void RemoveProxy(int id)
+    {
+        if (bodies.proxy[id] < 0)
+            return;
+        GetTree(id).DestroyProxy(bodies.proxy[id]);
+        bodies.proxy[id] = -1;
+    }
+    // Insert new collidable bodies, drop the ones that stopped colliding and move the
+    // others. Most bodies are still inside their fat box and cost a single test.
+    inline void UpdateBroadphase()
+    {
+        const int count = bodies.Size();
+        for (int i = 0; i < count; i++)
+        {
+            if (!bodies.HasFlag(i, BODY_ALIVE) || !bodies.HasFlag(i, BODY_COLLISION_ENABLED))
             {
-                is_colliding = CheckCollisionCircleRec(temp_position, source.width / 2, Rectangle({dest.position.x, dest.position.y, dest.width, dest.height}));
+                RemoveProxy(i);
+                continue;
             }
+            Rectangle bounds = GetBounds(i);
+            Vector2 displacement = {bodies.position_x[i] - bodies.previous_position_x[i], bodies.position_y[i] - bodies.previous_position_y[i]};
+            if (bodies.proxy[i] < 0)
+                bodies.proxy[i] = GetTree(i).CreateProxy(bounds, static_cast<int>(bodies.slot[i]), displacement);
+            else
+                GetTree(i).MoveProxy(bodies.proxy[i], bounds, displacement);
+        }
+    }
+    // Call callback(dense id) for every body whose fat box overlaps the bounds of id.
+    // Static bodies only look for moving ones.
+    template <typename Callback>
+    inline void QueryBroadphase(int id, CollisionWorker &worker, Callback callback) const
+    {
+        const Rectangle bounds = GetBounds(id);
+        auto report = [&](int slot) { callback(slot_to_dense[slot]); };
+        dynamic_tree.Query(bounds, worker.query, report);
+        if (!bodies.HasFlag(id, BODY_STATIC))
+            static_tree.Query(bounds, worker.query, report);
+    }
+    // Only bodies whose boxes overlap in the broadphase trees are tested:
+    // bullet -> asteroid, asteroid -> player and asteroid <-> asteroid.
+    // Detection runs in parallel and only appends to per-thread contact buffers, the
+    // merged contacts are sorted and dispatched on this thread once detection is over,
+    // so game callbacks never run while the bodies are iterated and the result does not
+    // depend on the thread count.
+    inline void CheckCollisions()
+    {
+        collision_workers.resize(thread_pool.GetThreadCount());
+        for (CollisionWorker &worker : collision_workers)
+        {
+            worker.contacts.clear();
+            worker.candidate_pairs = 0;
         }
-        if (source.collision == ObjectShape::Rectangle)
+        thread_pool.ParallelFor(bodies.Size(), NARROWPHASE_CHUNK_SIZE, [&](int begin, int end, int worker_index)
         {
-            if (dest.collision == ObjectShape::Circle)
+            CollisionWorker &worker = collision_workers[worker_index];
+            for (int i = begin; i < end; i++)
             {
-                is_colliding = CheckCollisionCircleRec(temp_position, source.width / 2, Rectangle({dest.position.x, dest.position.y, dest.width, dest.height}));
+                if (!bodies.HasFlag(i, BODY_ALIVE) || !bodies.HasFlag(i, BODY_COLLISION_ENABLED))
+                    continue;
+                if (bodies.type[i] == ObjectType::BULLET_TYPE)
+                {
+                    FindBulletContacts(i, worker);
+                }
+                else if (bodies.type[i] == ObjectType::ASTEROID_TYPE)
+                {
+                    FindAstronomicalObjectContacts(i, worker);
+                }
             }
-            else if (dest.collision == ObjectShape::Rectangle)
+        });
+        contacts.clear();
+        candidate_pairs = 0;
+        for (CollisionWorker &worker : collision_workers)
+        {
+            contacts.insert(contacts.end(), worker.contacts.begin(), worker.contacts.end());
+            candidate_pairs += worker.candidate_pairs;
+        }
+        std::sort(contacts.begin(), contacts.end());
+        DispatchContacts();
+    }
+    inline void FindBulletContacts(int bullet_id, CollisionWorker &worker)
+    {
+        worker.narrowphase.Clear();
+        QueryBroadphase(bullet_id, worker, [&](int other_id)
+        {
+            if (bodies.type[other_id] != ObjectType::ASTEROID_TYPE)
+                return;
+            worker.candidate_pairs++;
+            worker.narrowphase.Add(bodies, other_id, GetFramePosition(other_id));
+        });
+        const std::vector<int> &hit_ids = FindOverlaps(bullet_id, worker.narrowphase);
+        for (size_t i = 0; i < hit_ids.size(); i++)
+        {
+            worker.contacts.push_back(MakeContact(bullet_id, hit_ids[i], false, worker.narrowphase.hit_times[i]));
+        }
+    }
+    inline void FindAstronomicalObjectContacts(int astronomical_object_id, CollisionWorker &worker)
+    {
+        worker.narrowphase.Clear();
+        QueryBroadphase(astronomical_object_id, worker, [&](int other_id)
+        {
+            ObjectType other_type = bodies.type[other_id];
+            // Each asteroid pair is visited once, from its lowest id
+            if (other_type == ObjectType::PLAYER_TYPE || (other_type == ObjectType::ASTEROID_TYPE && other_id > astronomical_object_id))
             {
-                is_colliding = CheckCollisionRecs(Rectangle({source.position.x, source.position.y, source.width, source.height}), Rectangle({dest.position.x, dest.position.y, dest.width, (float)dest.height}));
+                worker.candidate_pairs++;
+                worker.narrowphase.Add(bodies, other_id, GetFramePosition(other_id));
             }
+        });
+        const std::vector<int> &hit_ids = FindOverlaps(astronomical_object_id, worker.narrowphase);
+        for (size_t i = 0; i < hit_ids.size(); i++)
+        {
+            int other_id = hit_ids[i];
+            worker.contacts.push_back(MakeContact(astronomical_object_id, other_id, bodies.type[other_id] == ObjectType::ASTEROID_TYPE, worker.narrowphase.hit_times[i]));
+        }
+    }
+    inline PhysicsHandle GetHandle(int id) const
+    {
+        uint32_t slot = bodies.slot[id];
+        return {slot, slot_generations[slot]};
+    }
+    // time: fraction of the tick where source touched dest
+    inline PhysicsContact MakeContact(int source, int dest, bool is_mutual, float time) const
+    {
+        PhysicsContact contact;
+        contact.handle_a = GetHandle(source);
+        contact.handle_b = GetHandle(dest);
+        contact.type_a = bodies.type[source];
+        contact.type_b = bodies.type[dest];
+        contact.is_mutual = is_mutual;
+        ComputeContactPoint(source, dest, time, contact.point, contact.normal);
+        return contact;
+    }
+    // Closest point of source to dest and the direction from source to dest
+    inline void ComputeContactPoint(int source, int dest, float time, Vector2 &point, Vector2 &normal) const
+    {
+        Vector2 source_center = GetCenterAt(source, time);
+        Vector2 dest_center = GetCollisionCenter(dest);
+        if (bodies.collision[dest] == ObjectShape::Rectangle)
+        {
+            // Rectangles are tested from their top left corner
+            Vector2 dest_position = GetFramePosition(dest);
+            Rectangle rectangle = {dest_position.x, dest_position.y, bodies.width[dest], bodies.height[dest]};
+            dest_center = {Clamp(source_center.x, rectangle.x, rectangle.x + rectangle.width),
+                           Clamp(source_center.y, rectangle.y, rectangle.y + rectangle.height)};
         }
-        if (is_colliding){
-            if(auto shared_game_object = source.game_object.lock()){
-                shared_game_object->EnterCollision(dest.game_object.lock());
+        normal = Vector2Normalize(Vector2Subtract(dest_center, source_center));
+        if (normal.x == 0.0f && normal.y == 0.0f)
+            normal = {0.0f, -1.0f};
+        point = Vector2Add(source_center, Vector2Scale(normal, bodies.width[source] / 2));
+    }
+    inline void DispatchContacts()
+    {
+        const int count = static_cast<int>(contacts.size());
+        int group_begin = 0;
+        while (group_begin < count)
+        {
+            const ObjectType type_a = contacts[group_begin].type_a;
+            const ObjectType type_b = contacts[group_begin].type_b;
+            int group_end = group_begin + 1;
+            while (group_end < count && contacts[group_end].type_a == type_a && contacts[group_end].type_b == type_b)
+                group_end++;
+            const ContactHandler &handler = contact_handlers[static_cast<int>(type_a)][static_cast<int>(type_b)];
+            if (handler)
+            {
+                handler(contacts.data() + group_begin, group_end - group_begin);
+            }
+            else
+            {
+                for (int i = group_begin; i < group_end; i++)
+                {
+                    NotifyCollision(contacts[i]);
+                }
+            }
+            group_begin = group_end;
+        }
+    }
+    // Collision center of a body at a fraction of the last tick
+    inline Vector2 GetCenterAt(int id, float time) const
+    {
+        Vector2 start = GetPreviousFramePosition(id);
+        Vector2 end = GetFramePosition(id);
+        return Vector2Add(Vector2Lerp(start, end, time), {bodies.center_x[id], bodies.center_y[id]});
+    }
+    // Test the gathered candidates against source, circles run through the batched kernels
+    // and fast circles are swept over the tick
+    inline const std::vector<int> &FindOverlaps(int source, NarrowphaseBatch &narrowphase) const
+    {
+        if (bodies.collision[source] != ObjectShape::Circle)
+        {
+            for (int id : narrowphase.circle_ids)
+                if (Overlaps(source, id)) narrowphase.hit_ids.push_back(id);
+            for (int id : narrowphase.rect_ids)
+                if (Overlaps(source, id)) narrowphase.hit_ids.push_back(id);
+            for (int id : narrowphase.polygon_ids)
+                if (Overlaps(source, id)) narrowphase.hit_ids.push_back(id);
+            narrowphase.hit_times.assign(narrowphase.hit_ids.size(), 1.0f);
+            return narrowphase.hit_ids;
+        }
+        if (bodies.HasFlag(source, BODY_FAST))
+        {
+            return FindSweptOverlaps(source, narrowphase);
+        }
+        const Vector2 center = GetCollisionCenter(source);
+        const float x = center.x;
+        const float y = center.y;
+        float radius = bodies.width[source] / 2;
+        int circle_count = static_cast<int>(narrowphase.circle_ids.size());
+        int rect_count = static_cast<int>(narrowphase.rect_ids.size());
+        narrowphase.hits.resize(std::max(circle_count, rect_count));
+        kernels->circle_circle(x, y, radius, narrowphase.circle_x.data(), narrowphase.circle_y.data(), narrowphase.circle_radius.data(), circle_count, narrowphase.hits.data());
+        for (int i = 0; i < circle_count; i++)
+            if (narrowphase.hits[i]) narrowphase.hit_ids.push_back(narrowphase.circle_ids[i]);
+        kernels->circle_rect(x, y, radius, narrowphase.rect_x.data(), narrowphase.rect_y.data(), narrowphase.rect_width.data(), narrowphase.rect_height.data(), rect_count, narrowphase.hits.data());
+        for (int i = 0; i < rect_count; i++)
+            if (narrowphase.hits[i]) narrowphase.hit_ids.push_back(narrowphase.rect_ids[i]);
+        for (int id : narrowphase.polygon_ids)
+            if (Overlaps(source, id)) narrowphase.hit_ids.push_back(id);
+        narrowphase.hit_times.assign(narrowphase.hit_ids.size(), 1.0f);
+        return narrowphase.hit_ids;
+    }
+    // Time of impact of a fast circle moving from its previous to its current position
+    inline const std::vector<int> &FindSweptOverlaps(int source, NarrowphaseBatch &narrowphase) const
+    {
+        Vector2 start = GetCenterAt(source, 0.0f);
+        Vector2 end = GetCenterAt(source, 1.0f);
+        float radius = bodies.width[source] / 2;
+        float time = 0.0f;
+        for (size_t i = 0; i < narrowphase.circle_ids.size(); i++)
+        {
+            if (SweptCircleCircle(start, end, radius, {narrowphase.circle_x[i], narrowphase.circle_y[i]}, narrowphase.circle_radius[i], time))
+            {
+                narrowphase.hit_ids.push_back(narrowphase.circle_ids[i]);
+                narrowphase.hit_times.push_back(time);
+            }
+        }
+        for (size_t i = 0; i < narrowphase.rect_ids.size(); i++)
+        {
+            Rectangle rectangle = {narrowphase.rect_x[i], narrowphase.rect_y[i], narrowphase.rect_width[i], narrowphase.rect_height[i]};
+            if (SweptCircleRect(start, end, radius, rectangle, time))
+            {
+                narrowphase.hit_ids.push_back(narrowphase.rect_ids[i]);
+                narrowphase.hit_times.push_back(time);
+            }
+        }
+        for (int id : narrowphase.polygon_ids)
+        {
+            if (SweptCirclePolygon(start, end, radius, GetWorldPolygon(id), time))
+            {
+                narrowphase.hit_ids.push_back(id);
+                narrowphase.hit_times.push_back(time);
+            }
+        }
+        return narrowphase.hit_ids;
+    }
+    // Hull of a polygon body, or the box of a rectangle, placed in the world
+    inline WorldPolygon GetWorldPolygon(int id) const
+    {
+        if (bodies.polygon_index[id] < 0)
+            return WorldPolygon::FromRectangle(GetRectangle(id));
+        Vector2 origin = GetCollisionCenter(id);
+        return WorldPolygon::FromPolygon(bodies.polygons[bodies.polygon_index[id]], origin, bodies.rotation[id]);
+    }
+    // Any pair with a hull goes through the SAT tests
+    inline bool OverlapsPolygon(int source, int dest) const
+    {
+        int polygon_id = IsPolygonShape(bodies.collision[source]) ? source : dest;
+        int other_id = polygon_id == source ? dest : source;
+        if (bodies.collision[other_id] == ObjectShape::Circle)
+        {
+            Vector2 center = GetCollisionCenter(other_id);
+            return CheckCollisionPolygonCircle(GetWorldPolygon(polygon_id), center, bodies.width[other_id] / 2);
+        }
+        return CheckCollisionPolygons(GetWorldPolygon(polygon_id), GetWorldPolygon(other_id));
+    }
+    inline bool Overlaps(int source, int dest) const
+    {
+        if (IsPolygonShape(bodies.collision[source]) || IsPolygonShape(bodies.collision[dest]))
+            return OverlapsPolygon(source, dest);
+        bool is_colliding = false;
+        Vector2 source_position = GetFramePosition(source);
+        Vector2 dest_position = GetFramePosition(dest);
+        Vector2 temp_position = source_position + Vector2({bodies.center_x[source], bodies.center_y[source]});
+        Vector2 other_position = dest_position + Vector2({bodies.center_x[dest], bodies.center_y[dest]});
+        Rectangle dest_rectangle = Rectangle({dest_position.x, dest_position.y, bodies.width[dest], bodies.height[dest]});
+        if (bodies.collision[source] == ObjectShape::Circle)
+        {
+            if (bodies.collision[dest] == ObjectShape::Circle)
+            {
+                is_colliding = CheckCollisionCircles(temp_position, bodies.width[source] / 2, other_position, bodies.width[dest] / 2);
+            }
+            else if (bodies.collision[dest] == ObjectShape::Rectangle)
+            {
+                is_colliding = CheckCollisionCircleRec(temp_position, bodies.width[source] / 2, dest_rectangle);
+            }
+        }
+        if (bodies.collision[source] == ObjectShape::Rectangle)
+        {
+            if (bodies.collision[dest] == ObjectShape::Circle)
+            {
+                is_colliding = CheckCollisionCircleRec(temp_position, bodies.width[source] / 2, dest_rectangle);
+            }
+            else if (bodies.collision[dest] == ObjectShape::Rectangle)
+            {
+                is_colliding = CheckCollisionRecs(Rectangle({source_position.x, source_position.y, bodies.width[source], bodies.height[source]}), dest_rectangle);
             }
         }
         return is_colliding;
     }
+    inline bool PassesFilter(int id, const QueryFilter &filter) const
+    {
+        return bodies.HasFlag(id, BODY_ALIVE) && (filter.type_mask & ObjectTypeBit(bodies.type[id])) &&
+               (filter.layer_mask & bodies.layer[id]) && GetHandle(id) != filter.ignore;
+    }
+    // Position of a body relative to the corner of the frame sector
+    inline Vector2 GetFramePosition(int id) const
+    {
+        Vector2 offset = WorldSector{bodies.sector_x[id], bodies.sector_y[id]}.OffsetFrom(frame_sector);
+        return {offset.x + bodies.position_x[id], offset.y + bodies.position_y[id]};
+    }
+    inline Vector2 GetPreviousFramePosition(int id) const
+    {
+        Vector2 offset = WorldSector{bodies.sector_x[id], bodies.sector_y[id]}.OffsetFrom(frame_sector);
+        return {offset.x + bodies.previous_position_x[id], offset.y + bodies.previous_position_y[id]};
+    }
+    inline Vector2 GetCollisionCenter(int id) const
+    {
+        Vector2 position = GetFramePosition(id);
+        return {position.x + bodies.center_x[id], position.y + bodies.center_y[id]};
+    }
+    inline Rectangle GetRectangle(int id) const
+    {
+        Vector2 position = GetFramePosition(id);
+        return {position.x, position.y, bodies.width[id], bodies.height[id]};
+    }
+    // A ray is a swept circle of radius 0
+    inline bool RaycastBody(int id, Vector2 start, Vector2 end, float &time, Vector2 &normal) const
+    {
+        if (bodies.collision[id] == ObjectShape::Circle)
+        {
+            Vector2 center = GetCollisionCenter(id);
+            if (!SweptCircleCircle(start, end, 0.0f, center, bodies.width[id] / 2, time))
+                return false;
+            normal = Vector2Normalize(Vector2Subtract(Vector2Lerp(start, end, time), center));
+            if (normal.x == 0.0f && normal.y == 0.0f)
+                normal = Vector2Normalize(Vector2Subtract(start, end));
+            return true;
+        }
+        WorldPolygon polygon = GetWorldPolygon(id);
+        if (!SweptCirclePolygon(start, end, 0.0f, polygon, time))
+            return false;
+        // The hit point lies on the edge it is the farthest out of
+        Vector2 point = Vector2Lerp(start, end, time);
+        float farthest = -INFINITY;
+        for (int i = 0; i < polygon.count; i++)
+        {
+            float distance = Vector2DotProduct(Vector2Subtract(point, polygon.vertices[i]), polygon.normals[i]);
+            if (distance > farthest)
+            {
+                farthest = distance;
+                normal = polygon.normals[i];
+            }
+        }
+        return true;
+    }
+    inline bool OverlapsCircle(int id, Vector2 center, float radius) const
+    {
+        if (bodies.collision[id] == ObjectShape::Circle)
+            return CheckCollisionCircles(GetCollisionCenter(id), bodies.width[id] / 2, center, radius);
+        if (bodies.collision[id] == ObjectShape::Rectangle)
+            return CheckCollisionCircleRec(center, radius, GetRectangle(id));
+        return CheckCollisionPolygonCircle(GetWorldPolygon(id), center, radius);
+    }
+    inline bool OverlapsRectangle(int id, Rectangle rectangle) const
+    {
+        if (bodies.collision[id] == ObjectShape::Circle)
+            return CheckCollisionCircleRec(GetCollisionCenter(id), bodies.width[id] / 2, rectangle);
+        if (bodies.collision[id] == ObjectShape::Rectangle)
+            return CheckCollisionRecs(GetRectangle(id), rectangle);
+        return CheckCollisionPolygons(GetWorldPolygon(id), WorldPolygon::FromRectangle(rectangle));
+    }
 };
 
 #endif // PHYSICS_SYSTEM_H
@@ -0,0 +1,152 @@
+#ifndef PHYSICS_THREAD_POOL_H
+#define PHYSICS_THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Persistent worker threads used by the PhysicsSystem to split a tick phase in chunks.
+// The calling thread works as worker 0, so a pool of one thread runs everything inline.
+// Chunks are handed out dynamically: results must not depend on which worker ran a chunk.
+class PhysicsThreadPool
+{
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_ready;
+    std::condition_variable work_done;
+    // Job of the current ParallelFor, a plain function and its context so handing out
+    // work never allocates
+    void (*job)(void *context, int worker) = nullptr;
+    void *job_context = nullptr;
+    unsigned int job_generation = 0;
+    int busy_workers = 0;
+    bool is_stopping = false;
+
+    void WorkerLoop(int worker, unsigned int seen_generation)
+    {
+        while (true)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            work_ready.wait(lock, [&] { return is_stopping || job_generation != seen_generation; });
+            if (is_stopping)
+                return;
+            seen_generation = job_generation;
+            void (*run)(void *, int) = job;
+            void *context = job_context;
+            lock.unlock();
+            run(context, worker);
+            lock.lock();
+            if (--busy_workers == 0)
+                work_done.notify_one();
+        }
+    }
+
+    void Stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            is_stopping = true;
+        }
+        work_ready.notify_all();
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+        workers.clear();
+        is_stopping = false;
+    }
+
+public:
+    static constexpr int MAX_THREADS = 64;
+
+    PhysicsThreadPool(int thread_count = 1)
+    {
+        SetThreadCount(thread_count);
+    }
+    ~PhysicsThreadPool()
+    {
+        Stop();
+    }
+
+    PhysicsThreadPool(const PhysicsThreadPool &) = delete;
+    PhysicsThreadPool &operator=(const PhysicsThreadPool &) = delete;
+
+    // Threads available to the current platform, the web build runs single threaded
+    static int GetHardwareThreadCount()
+    {
+#ifdef __EMSCRIPTEN__
+        return 1;
+#else
+        return std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+#endif
+    }
+
+    // Total threads including the caller
+    void SetThreadCount(int thread_count)
+    {
+#ifdef __EMSCRIPTEN__
+        thread_count = 1;
+#endif
+        thread_count = std::clamp(thread_count, 1, MAX_THREADS);
+        if (thread_count == GetThreadCount())
+            return;
+        Stop();
+        for (int worker = 1; worker < thread_count; worker++)
+        {
+            // Start at the current job so a new worker never runs an old one
+            workers.emplace_back(&PhysicsThreadPool::WorkerLoop, this, worker, job_generation);
+        }
+    }
+    int GetThreadCount() const
+    {
+        return static_cast<int>(workers.size()) + 1;
+    }
+
+    // Call fn(begin, end, worker) over [0, count) in chunks of chunk_size and return
+    // once every chunk is done. Work smaller than one chunk stays on the caller.
+    template <typename Fn>
+    void ParallelFor(int count, int chunk_size, Fn fn)
+    {
+        if (count <= 0)
+            return;
+        if (workers.empty() || count <= chunk_size)
+        {
+            fn(0, count, 0);
+            return;
+        }
+        std::atomic<int> next_chunk{0};
+        auto run_chunks = [&](int worker)
+        {
+            while (true)
+            {
+                int begin = next_chunk.fetch_add(chunk_size, std::memory_order_relaxed);
+                if (begin >= count)
+                    return;
+                fn(begin, std::min(begin + chunk_size, count), worker);
+            }
+        };
+        using RunChunks = decltype(run_chunks);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [](void *context, int worker)
+            {
+                (*static_cast<RunChunks *>(context))(worker);
+            };
+            job_context = &run_chunks;
+            busy_workers = static_cast<int>(workers.size());
+            job_generation++;
+        }
+        work_ready.notify_all();
+        run_chunks(0);
+        std::unique_lock<std::mutex> lock(mutex);
+        work_done.wait(lock, [&] { return busy_workers == 0; });
+        job = nullptr;
+        job_context = nullptr;
+    }
+};
+
+#endif // PHYSICS_THREAD_POOL_H
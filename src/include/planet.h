@@ -3,6 +3,9 @@
 
 #include "raylib.h"
 #include "dynamic_body.h"
+#include "physics_system.h"
+#include "sprite_batch.h"
+#include "async_logger.h"
 #include <vector>
 
 class Planet : public DynamicBody
@@ -14,18 +17,31 @@ public:
     float temperature = 0.0f;
     float damage = 0.0f;
     bool is_alive = true;
-    Texture2D planet_texture;
+    SpriteHandle planet_sprite;
+    // Id of the gravity well in the force field, follows the physics body
+    int force_source = -1;
+    // Distance at which the pull of the well has faded out
+    static constexpr float WELL_REACH = 1024.0f;
 
-    static std::shared_ptr<Planet> Create(Vector2 in_position){
+    static std::shared_ptr<Planet> Create(Vector2 in_position, WorldSector in_sector = WorldSector()){
         std::shared_ptr<Planet> obj = std::make_shared<Planet>(in_position);
+        obj->sector = in_sector;
         obj->object_type = ObjectType::ASTEROID_TYPE;
+        // Never moves, lives in the static broadphase tree
+        obj->is_static = true;
         obj->physics_id = PhysicsObject::CreatePhysicsId(obj);
-        TraceLog(LOG_INFO, "Object of type Planet created");
+        // Pulls through a well baked in the force field, around the middle of the texture
+        Vector2 well_center = {in_position.x + obj->width / 2.0f, in_position.y + obj->height / 2.0f};
+        ForceSource well = ForceSource::Well(well_center, obj->mass, obj->width / 2.0f, WELL_REACH);
+        well.sector = in_sector;
+        obj->force_source = PhysicsSystem::GetInstance().AddForceSource(well, obj->physics_id);
+        GAME_LOG(LOG_DEBUG, "Object of type Planet created");
         return obj;
     }
     
-    Planet(Vector2 in_position){
-        position = in_position;
+    // Pixel art of the planet, generated once by the SpriteRegistry
+    static Image GeneratePlanetImage()
+    {
         // Planet 1 Data (Simple Ringed)
         std::vector<std::vector<Color>> planet1 = {
             {BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK, BLANK},
@@ -54,36 +70,27 @@ public:
             }
         }
         ImageResizeNN(&planet1_image, 128, 128);
-        if (IsWindowReady()){
-            // Generate a Texture2D from the color data
-            planet_texture = LoadTextureFromImage(planet1_image);
-        }else{
-            planet_texture = {0};
-        }
+        return planet1_image;
+    }
 
-        // Unload the image from memory
-        UnloadImage(planet1_image);
+    Planet(Vector2 in_position){
+        position = in_position;
+        planet_sprite = SpriteRegistry::GetInstance().GetOrCreate("planet", 1, GeneratePlanetImage);
         height = 128;
         width = 128;
+        // Heavy enough to bend the paths of asteroids and the player passing by
+        mass = 50000.0f;
     }
     ~Planet()
     {
-        if (IsWindowReady() == false)
-            return;
-        if (planet_texture.id > 0)
-        {
-            UnloadTexture(planet_texture);
-        }
-        TraceLog(LOG_INFO, "Planet destroyed");
+        GAME_LOG(LOG_DEBUG, "Planet destroyed");
     }
-    void Render() override
+    // Queue the planet sprite, snapped to whole pixels
+    void Render(SpriteBatch &batch)
     {
-        if (!IsWindowReady())
-            return;
         if (!is_alive)
             return;
-        // Draw the planet texture
-        DrawTexture(planet_texture, position.x, position.y, WHITE);
+        batch.Submit(planet_sprite, {static_cast<float>(static_cast<int>(position.x)), static_cast<float>(static_cast<int>(position.y))}, {0.0f, 0.0f}, 0.0f, WHITE, RENDER_LAYER_PLANET);
     }
 };
 
@@ -3,10 +3,24 @@
 
 #include "raylib.h"
 #include "dynamic_body.h"
-#include "bullet.h"
+#include "bullet_pool.h"
+#include "sprite_batch.h"
+#include "physics_query.h"
+#include "async_logger.h"
 #include <vector>
 #include <memory>
 
+// Where the gun of the player points, copied out so it can be drawn away from the Player
+struct GunSight
+{
+    Vector2 position = {0.0f, 0.0f};
+    Vector2 direction = {0.0f, 0.0f};
+    float range = 0.0f;
+    // First asteroid along the line, when is_on_target
+    Vector2 target = {0.0f, 0.0f};
+    bool is_on_target = false;
+};
+
 // Player will control a spaceship
 class Player : public DynamicBody
 {
@@ -21,7 +35,7 @@ public:
     float energy = 100.0f;
     float max_energy = 100.0f;
 
-    Texture2D spaceship;
+    SpriteHandle spaceship;
     // Origin
     Vector2 origin;
     bool is_rotating = false;
@@ -41,29 +55,33 @@ public:
     Vector2 gun_position = {0, 0};
     bool is_shooting = false;
     bool is_gun_ready = true;
-    std::vector<std::weak_ptr<Bullet>> bullets;
+    // First asteroid along the gun line within gun_range, refreshed every frame
+    RaycastHit gun_target;
+    bool is_gun_on_target = false;
+    // Bullets fired from the pool and still in flight, as indices into it
+    BulletPool *bullet_pool = nullptr;
+    std::vector<int> bullets;
 public:
-    static std::shared_ptr<Player> Create(){
+    static std::shared_ptr<Player> Create(BulletPool *in_bullet_pool = nullptr){
         std::shared_ptr<Player> obj = std::make_shared<Player>();
+        obj->bullet_pool = in_bullet_pool;
+        obj->bullets.reserve(BulletPool::CAPACITY);
         obj->physics_id = PhysicsObject::CreatePhysicsId(obj);
-        TraceLog(LOG_INFO, "Object of type Player created");
+        GAME_LOG(LOG_DEBUG, "Object of type Player created");
         return obj;
     }
     Player();
+    static Image GenerateSpaceshipImage();
     ~Player()
     {
-        if (IsWindowReady() == false)
-            return;
-        if (spaceship.id > 0)
-        {
-            UnloadTexture(spaceship);
-        }
         bullets.clear();
-        TraceLog(LOG_INFO, "Player destroyed");
+        GAME_LOG(LOG_DEBUG, "Player destroyed");
     }
     void Update(float delta_time) override;
     void FixUpdate(float delta_time) override;
-    void Render() override;
+    GunSight GetGunSight() const;
+    // Gun sight drawn over the sprites, the ship itself comes from the RenderSnapshot
+    static void RenderGunSight(const GunSight &sight);
 
     void TurnLeft();
     void TurnRight();
@@ -71,6 +89,7 @@ public:
     void Decelerate();
 
     void Shoot();
+    void UpdateGunSight();
     void TakeDamage(float damage, Vector2 point) override;
 
     float GetRotation() const { return rotation; }
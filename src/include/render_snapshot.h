@@ -0,0 +1,131 @@
+#ifndef RENDER_SNAPSHOT_H
+#define RENDER_SNAPSHOT_H
+
+#include "raylib.h"
+#include "raymath.h"
+#include <cstdint>
+#include <vector>
+#include "physics_handle.h"
+#include "world_position.h"
+#include "sprite_batch.h"
+
+// Rotation blended from one tick to the next along the shortest arc, rotations wrap at +-180
+inline float LerpRotation(float from, float to, float alpha)
+{
+    float delta = to - from;
+    if (delta > 180.0f)
+        delta -= 360.0f;
+    else if (delta < -180.0f)
+        delta += 360.0f;
+    return from + delta * alpha;
+}
+
+// What a body looks like, given when it is created. Bodies without a sprite are
+// simulated but never published.
+struct BodySprite
+{
+    SpriteHandle sprite;
+    // Rotation pivot from the top left corner of the sprite
+    Vector2 origin = {0.0f, 0.0f};
+    Color tint = WHITE;
+    int layer = 0;
+};
+
+// Render state of a body at the end of a tick: the two transforms to blend between and
+// the sprite to draw. Plain data, nothing points back into the PhysicsSystem.
+struct RenderProxy
+{
+    PhysicsHandle handle;
+    WorldSector sector;
+    Vector2 previous_position = {0.0f, 0.0f};
+    Vector2 position = {0.0f, 0.0f};
+    float previous_rotation = 0.0f;
+    float rotation = 0.0f;
+    BodySprite sprite;
+    bool is_on_screen = false;
+    bool is_accelerating = false;
+    bool is_rotating_left = false;
+    bool is_rotating_right = false;
+
+    // Position between the last two ticks, alpha 0 is the previous one, relative to camera_sector
+    inline Vector2 GetPosition(float alpha, WorldSector camera_sector) const
+    {
+        return WorldPosition{sector, Vector2Lerp(previous_position, position, alpha)}.RelativeTo(camera_sector);
+    }
+    inline float GetRotation(float alpha) const
+    {
+        return LerpRotation(previous_rotation, rotation, alpha);
+    }
+};
+
+// Every body with a sprite as the PhysicsSystem left it after its last tick, packed one
+// after the other. The renderer reads it instead of copying bodies into game objects:
+// one pass over contiguous proxies straight into the SpriteBatch.
+class RenderSnapshot
+{
+private:
+    std::vector<RenderProxy> proxies;
+    // Proxy of each handle slot, -1 when the slot has none
+    std::vector<int32_t> slot_to_proxy;
+    // PhysicsSystem tick the proxies are from
+    uint64_t tick = 0;
+
+public:
+    // Start over for the given tick, the storage is kept
+    inline void Begin(uint64_t in_tick)
+    {
+        Clear();
+        tick = in_tick;
+    }
+    inline void Add(const RenderProxy &proxy)
+    {
+        if (proxy.handle.index >= slot_to_proxy.size())
+            slot_to_proxy.resize(proxy.handle.index + 1, -1);
+        slot_to_proxy[proxy.handle.index] = static_cast<int32_t>(proxies.size());
+        proxies.push_back(proxy);
+    }
+    inline void Clear()
+    {
+        for (const RenderProxy &proxy : proxies)
+        {
+            slot_to_proxy[proxy.handle.index] = -1;
+        }
+        proxies.clear();
+        tick = 0;
+    }
+
+    // Proxy of the body, nullptr when it was not published or the handle is stale
+    inline const RenderProxy *Find(PhysicsHandle handle) const
+    {
+        if (!handle.IsValid() || handle.index >= slot_to_proxy.size() || slot_to_proxy[handle.index] < 0)
+            return nullptr;
+        const RenderProxy &proxy = proxies[slot_to_proxy[handle.index]];
+        return proxy.handle == handle ? &proxy : nullptr;
+    }
+
+    // Queue the proxies on screen, blended by alpha and relative to the sector of the camera
+    inline void Render(float alpha, WorldSector camera_sector, SpriteBatch &batch) const
+    {
+        for (const RenderProxy &proxy : proxies)
+        {
+            if (!proxy.is_on_screen)
+                continue;
+            batch.Submit(proxy.sprite.sprite, proxy.GetPosition(alpha, camera_sector), proxy.sprite.origin, proxy.GetRotation(alpha), proxy.sprite.tint, proxy.sprite.layer);
+        }
+    }
+
+    inline const std::vector<RenderProxy> &GetProxies() const
+    {
+        return proxies;
+    }
+    inline int GetCount() const
+    {
+        return static_cast<int>(proxies.size());
+    }
+    inline uint64_t GetTick() const
+    {
+        return tick;
+    }
+};
+
+#endif // RENDER_SNAPSHOT_H
@@ -0,0 +1,202 @@
+#ifndef SIMULATION_THREAD_H
+#define SIMULATION_THREAD_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include "fixed_timestep.h"
+
+// Bounded lock-free queue from one producer thread to one consumer thread. Pushing to a
+// full queue drops the item and counts it, neither side ever waits.
+template <typename T, uint32_t CAPACITY>
+class SpscQueue
+{
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+private:
+    T items[CAPACITY];
+    // Written by the consumer
+    alignas(64) std::atomic<uint32_t> head{0};
+    // Written by the producer
+    alignas(64) std::atomic<uint32_t> tail{0};
+    uint32_t dropped = 0;
+
+public:
+    // Producer side
+    inline bool Push(const T &item)
+    {
+        const uint32_t position = tail.load(std::memory_order_relaxed);
+        if (position - head.load(std::memory_order_acquire) == CAPACITY)
+        {
+            dropped++;
+            return false;
+        }
+        items[position & (CAPACITY - 1)] = item;
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer side
+    inline bool Pop(T &item)
+    {
+        const uint32_t position = head.load(std::memory_order_relaxed);
+        if (position == tail.load(std::memory_order_acquire))
+            return false;
+        item = items[position & (CAPACITY - 1)];
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+    // Consumer side: call f(item) on what is queued, oldest first, returns how many
+    template <typename F>
+    inline int Drain(F &&f)
+    {
+        int count = 0;
+        T item;
+        while (Pop(item))
+        {
+            f(static_cast<const T &>(item));
+            count++;
+        }
+        return count;
+    }
+
+    // Producer side, pushes that found the queue full
+    inline uint32_t GetDroppedCount() const
+    {
+        return dropped;
+    }
+    static constexpr uint32_t GetCapacity()
+    {
+        return CAPACITY;
+    }
+};
+
+// Hand-off of whole states from one writer thread to one reader thread. The writer fills
+// the back buffer and publishes it, the reader takes the last published one. Three
+// buffers mean neither waits: the one in the middle is swapped atomically.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static constexpr uint8_t INDEX_MASK = 3;
+    // Set on the middle index while it holds a state the reader has not taken
+    static constexpr uint8_t NEW_BIT = 4;
+
+    T buffers[3];
+    alignas(64) std::atomic<uint8_t> middle{1};
+    // Only touched by the writer
+    alignas(64) uint8_t back = 0;
+    // Only touched by the reader
+    alignas(64) uint8_t front = 2;
+
+public:
+    // Writer side: the buffer to fill, kept from three publishes ago so storage is reused
+    inline T &GetWriteBuffer()
+    {
+        return buffers[back];
+    }
+    // Writer side: hand the filled buffer over, replacing one the reader did not take
+    inline void Publish()
+    {
+        back = middle.exchange(back | NEW_BIT, std::memory_order_acq_rel) & INDEX_MASK;
+    }
+    // Reader side: the last published buffer, valid until the next Read
+    inline const T &Read()
+    {
+        if (middle.load(std::memory_order_relaxed) & NEW_BIT)
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX_MASK;
+        return buffers[front];
+    }
+    inline bool HasNew() const
+    {
+        return (middle.load(std::memory_order_relaxed) & NEW_BIT) != 0;
+    }
+};
+
+// Runs a step function on its own thread at the fixed rate of a FixedTimestep, sleeping
+// until the next step is due. The step returns false to stop the thread.
+class SimulationThread
+{
+public:
+    using StepFunction = bool (*)(void *context, float step);
+
+private:
+    std::thread thread;
+    std::atomic<bool> is_running{false};
+    std::atomic<int> step_count{0};
+
+    void Loop(FixedTimestep timestep, StepFunction step_function, void *context)
+    {
+        auto last = std::chrono::steady_clock::now();
+        while (is_running.load(std::memory_order_acquire))
+        {
+            const auto now = std::chrono::steady_clock::now();
+            const int steps = timestep.Advance(std::chrono::duration<float>(now - last).count());
+            last = now;
+            for (int i = 0; i < steps; i++)
+            {
+                const bool is_alive = step_function(context, timestep.GetStep());
+                step_count.fetch_add(1, std::memory_order_relaxed);
+                if (!is_alive)
+                {
+                    is_running.store(false, std::memory_order_release);
+                    return;
+                }
+            }
+            std::this_thread::sleep_for(std::chrono::duration<float>(timestep.GetStep() * (1.0f - timestep.GetAlpha())));
+        }
+    }
+
+public:
+    SimulationThread() = default;
+    ~SimulationThread()
+    {
+        Stop();
+    }
+    SimulationThread(const SimulationThread &) = delete;
+    SimulationThread &operator=(const SimulationThread &) = delete;
+
+    // False when threads are not available (web build), the caller keeps stepping itself
+    inline bool Start(FixedTimestep timestep, StepFunction step_function, void *context)
+    {
+#ifdef __EMSCRIPTEN__
+        return false;
+#else
+        if (thread.joinable())
+            return false;
+        step_count.store(0, std::memory_order_relaxed);
+        is_running.store(true, std::memory_order_release);
+        thread = std::thread(&SimulationThread::Loop, this, timestep, step_function, context);
+        return true;
+#endif
+    }
+    // Wait for the step in progress and join the thread
+    inline void Stop()
+    {
+        is_running.store(false, std::memory_order_release);
+        if (thread.joinable())
+            thread.join();
+    }
+
+    // Started and not joined yet, even if the step function stopped it
+    inline bool IsStarted() const
+    {
+        return thread.joinable();
+    }
+    inline bool IsRunning() const
+    {
+        return is_running.load(std::memory_order_acquire);
+    }
+    inline int GetStepCount() const
+    {
+        return step_count.load(std::memory_order_relaxed);
+    }
+
+    // Steady clock in seconds, shared by both threads to place a state in time
+    static inline double Now()
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+#endif // SIMULATION_THREAD_H
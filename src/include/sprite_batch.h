@@ -0,0 +1,192 @@
+#ifndef SPRITE_BATCH_H
+#define SPRITE_BATCH_H
+
+#include "raylib.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "sprite_registry.h"
+#include "frame_arena.h"
+
+// Draw order of the sprites, lower layers are drawn first
+enum RenderLayer
+{
+    RENDER_LAYER_PLANET,
+    RENDER_LAYER_ASTEROID,
+    RENDER_LAYER_BULLET,
+    RENDER_LAYER_PLAYER
+};
+
+// One sprite to draw this frame, at its own size and rotated around origin
+struct SpriteInstance
+{
+    Rectangle source = {0.0f, 0.0f, 0.0f, 0.0f};
+    Vector2 position = {0.0f, 0.0f};
+    Vector2 origin = {0.0f, 0.0f};
+    float rotation = 0.0f;
+    Color tint = WHITE;
+    int layer = 0;
+    unsigned int texture = 0;
+};
+
+// Render queue of the frame. Sprites are collected from the systems, sorted by layer
+// then texture and submitted as quads straight to the rlgl batch: one texture bind per
+// run of the same texture instead of one DrawTexturePro per object. Every sprite of
+// the SpriteRegistry shares its atlas, so a frame costs a single bind.
+class SpriteBatch
+{
+public:
+    // Quads pushed between two checks of the rlgl batch capacity
+    static constexpr int QUADS_PER_CHUNK = 1024;
+
+private:
+    struct SortKey
+    {
+        uint64_t key;
+        uint32_t index;
+
+        inline bool operator<(const SortKey &other) const
+        {
+            return key != other.key ? key < other.key : index < other.index;
+        }
+    };
+
+    std::vector<SpriteInstance> instances;
+    // Sorted order of the instances, in the frame arena
+    SortKey *order = nullptr;
+    size_t order_count = 0;
+    int draw_count = 0;
+    int instance_count = 0;
+
+    static inline uint64_t MakeSortKey(const SpriteInstance &instance)
+    {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(instance.layer)) << 32) | instance.texture;
+    }
+
+    static inline void PushQuad(const SpriteInstance &instance, float atlas_width, float atlas_height)
+    {
+        const float radians = instance.rotation * DEG2RAD;
+        const float sin_rotation = sinf(radians);
+        const float cos_rotation = cosf(radians);
+        const float left = -instance.origin.x;
+        const float top = -instance.origin.y;
+        const float right = left + instance.source.width;
+        const float bottom = top + instance.source.height;
+        const Vector2 top_left = {instance.position.x + left * cos_rotation - top * sin_rotation, instance.position.y + left * sin_rotation + top * cos_rotation};
+        const Vector2 top_right = {instance.position.x + right * cos_rotation - top * sin_rotation, instance.position.y + right * sin_rotation + top * cos_rotation};
+        const Vector2 bottom_left = {instance.position.x + left * cos_rotation - bottom * sin_rotation, instance.position.y + left * sin_rotation + bottom * cos_rotation};
+        const Vector2 bottom_right = {instance.position.x + right * cos_rotation - bottom * sin_rotation, instance.position.y + right * sin_rotation + bottom * cos_rotation};
+        const float u0 = instance.source.x / atlas_width;
+        const float v0 = instance.source.y / atlas_height;
+        const float u1 = (instance.source.x + instance.source.width) / atlas_width;
+        const float v1 = (instance.source.y + instance.source.height) / atlas_height;
+        // Same winding as DrawTexturePro
+        rlColor4ub(instance.tint.r, instance.tint.g, instance.tint.b, instance.tint.a);
+        rlTexCoord2f(u0, v0);
+        rlVertex2f(top_left.x, top_left.y);
+        rlTexCoord2f(u0, v1);
+        rlVertex2f(bottom_left.x, bottom_left.y);
+        rlTexCoord2f(u1, v1);
+        rlVertex2f(bottom_right.x, bottom_right.y);
+        rlTexCoord2f(u1, v0);
+        rlVertex2f(top_right.x, top_right.y);
+    }
+
+public:
+    SpriteBatch()
+    {
+        instances.reserve(1024);
+    }
+
+    // Queue a sprite of the SpriteRegistry
+    inline void Submit(SpriteHandle sprite, Vector2 position, Vector2 origin, float rotation, Color tint, int layer)
+    {
+        if (!sprite.IsValid())
+            return;
+        SpriteRegistry &registry = SpriteRegistry::GetInstance();
+        SpriteInstance instance;
+        instance.source = registry.GetSource(sprite);
+        instance.position = position;
+        instance.origin = origin;
+        instance.rotation = rotation;
+        instance.tint = tint;
+        instance.layer = layer;
+        instance.texture = registry.GetAtlas().id;
+        instances.push_back(instance);
+    }
+
+    // Order of the queued sprites, by layer then texture, first queued first within both.
+    // Valid until the frame arena is reset.
+    inline void Sort()
+    {
+        order_count = instances.size();
+        order = FrameArenas::GetInstance().Get().Allocate<SortKey>(order_count);
+        for (size_t i = 0; i < order_count; i++)
+        {
+            order[i] = {MakeSortKey(instances[i]), static_cast<uint32_t>(i)};
+        }
+        std::sort(order, order + order_count);
+    }
+
+    // Draw every queued sprite and empty the queue, inside BeginMode2D
+    inline void Flush()
+    {
+        Sort();
+        const float atlas_width = static_cast<float>(SpriteRegistry::ATLAS_WIDTH);
+        const float atlas_height = static_cast<float>(std::max(SpriteRegistry::GetInstance().GetAtlasHeight(), 1));
+        draw_count = 0;
+        instance_count = static_cast<int>(instances.size());
+        size_t run_start = 0;
+        while (run_start < order_count)
+        {
+            const unsigned int texture = instances[order[run_start].index].texture;
+            size_t run_end = run_start;
+            while (run_end < order_count && instances[order[run_end].index].texture == texture)
+                run_end++;
+            // Layers sharing the texture stay in the same draw call
+            rlSetTexture(texture);
+            for (size_t chunk = run_start; chunk < run_end; chunk += QUADS_PER_CHUNK)
+            {
+                const size_t chunk_end = std::min(run_end, chunk + QUADS_PER_CHUNK);
+                rlCheckRenderBatchLimit(static_cast<int>(chunk_end - chunk) * 4);
+                rlBegin(RL_QUADS);
+                rlNormal3f(0.0f, 0.0f, 1.0f);
+                for (size_t i = chunk; i < chunk_end; i++)
+                {
+                    PushQuad(instances[order[i].index], atlas_width, atlas_height);
+                }
+                rlEnd();
+            }
+            draw_count++;
+            run_start = run_end;
+        }
+        rlSetTexture(0);
+        instances.clear();
+        order = nullptr;
+        order_count = 0;
+    }
+
+    inline const std::vector<SpriteInstance> &GetInstances() const
+    {
+        return instances;
+    }
+    // Queued sprite at place i once sorted
+    inline const SpriteInstance &GetSorted(size_t i) const
+    {
+        return instances[order[i].index];
+    }
+    // Texture binds of the last flush
+    inline int GetDrawCount() const
+    {
+        return draw_count;
+    }
+    // Sprites drawn by the last flush
+    inline int GetInstanceCount() const
+    {
+        return instance_count;
+    }
+};
+
+#endif // SPRITE_BATCH_H
@@ -0,0 +1,222 @@
+#ifndef SPRITE_REGISTRY_H
+#define SPRITE_REGISTRY_H
+
+#include "raylib.h"
+#include <cassert>
+#include <cstdint>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Handle to a sprite of the SpriteRegistry, a few bytes to copy around
+struct SpriteHandle
+{
+    int32_t index = -1;
+
+    inline bool IsValid() const
+    {
+        return index >= 0;
+    }
+    inline bool operator==(const SpriteHandle &other) const
+    {
+        return index == other.index;
+    }
+    inline bool operator!=(const SpriteHandle &other) const
+    {
+        return !(*this == other);
+    }
+};
+
+// Procedural pixel art generated once per (name, seed) and packed into a single atlas
+// texture. Sprites are placed on shelves as they are registered and never move, so a
+// handle keeps its atlas rectangle. The atlas is uploaded again only when sprites were
+// added since the last upload. Not synchronized: sprites are only created on the thread
+// that owns the window, other threads may only look up what was created before they ran.
+class SpriteRegistry
+{
+public:
+    static constexpr int ATLAS_WIDTH = 1024;
+    // Transparent border around each sprite so filtering never reads a neighbour
+    static constexpr int PADDING = 1;
+
+private:
+    struct Sprite
+    {
+        // CPU copy, kept to build the atlas again when it grows
+        Image image = {0};
+        Rectangle source = {0.0f, 0.0f, 0.0f, 0.0f};
+    };
+
+    std::vector<Sprite> sprites;
+    std::unordered_map<uint64_t, int> sprite_lookup;
+    // Shelf being filled: its top, height and the x of the next sprite
+    int shelf_y = 0;
+    int shelf_height = 0;
+    int shelf_x = 0;
+    int atlas_height = 0;
+    Texture2D atlas = {0};
+    bool is_atlas_dirty = false;
+    int upload_count = 0;
+    // Thread allowed to add sprites, the one that first asked for the registry
+    std::thread::id owner_thread = std::this_thread::get_id();
+
+    SpriteRegistry() = default;
+
+    // FNV-1a of the name, then the seed
+    static inline uint64_t MakeKey(const char *name, uint32_t seed)
+    {
+        uint64_t hash = 14695981039346656037ull;
+        for (const char *c = name; *c; c++)
+        {
+            hash = (hash ^ static_cast<unsigned char>(*c)) * 1099511628211ull;
+        }
+        for (int i = 0; i < 4; i++)
+        {
+            hash = (hash ^ ((seed >> (i * 8)) & 0xFF)) * 1099511628211ull;
+        }
+        return hash;
+    }
+
+    inline Rectangle Place(int width, int height)
+    {
+        const int padded_width = width + PADDING * 2;
+        const int padded_height = height + PADDING * 2;
+        if (shelf_x + padded_width > ATLAS_WIDTH)
+        {
+            shelf_y += shelf_height;
+            shelf_x = 0;
+            shelf_height = 0;
+        }
+        Rectangle source = {static_cast<float>(shelf_x + PADDING), static_cast<float>(shelf_y + PADDING), static_cast<float>(width), static_cast<float>(height)};
+        shelf_x += padded_width;
+        if (padded_height > shelf_height)
+            shelf_height = padded_height;
+        // Power of two heights keep the atlas friendly to every GPU
+        int used_height = shelf_y + shelf_height;
+        if (atlas_height == 0)
+            atlas_height = 64;
+        while (atlas_height < used_height)
+            atlas_height *= 2;
+        return source;
+    }
+
+    inline void UploadAtlas()
+    {
+        Image atlas_image = GenImageColor(ATLAS_WIDTH, atlas_height, BLANK);
+        for (const Sprite &sprite : sprites)
+        {
+            ImageDraw(&atlas_image, sprite.image, {0.0f, 0.0f, static_cast<float>(sprite.image.width), static_cast<float>(sprite.image.height)}, sprite.source, WHITE);
+        }
+        if (atlas.id > 0)
+            UnloadTexture(atlas);
+        atlas = LoadTextureFromImage(atlas_image);
+        UnloadImage(atlas_image);
+        upload_count++;
+        is_atlas_dirty = false;
+    }
+
+public:
+    static SpriteRegistry &GetInstance()
+    {
+        static SpriteRegistry instance;
+        return instance;
+    }
+    SpriteRegistry(const SpriteRegistry &) = delete;
+    SpriteRegistry &operator=(const SpriteRegistry &) = delete;
+
+    // Sprite of (name, seed). generate() returns the Image, which the registry then owns,
+    // and only runs the first time the pair is asked for. Off the owner thread it is a
+    // lookup: a missing sprite is invalid and never drawn.
+    template <typename F>
+    inline SpriteHandle GetOrCreate(const char *name, uint32_t seed, F generate)
+    {
+        const uint64_t key = MakeKey(name, seed);
+        auto found = sprite_lookup.find(key);
+        if (found != sprite_lookup.end())
+            return {found->second};
+        if (std::this_thread::get_id() != owner_thread)
+        {
+            assert(!"sprites must be registered on the owner thread before other threads use them");
+            return SpriteHandle();
+        }
+        Sprite sprite;
+        sprite.image = generate();
+        sprite.source = Place(sprite.image.width, sprite.image.height);
+        sprites.push_back(sprite);
+        int index = static_cast<int>(sprites.size()) - 1;
+        sprite_lookup[key] = index;
+        is_atlas_dirty = true;
+        return {index};
+    }
+    inline SpriteHandle Find(const char *name, uint32_t seed) const
+    {
+        auto found = sprite_lookup.find(MakeKey(name, seed));
+        return found == sprite_lookup.end() ? SpriteHandle() : SpriteHandle{found->second};
+    }
+
+    // Rectangle of the sprite in the atlas
+    inline Rectangle GetSource(SpriteHandle sprite) const
+    {
+        return sprite.IsValid() ? sprites[sprite.index].source : Rectangle{0.0f, 0.0f, 0.0f, 0.0f};
+    }
+    inline Vector2 GetSize(SpriteHandle sprite) const
+    {
+        Rectangle source = GetSource(sprite);
+        return {source.width, source.height};
+    }
+
+    // The atlas with every sprite registered so far, uploaded once a window exists
+    inline Texture2D GetAtlas()
+    {
+        if (is_atlas_dirty && IsWindowReady())
+            UploadAtlas();
+        return atlas;
+    }
+
+    // Draw the sprite at its own size, rotated around origin
+    inline void Draw(SpriteHandle sprite, Vector2 position, Vector2 origin, float rotation, Color tint)
+    {
+        Rectangle source = GetSource(sprite);
+        DrawPro(sprite, {position.x, position.y, source.width, source.height}, origin, rotation, tint);
+    }
+    // Draw the sprite stretched over destination, rotated around origin
+    inline void DrawPro(SpriteHandle sprite, Rectangle destination, Vector2 origin, float rotation, Color tint)
+    {
+        if (!sprite.IsValid())
+            return;
+        DrawTexturePro(GetAtlas(), sprites[sprite.index].source, destination, origin, rotation, tint);
+    }
+
+    inline int GetSpriteCount() const
+    {
+        return static_cast<int>(sprites.size());
+    }
+    inline int GetUploadCount() const
+    {
+        return upload_count;
+    }
+    inline int GetAtlasHeight() const
+    {
+        return atlas_height;
+    }
+
+    // Free the atlas and every sprite, before the window closes. Handles from before
+    // are no longer valid.
+    inline void Unload()
+    {
+        if (atlas.id > 0 && IsWindowReady())
+            UnloadTexture(atlas);
+        atlas = {0};
+        for (Sprite &sprite : sprites)
+        {
+            UnloadImage(sprite.image);
+        }
+        sprites.clear();
+        sprite_lookup.clear();
+        shelf_y = shelf_height = shelf_x = 0;
+        atlas_height = 0;
+        is_atlas_dirty = false;
+    }
+};
+
+#endif // SPRITE_REGISTRY_H
@@ -52,17 +52,17 @@ public:
         // do nothing here yet!!!
     }
 
-    void FixUpdate(Vector2 in_camera_position)
+    void FixUpdate(float delta_time, Vector2 in_camera_position)
     {
         camera_position = in_camera_position;
         for (Star &star : farStars)
         {
-            star.position.x -= star.speed * GetFrameTime();
+            star.position.x -= star.speed * delta_time;
             ResetStar(star, camera_position);
         }
         for (Star &star : nearStars)
         {
-            star.position.x -= star.speed * GetFrameTime();
+            star.position.x -= star.speed * delta_time;
             ResetStar(star, camera_position);
         }
     }
@@ -95,22 +95,16 @@ public:
             star.position.x = GetRandomValue(left_edge, right_edge);
         }
     }
-    void ReOriginStarsX(float x)
+    // The camera moved to another sector, offset goes from the old sector to the new one
+    void ShiftOrigin(Vector2 offset)
     {
         for (Star &obj : farStars){
-            obj.position.x -= x;
+            obj.position.x += offset.x;
+            obj.position.y += offset.y;
         }
         for (Star &obj : nearStars){
-            obj.position.x -= x;
-        }
-    }
-    void ReOriginStarsY(float y)
-    {
-        for (Star &obj : farStars){
-            obj.position.y -= y;
-        }
-        for (Star &obj : nearStars){
-            obj.position.y -= y;
+            obj.position.x += offset.x;
+            obj.position.y += offset.y;
         }
     }
 
@@ -0,0 +1,112 @@
+#ifndef SWEPT_COLLISION_H
+#define SWEPT_COLLISION_H
+
+#include "raylib.h"
+#include "raymath.h"
+#include <math.h>
+#include <algorithm>
+#include "convex_polygon.h"
+
+// Time of impact tests for a circle moving from start to end during one tick.
+// time is the fraction of the move, in [0, 1], where the circle first touches the target.
+
+// Moving circle against a static circle: segment against the circle grown by radius
+inline bool SweptCircleCircle(Vector2 start, Vector2 end, float radius, Vector2 center, float other_radius, float &time)
+{
+    float radius_sum = radius + other_radius;
+    Vector2 offset = Vector2Subtract(start, center);
+    float c = Vector2DotProduct(offset, offset) - radius_sum * radius_sum;
+    if (c <= 0.0f)
+    {
+        // Already overlapping at the start of the tick
+        time = 0.0f;
+        return true;
+    }
+    Vector2 move = Vector2Subtract(end, start);
+    float a = Vector2DotProduct(move, move);
+    float b = Vector2DotProduct(offset, move);
+    // Not moving or moving away
+    if (a <= 0.0f || b >= 0.0f)
+        return false;
+    float discriminant = b * b - a * c;
+    if (discriminant < 0.0f)
+        return false;
+    float t = (-b - sqrtf(discriminant)) / a;
+    if (t > 1.0f)
+        return false;
+    time = std::max(t, 0.0f);
+    return true;
+}
+
+// Moving circle against a static rectangle, slab test of the segment against the
+// rectangle grown by radius. The grown corners are square, so a circle passing just
+// outside a corner can report a hit.
+inline bool SweptCircleRect(Vector2 start, Vector2 end, float radius, Rectangle rectangle, float &time)
+{
+    float min_x = rectangle.x - radius;
+    float min_y = rectangle.y - radius;
+    float max_x = rectangle.x + rectangle.width + radius;
+    float max_y = rectangle.y + rectangle.height + radius;
+    Vector2 move = Vector2Subtract(end, start);
+    float enter = 0.0f;
+    float exit = 1.0f;
+    const float starts[2] = {start.x, start.y};
+    const float moves[2] = {move.x, move.y};
+    const float mins[2] = {min_x, min_y};
+    const float maxs[2] = {max_x, max_y};
+    for (int axis = 0; axis < 2; axis++)
+    {
+        if (moves[axis] == 0.0f)
+        {
+            if (starts[axis] < mins[axis] || starts[axis] > maxs[axis])
+                return false;
+            continue;
+        }
+        float inverse_move = 1.0f / moves[axis];
+        float t0 = (mins[axis] - starts[axis]) * inverse_move;
+        float t1 = (maxs[axis] - starts[axis]) * inverse_move;
+        if (t0 > t1)
+            std::swap(t0, t1);
+        enter = std::max(enter, t0);
+        exit = std::min(exit, t1);
+        if (enter > exit)
+            return false;
+    }
+    time = enter;
+    return true;
+}
+
+// Moving circle against a convex hull, the segment is clipped by every edge pushed out
+// by radius. Like the rectangle test the grown corners are sharp.
+inline bool SweptCirclePolygon(Vector2 start, Vector2 end, float radius, const WorldPolygon &polygon, float &time)
+{
+    if (polygon.count == 0)
+        return false;
+    Vector2 move = Vector2Subtract(end, start);
+    float enter = 0.0f;
+    float exit = 1.0f;
+    for (int i = 0; i < polygon.count; i++)
+    {
+        const Vector2 &normal = polygon.normals[i];
+        // Signed distance of the start outside the grown edge, and its change over the move
+        float distance = Vector2DotProduct(Vector2Subtract(start, polygon.vertices[i]), normal) - radius;
+        float approach = Vector2DotProduct(move, normal);
+        if (approach == 0.0f)
+        {
+            if (distance > 0.0f)
+                return false;
+            continue;
+        }
+        float t = -distance / approach;
+        if (approach < 0.0f)
+            enter = std::max(enter, t);
+        else
+            exit = std::min(exit, t);
+        if (enter > exit)
+            return false;
+    }
+    time = enter;
+    return true;
+}
+
+#endif // SWEPT_COLLISION_H
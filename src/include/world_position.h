@@ -0,0 +1,68 @@
+#ifndef WORLD_POSITION_H
+#define WORLD_POSITION_H
+
+#include "raylib.h"
+#include <math.h>
+#include <cstdint>
+
+// The world is cut in square sectors. A position is the integer sector plus a float
+// offset inside it, so precision is the same at the galactic core as at the start.
+// Floats only ever hold offsets from a nearby sector: inside a sector, or relative
+// to the sector of the view when rendering and testing collisions.
+constexpr float WORLD_SECTOR_SIZE = 1024.0f;
+
+struct WorldSector
+{
+    int32_t x = 0;
+    int32_t y = 0;
+
+    inline bool operator==(const WorldSector &other) const
+    {
+        return x == other.x && y == other.y;
+    }
+    inline bool operator!=(const WorldSector &other) const
+    {
+        return !(*this == other);
+    }
+    // Offset in world units from origin to the corner of this sector
+    inline Vector2 OffsetFrom(WorldSector origin) const
+    {
+        return {static_cast<float>(x - origin.x) * WORLD_SECTOR_SIZE, static_cast<float>(y - origin.y) * WORLD_SECTOR_SIZE};
+    }
+};
+
+// Move whole sectors out of the offset until it lies in [0, WORLD_SECTOR_SIZE]
+inline void NormalizeSectorOffset(int32_t &sector, float &offset)
+{
+    if (offset >= 0.0f && offset < WORLD_SECTOR_SIZE)
+        return;
+    float sectors = floorf(offset / WORLD_SECTOR_SIZE);
+    sector += static_cast<int32_t>(sectors);
+    offset -= sectors * WORLD_SECTOR_SIZE;
+}
+
+struct WorldPosition
+{
+    WorldSector sector;
+    // Offset from the corner of the sector
+    Vector2 local = {0.0f, 0.0f};
+
+    // Any offset from the corner of sector, folded into the sector it falls in
+    static inline WorldPosition FromOffset(WorldSector sector, Vector2 offset)
+    {
+        WorldPosition position;
+        position.sector = sector;
+        position.local = offset;
+        NormalizeSectorOffset(position.sector.x, position.local.x);
+        NormalizeSectorOffset(position.sector.y, position.local.y);
+        return position;
+    }
+    // Position relative to the corner of origin, exact while both are close
+    inline Vector2 RelativeTo(WorldSector origin) const
+    {
+        Vector2 offset = sector.OffsetFrom(origin);
+        return {offset.x + local.x, offset.y + local.y};
+    }
+};
+
+#endif // WORLD_POSITION_H
@@ -1,6 +1,9 @@
 #include "raylib.h"
 #include "game_manager.h"
 #include "global.h"
+#include "fixed_timestep.h"
+#include "frame_arena.h"
+#include "async_logger.h"
 #include <iostream>
 #include <string>
 #include <cstring>
@@ -18,46 +21,32 @@
 
 void UpdateDrawFrame(void);
 
+// Queued to the AsyncLogger, written out by its thread so the game loop never waits on I/O
 void CustomLog(int msg_type, const char *text, va_list args)
 {
-    switch (msg_type)
+    // check if text starts with TIMER:
+    if (msg_type == LOG_INFO && strncmp(text, "TIMER:", 6) == 0)
     {
-    case LOG_INFO:
-        // check if text starts with TIMER:
-        if (strncmp(text, "TIMER:", 6) == 0)
-        {
-            // // Extract the time value from the text
-            // int time;
-            // sscanf(text, "TIMER: %d", &time);
-            // std::cout << "[TIMER]: " << time << " ms" << std::endl;
-        }
-        else
-        {
-            std::cout << "[INFO] : " << text << std::endl;
-        }
-        break;
-    case LOG_ERROR:
-        std::cout << "[ERROR]: " << text << std::endl;
-        break;
-    case LOG_WARNING:
-        std::cout << "[WARN] : " << text << std::endl;
-        break;
-    case LOG_DEBUG:
-        std::cout << "[DEBUG]: " << text << std::endl;
-        break;
-    default:
-        break;
+        // // Extract the time value from the text
+        // int time;
+        // sscanf(text, "TIMER: %d", &time);
+        // std::cout << "[TIMER]: " << time << " ms" << std::endl;
+        return;
     }
+    AsyncLogger::GetInstance().Log(msg_type, text, args);
 }
 // Initialization
 int screen_width = 640;
 int screen_height = 360;
 int virtual_screen_width = 640;
 int virtual_screen_height = 360;
-const float target_frame_time = 0.02f; // Target 50 FPS
+// Physics runs at a fixed tick rate whatever the render frame rate is
+const float physics_tick_rate = 50.0f;
+// Steps simulated in one frame at most, slower frames drop the extra time
+const int max_physics_steps_per_frame = 5;
 
 float scale = (float)screen_height / (float)virtual_screen_height;
-float accumulator = 0.0f;
+FixedTimestep fixed_timestep(physics_tick_rate, max_physics_steps_per_frame);
 GameManager *game_manager;
 bool is_game_fullscreen = false;
 float dt = -1;
@@ -89,19 +78,20 @@ void UpdateDrawFrame(void)
     // Update game manager
     if(IsWindowFocused()){
         game_manager->Update(dt);
-        // Fix Update for physics
-        accumulator += dt;
-        while (accumulator >= target_frame_time)
+        // Fix Update for physics, always with the same step
+        int physics_steps = fixed_timestep.Advance(dt);
+        for (int i = 0; i < physics_steps; i++)
         {
-            game_manager->FixUpdate(accumulator);
-            accumulator -= accumulator;
+            game_manager->FixUpdate(fixed_timestep.GetStep());
         }
-        TraceLog(LOG_DEBUG, TextFormat("Update Time: %f accumulator: %f", dt, accumulator));
+        GAME_LOG(LOG_DEBUG, "Update Time: %f physics steps: %i", dt, physics_steps);
     }
     BeginTextureMode(target);
     // All drawing happens here
     if(IsWindowFocused()){
-        game_manager->Render();
+        // Draw between the last two physics steps
+        game_manager->Render(fixed_timestep.GetAlpha());
+        game_manager->EndFrame();
     }
 
     EndTextureMode();
@@ -112,11 +102,16 @@ void UpdateDrawFrame(void)
 
         DrawTexturePro(target.texture, source_rec, dest_rec, { 0, 0 }, 0, WHITE);
     EndDrawing();
+    // Transient data of the frame is gone, the arenas start over
+    FrameArenas::GetInstance().ResetAll();
+    // Web build: no logger thread, the frame writes the log out
+    AsyncLogger::GetInstance().Pump();
 }
 
 #ifndef TESTING
 int main()
 {
+    AsyncLogger::GetInstance().Start();
     SetTraceLogCallback(CustomLog);
     SetTraceLogLevel(LOG_DEBUG);
     InitWindow(screen_width, screen_height, "Depths of Iara");
@@ -142,6 +137,10 @@ int main()
     }
     // Create a Game_manager instance
     game_manager = new GameManager();
+#ifdef THREADED_SIMULATION
+    // Same step as the frame loop, the web build falls back to it
+    game_manager->SetThreadedSimulation(true, fixed_timestep);
+#endif
     SetMouseCursor(MOUSE_CURSOR_CROSSHAIR);
 
 #ifdef __EMSCRIPTEN__
@@ -159,6 +158,7 @@ int main()
 
     delete game_manager;
     CloseWindow();
+    AsyncLogger::GetInstance().Stop();
 
     return 0;
 }
@@ -0,0 +1,346 @@
+#include "physics_kernels.h"
+#include "physics_body_store.h"
+#include <math.h>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__)) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define PHYSICS_KERNELS_SSE2
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(__wasm_simd128__)
+#define PHYSICS_KERNELS_WASM_SIMD
+#include <wasm_simd128.h>
+#endif
+
+// Scalar kernels, the reference every SIMD path has to match bit for bit
+
+static void IntegrateScalar(const IntegrationStreams &s, int begin, int end, float delta_time)
+{
+    for (int i = begin; i < end; i++)
+    {
+        if ((s.flags[i] & (BODY_ALIVE | BODY_LOD_DEFERRED)) != BODY_ALIVE)
+            continue;
+        float rotation = s.rotation[i];
+        float torque = s.rotation_torque[i];
+        float velocity_x = s.velocity_x[i];
+        float velocity_y = s.velocity_y[i];
+        const float speed_limit = s.speed_limit[i];
+        const float rotation_speed_limit = s.rotation_speed_limit[i];
+        const float friction = 1 - s.deceleration_multiplier[i] * delta_time;
+
+        // ensure our angle is between -180 and +180
+        if (rotation > 180.0f)
+            rotation -= 360.0f;
+        if (rotation < -180.0f)
+            rotation += 360.0f;
+
+        // Limit speed
+        float length = sqrtf((velocity_x * velocity_x) + (velocity_y * velocity_y));
+        if (length > speed_limit)
+        {
+            if (length > 0.0f)
+            {
+                float inverse_length = 1.0f / length;
+                velocity_x = (velocity_x * inverse_length) * speed_limit;
+                velocity_y = (velocity_y * inverse_length) * speed_limit;
+            }
+            else
+            {
+                velocity_x = 0.0f;
+                velocity_y = 0.0f;
+            }
+        }
+
+        // Update position if velocity is different then 0
+        length = sqrtf((velocity_x * velocity_x) + (velocity_y * velocity_y));
+        if (length > 0.0f)
+        {
+            // Friction
+            velocity_x = velocity_x * friction;
+            velocity_y = velocity_y * friction;
+            s.position_x[i] = s.position_x[i] + velocity_x * delta_time;
+            s.position_y[i] = s.position_y[i] + velocity_y * delta_time;
+        }
+        else
+        {
+            s.flags[i] &= ~BODY_ACCELERATING;
+        }
+        // adjust rotation_torque to rotation_speed_limit
+        if (torque > rotation_speed_limit)
+        {
+            torque = rotation_speed_limit;
+        }
+        else if (torque < -rotation_speed_limit)
+        {
+            torque = -rotation_speed_limit;
+        }
+        // Update rotation if rotational_velocity is different then 0
+        if (torque != 0.0f)
+        {
+            rotation = rotation + torque * delta_time;
+            if (!(s.flags[i] & BODY_APPLYING_TORQUE))
+            {
+                torque = torque * friction;
+            }
+            s.flags[i] &= ~BODY_APPLYING_TORQUE;
+        }
+        velocity_y += s.acceleration_y[i] * delta_time;
+        velocity_x += s.acceleration_x[i] * delta_time;
+
+        s.rotation[i] = rotation;
+        s.rotation_torque[i] = torque;
+        s.velocity_x[i] = velocity_x;
+        s.velocity_y[i] = velocity_y;
+    }
+}
+
+static void CircleCircleScalar(float x, float y, float radius, const float *other_x, const float *other_y, const float *other_radius, int count, uint8_t *hits)
+{
+    for (int i = 0; i < count; i++)
+    {
+        float dx = other_x[i] - x;
+        float dy = other_y[i] - y;
+        float distance_squared = dx * dx + dy * dy;
+        float radius_sum = radius + other_radius[i];
+        hits[i] = distance_squared <= radius_sum * radius_sum;
+    }
+}
+
+static void CircleRectScalar(float x, float y, float radius, const float *rect_x, const float *rect_y, const float *rect_width, const float *rect_height, int count, uint8_t *hits)
+{
+    const float radius_squared = radius * radius;
+    for (int i = 0; i < count; i++)
+    {
+        float half_width = rect_width[i] * 0.5f;
+        float half_height = rect_height[i] * 0.5f;
+        float dx = fabsf(x - (rect_x[i] + half_width));
+        float dy = fabsf(y - (rect_y[i] + half_height));
+        if (dx > half_width + radius || dy > half_height + radius)
+        {
+            hits[i] = 0;
+        }
+        else if (dx <= half_width || dy <= half_height)
+        {
+            hits[i] = 1;
+        }
+        else
+        {
+            float corner_x = dx - half_width;
+            float corner_y = dy - half_height;
+            hits[i] = corner_x * corner_x + corner_y * corner_y <= radius_squared;
+        }
+    }
+}
+
+#ifdef PHYSICS_KERNELS_SSE2
+namespace sse2
+{
+    struct Ops
+    {
+        using V = __m128;
+        static constexpr int Width = 4;
+        static inline V Load(const float *p) { return _mm_loadu_ps(p); }
+        static inline void Store(float *p, V v) { _mm_storeu_ps(p, v); }
+        static inline V Set1(float f) { return _mm_set1_ps(f); }
+        static inline V Add(V a, V b) { return _mm_add_ps(a, b); }
+        static inline V Sub(V a, V b) { return _mm_sub_ps(a, b); }
+        static inline V Mul(V a, V b) { return _mm_mul_ps(a, b); }
+        static inline V Div(V a, V b) { return _mm_div_ps(a, b); }
+        static inline V Sqrt(V a) { return _mm_sqrt_ps(a); }
+        static inline V Abs(V a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+        static inline V Gt(V a, V b) { return _mm_cmpgt_ps(a, b); }
+        static inline V Lt(V a, V b) { return _mm_cmplt_ps(a, b); }
+        static inline V Le(V a, V b) { return _mm_cmple_ps(a, b); }
+        static inline V Ne(V a, V b) { return _mm_cmpneq_ps(a, b); }
+        static inline V And(V a, V b) { return _mm_and_ps(a, b); }
+        static inline V Or(V a, V b) { return _mm_or_ps(a, b); }
+        // a & ~b
+        static inline V AndNot(V a, V b) { return _mm_andnot_ps(b, a); }
+        static inline V Select(V mask, V if_true, V if_false) { return _mm_or_ps(_mm_and_ps(mask, if_true), _mm_andnot_ps(mask, if_false)); }
+        static inline int MoveMask(V mask) { return _mm_movemask_ps(mask); }
+        static inline V FlagMask(const uint16_t *flags, uint16_t flag)
+        {
+            __m128i lanes = _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(flags)), _mm_setzero_si128());
+            __m128i bit = _mm_set1_epi32(flag);
+            return _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(lanes, bit), bit));
+        }
+    };
+#include "physics_kernels_simd.inl"
+}
+
+#if defined(__clang__)
+#pragma clang attribute push(__attribute__((target("avx2"))), apply_to = function)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC target("avx2")
+#endif
+namespace avx2
+{
+    struct Ops
+    {
+        using V = __m256;
+        static constexpr int Width = 8;
+        static inline V Load(const float *p) { return _mm256_loadu_ps(p); }
+        static inline void Store(float *p, V v) { _mm256_storeu_ps(p, v); }
+        static inline V Set1(float f) { return _mm256_set1_ps(f); }
+        static inline V Add(V a, V b) { return _mm256_add_ps(a, b); }
+        static inline V Sub(V a, V b) { return _mm256_sub_ps(a, b); }
+        static inline V Mul(V a, V b) { return _mm256_mul_ps(a, b); }
+        static inline V Div(V a, V b) { return _mm256_div_ps(a, b); }
+        static inline V Sqrt(V a) { return _mm256_sqrt_ps(a); }
+        static inline V Abs(V a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+        static inline V Gt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+        static inline V Lt(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static inline V Le(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static inline V Ne(V a, V b) { return _mm256_cmp_ps(a, b, _CMP_NEQ_UQ); }
+        static inline V And(V a, V b) { return _mm256_and_ps(a, b); }
+        static inline V Or(V a, V b) { return _mm256_or_ps(a, b); }
+        // a & ~b
+        static inline V AndNot(V a, V b) { return _mm256_andnot_ps(b, a); }
+        static inline V Select(V mask, V if_true, V if_false) { return _mm256_blendv_ps(if_false, if_true, mask); }
+        static inline int MoveMask(V mask) { return _mm256_movemask_ps(mask); }
+        static inline V FlagMask(const uint16_t *flags, uint16_t flag)
+        {
+            __m256i lanes = _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(flags)));
+            __m256i bit = _mm256_set1_epi32(flag);
+            return _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_and_si256(lanes, bit), bit));
+        }
+    };
+#include "physics_kernels_simd.inl"
+}
+#if defined(__clang__)
+#pragma clang attribute pop
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+static bool CpuSupportsAvx2()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    if (info[0] < 7)
+        return false;
+    __cpuid(info, 1);
+    // OSXSAVE and AVX, then the OS must save the YMM registers
+    if ((info[2] & (1 << 27)) == 0 || (info[2] & (1 << 28)) == 0)
+        return false;
+    if ((_xgetbv(0) & 0x6) != 0x6)
+        return false;
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif // PHYSICS_KERNELS_SSE2
+
+#ifdef PHYSICS_KERNELS_WASM_SIMD
+namespace wasm
+{
+    struct Ops
+    {
+        using V = v128_t;
+        static constexpr int Width = 4;
+        static inline V Load(const float *p) { return wasm_v128_load(p); }
+        static inline void Store(float *p, V v) { wasm_v128_store(p, v); }
+        static inline V Set1(float f) { return wasm_f32x4_splat(f); }
+        static inline V Add(V a, V b) { return wasm_f32x4_add(a, b); }
+        static inline V Sub(V a, V b) { return wasm_f32x4_sub(a, b); }
+        static inline V Mul(V a, V b) { return wasm_f32x4_mul(a, b); }
+        static inline V Div(V a, V b) { return wasm_f32x4_div(a, b); }
+        static inline V Sqrt(V a) { return wasm_f32x4_sqrt(a); }
+        static inline V Abs(V a) { return wasm_f32x4_abs(a); }
+        static inline V Gt(V a, V b) { return wasm_f32x4_gt(a, b); }
+        static inline V Lt(V a, V b) { return wasm_f32x4_lt(a, b); }
+        static inline V Le(V a, V b) { return wasm_f32x4_le(a, b); }
+        static inline V Ne(V a, V b) { return wasm_f32x4_ne(a, b); }
+        static inline V And(V a, V b) { return wasm_v128_and(a, b); }
+        static inline V Or(V a, V b) { return wasm_v128_or(a, b); }
+        // a & ~b
+        static inline V AndNot(V a, V b) { return wasm_v128_andnot(a, b); }
+        static inline V Select(V mask, V if_true, V if_false) { return wasm_v128_bitselect(if_true, if_false, mask); }
+        static inline int MoveMask(V mask) { return wasm_i32x4_bitmask(mask); }
+        static inline V FlagMask(const uint16_t *flags, uint16_t flag)
+        {
+            V lanes = wasm_u32x4_load16x4(flags);
+            V bit = wasm_i32x4_splat(flag);
+            return wasm_i32x4_eq(wasm_v128_and(lanes, bit), bit);
+        }
+    };
+#include "physics_kernels_simd.inl"
+}
+#endif // PHYSICS_KERNELS_WASM_SIMD
+
+static const PhysicsKernels scalar_kernels = {SimdPath::Scalar, "Scalar", IntegrateScalar, CircleCircleScalar, CircleRectScalar};
+#ifdef PHYSICS_KERNELS_SSE2
+static const PhysicsKernels sse2_kernels = {SimdPath::SSE2, "SSE2", sse2::Integrate, sse2::CircleCircle, sse2::CircleRect};
+static const PhysicsKernels avx2_kernels = {SimdPath::AVX2, "AVX2", avx2::Integrate, avx2::CircleCircle, avx2::CircleRect};
+#endif
+#ifdef PHYSICS_KERNELS_WASM_SIMD
+static const PhysicsKernels wasm_kernels = {SimdPath::WasmSimd128, "WASM SIMD", wasm::Integrate, wasm::CircleCircle, wasm::CircleRect};
+#endif
+
+bool IsSimdPathSupported(SimdPath path)
+{
+    switch (path)
+    {
+    case SimdPath::Scalar:
+        return true;
+#ifdef PHYSICS_KERNELS_SSE2
+    case SimdPath::SSE2:
+        return true;
+    case SimdPath::AVX2:
+    {
+        static const bool has_avx2 = CpuSupportsAvx2();
+        return has_avx2;
+    }
+#endif
+#ifdef PHYSICS_KERNELS_WASM_SIMD
+    // WebAssembly has no feature detection, a module built with -msimd128 only loads where SIMD exists
+    case SimdPath::WasmSimd128:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+const PhysicsKernels &GetPhysicsKernels(SimdPath path)
+{
+    if (!IsSimdPathSupported(path))
+        return scalar_kernels;
+    switch (path)
+    {
+#ifdef PHYSICS_KERNELS_SSE2
+    case SimdPath::SSE2:
+        return sse2_kernels;
+    case SimdPath::AVX2:
+        return avx2_kernels;
+#endif
+#ifdef PHYSICS_KERNELS_WASM_SIMD
+    case SimdPath::WasmSimd128:
+        return wasm_kernels;
+#endif
+    default:
+        return scalar_kernels;
+    }
+}
+
+const PhysicsKernels &GetPhysicsKernels()
+{
+    static const PhysicsKernels &best = []() -> const PhysicsKernels &
+    {
+        for (SimdPath path : {SimdPath::AVX2, SimdPath::WasmSimd128, SimdPath::SSE2})
+        {
+            if (IsSimdPathSupported(path))
+                return GetPhysicsKernels(path);
+        }
+        return scalar_kernels;
+    }();
+    return best;
+}
@@ -0,0 +1,138 @@
+// Generic SIMD physics kernels, included by physics_kernels.cpp once per instruction set
+// inside a namespace that defines `Ops` (lane type, width and lane operations).
+// Every operation mirrors the scalar kernels one to one so results stay bit-identical.
+
+static void Integrate(const IntegrationStreams &s, int begin, int end, float delta_time)
+{
+    using V = Ops::V;
+    const V dt = Ops::Set1(delta_time);
+    const V zero = Ops::Set1(0.0f);
+    const V one = Ops::Set1(1.0f);
+    const V half_turn = Ops::Set1(180.0f);
+    const V minus_half_turn = Ops::Set1(-180.0f);
+    const V full_turn = Ops::Set1(360.0f);
+    int i = begin;
+    for (; i + Ops::Width <= end; i += Ops::Width)
+    {
+        const V alive = Ops::AndNot(Ops::FlagMask(s.flags + i, BODY_ALIVE), Ops::FlagMask(s.flags + i, BODY_LOD_DEFERRED));
+        if (Ops::MoveMask(alive) == 0)
+            continue;
+        const V applying_torque = Ops::FlagMask(s.flags + i, BODY_APPLYING_TORQUE);
+        V rotation = Ops::Load(s.rotation + i);
+        V torque = Ops::Load(s.rotation_torque + i);
+        V velocity_x = Ops::Load(s.velocity_x + i);
+        V velocity_y = Ops::Load(s.velocity_y + i);
+        V position_x = Ops::Load(s.position_x + i);
+        V position_y = Ops::Load(s.position_y + i);
+        const V speed_limit = Ops::Load(s.speed_limit + i);
+        const V rotation_speed_limit = Ops::Load(s.rotation_speed_limit + i);
+        const V friction = Ops::Sub(one, Ops::Mul(Ops::Load(s.deceleration_multiplier + i), dt));
+
+        // ensure our angle is between -180 and +180
+        rotation = Ops::Select(Ops::Gt(rotation, half_turn), Ops::Sub(rotation, full_turn), rotation);
+        rotation = Ops::Select(Ops::Lt(rotation, minus_half_turn), Ops::Add(rotation, full_turn), rotation);
+
+        // Limit speed (normalize then scale, zero length normalizes to zero)
+        V length = Ops::Sqrt(Ops::Add(Ops::Mul(velocity_x, velocity_x), Ops::Mul(velocity_y, velocity_y)));
+        const V has_length = Ops::Gt(length, zero);
+        const V inverse_length = Ops::Div(one, length);
+        const V clamped_x = Ops::Select(has_length, Ops::Mul(Ops::Mul(velocity_x, inverse_length), speed_limit), zero);
+        const V clamped_y = Ops::Select(has_length, Ops::Mul(Ops::Mul(velocity_y, inverse_length), speed_limit), zero);
+        const V over_limit = Ops::Gt(length, speed_limit);
+        velocity_x = Ops::Select(over_limit, clamped_x, velocity_x);
+        velocity_y = Ops::Select(over_limit, clamped_y, velocity_y);
+
+        // Friction and position update for moving bodies
+        length = Ops::Sqrt(Ops::Add(Ops::Mul(velocity_x, velocity_x), Ops::Mul(velocity_y, velocity_y)));
+        const V moving = Ops::Gt(length, zero);
+        const V moved_velocity_x = Ops::Mul(velocity_x, friction);
+        const V moved_velocity_y = Ops::Mul(velocity_y, friction);
+        position_x = Ops::Select(moving, Ops::Add(position_x, Ops::Mul(moved_velocity_x, dt)), position_x);
+        position_y = Ops::Select(moving, Ops::Add(position_y, Ops::Mul(moved_velocity_y, dt)), position_y);
+        velocity_x = Ops::Select(moving, moved_velocity_x, velocity_x);
+        velocity_y = Ops::Select(moving, moved_velocity_y, velocity_y);
+
+        // adjust rotation_torque to rotation_speed_limit
+        const V minus_rotation_speed_limit = Ops::Sub(zero, rotation_speed_limit);
+        const V over_torque = Ops::Gt(torque, rotation_speed_limit);
+        const V under_torque = Ops::AndNot(Ops::Lt(torque, minus_rotation_speed_limit), over_torque);
+        torque = Ops::Select(over_torque, rotation_speed_limit, torque);
+        torque = Ops::Select(under_torque, minus_rotation_speed_limit, torque);
+        const V rotating = Ops::Ne(torque, zero);
+        rotation = Ops::Select(rotating, Ops::Add(rotation, Ops::Mul(torque, dt)), rotation);
+        torque = Ops::Select(Ops::AndNot(rotating, applying_torque), Ops::Mul(torque, friction), torque);
+
+        velocity_y = Ops::Add(velocity_y, Ops::Mul(Ops::Load(s.acceleration_y + i), dt));
+        velocity_x = Ops::Add(velocity_x, Ops::Mul(Ops::Load(s.acceleration_x + i), dt));
+
+        Ops::Store(s.rotation + i, Ops::Select(alive, rotation, Ops::Load(s.rotation + i)));
+        Ops::Store(s.rotation_torque + i, Ops::Select(alive, torque, Ops::Load(s.rotation_torque + i)));
+        Ops::Store(s.velocity_x + i, Ops::Select(alive, velocity_x, Ops::Load(s.velocity_x + i)));
+        Ops::Store(s.velocity_y + i, Ops::Select(alive, velocity_y, Ops::Load(s.velocity_y + i)));
+        Ops::Store(s.position_x + i, Ops::Select(alive, position_x, Ops::Load(s.position_x + i)));
+        Ops::Store(s.position_y + i, Ops::Select(alive, position_y, Ops::Load(s.position_y + i)));
+
+        // Flags stay scalar: one bit test per lane
+        const int stopped_lanes = Ops::MoveMask(Ops::AndNot(alive, moving));
+        const int rotating_lanes = Ops::MoveMask(Ops::And(alive, rotating));
+        for (int lane = 0; lane < Ops::Width; lane++)
+        {
+            if (stopped_lanes & (1 << lane))
+                s.flags[i + lane] &= ~BODY_ACCELERATING;
+            if (rotating_lanes & (1 << lane))
+                s.flags[i + lane] &= ~BODY_APPLYING_TORQUE;
+        }
+    }
+    IntegrateScalar(s, i, end, delta_time);
+}
+
+static void CircleCircle(float x, float y, float radius, const float *other_x, const float *other_y, const float *other_radius, int count, uint8_t *hits)
+{
+    using V = Ops::V;
+    const V center_x = Ops::Set1(x);
+    const V center_y = Ops::Set1(y);
+    const V radius_v = Ops::Set1(radius);
+    int i = 0;
+    for (; i + Ops::Width <= count; i += Ops::Width)
+    {
+        const V dx = Ops::Sub(Ops::Load(other_x + i), center_x);
+        const V dy = Ops::Sub(Ops::Load(other_y + i), center_y);
+        const V distance_squared = Ops::Add(Ops::Mul(dx, dx), Ops::Mul(dy, dy));
+        const V radius_sum = Ops::Add(radius_v, Ops::Load(other_radius + i));
+        const int hit_lanes = Ops::MoveMask(Ops::Le(distance_squared, Ops::Mul(radius_sum, radius_sum)));
+        for (int lane = 0; lane < Ops::Width; lane++)
+        {
+            hits[i + lane] = (hit_lanes >> lane) & 1;
+        }
+    }
+    CircleCircleScalar(x, y, radius, other_x + i, other_y + i, other_radius + i, count - i, hits + i);
+}
+
+static void CircleRect(float x, float y, float radius, const float *rect_x, const float *rect_y, const float *rect_width, const float *rect_height, int count, uint8_t *hits)
+{
+    using V = Ops::V;
+    const V center_x = Ops::Set1(x);
+    const V center_y = Ops::Set1(y);
+    const V radius_v = Ops::Set1(radius);
+    const V radius_squared = Ops::Mul(radius_v, radius_v);
+    const V half = Ops::Set1(0.5f);
+    int i = 0;
+    for (; i + Ops::Width <= count; i += Ops::Width)
+    {
+        const V half_width = Ops::Mul(Ops::Load(rect_width + i), half);
+        const V half_height = Ops::Mul(Ops::Load(rect_height + i), half);
+        const V dx = Ops::Abs(Ops::Sub(center_x, Ops::Add(Ops::Load(rect_x + i), half_width)));
+        const V dy = Ops::Abs(Ops::Sub(center_y, Ops::Add(Ops::Load(rect_y + i), half_height)));
+        const V outside = Ops::Or(Ops::Gt(dx, Ops::Add(half_width, radius_v)), Ops::Gt(dy, Ops::Add(half_height, radius_v)));
+        const V inside = Ops::Or(Ops::Le(dx, half_width), Ops::Le(dy, half_height));
+        const V corner_x = Ops::Sub(dx, half_width);
+        const V corner_y = Ops::Sub(dy, half_height);
+        const V corner = Ops::Le(Ops::Add(Ops::Mul(corner_x, corner_x), Ops::Mul(corner_y, corner_y)), radius_squared);
+        const int hit_lanes = Ops::MoveMask(Ops::AndNot(Ops::Or(inside, corner), outside));
+        for (int lane = 0; lane < Ops::Width; lane++)
+        {
+            hits[i + lane] = (hit_lanes >> lane) & 1;
+        }
+    }
+    CircleRectScalar(x, y, radius, rect_x + i, rect_y + i, rect_width + i, rect_height + i, count - i, hits + i);
+}
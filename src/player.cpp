@@ -6,7 +6,35 @@ Player::Player()
 {
     // Initialize player physics
     // position = {GetScreenWidth() / 2.0f, GetScreenHeight() / 2.0f};
-    // Generate a image for the spaceship
+    spaceship = SpriteRegistry::GetInstance().GetOrCreate("spaceship", 0, GenerateSpaceshipImage);
+    Vector2 spaceship_size = SpriteRegistry::GetInstance().GetSize(spaceship);
+    origin = {spaceship_size.x / 2.0f, (spaceship_size.y / 2.0f) + 2};
+    gun_socket_left = {7, 5};
+    gun_socket_right = {8, 5};
+    rotation_speed = 2.0f;
+    rotation_speed_limit = 50.0f;
+    speed = 40.0f;
+    deceleration_multiplier = 1.0f;
+    object_type = ObjectType::PLAYER_TYPE;
+    height = 10.0f;
+    width = spaceship_size.x;
+    center = origin;
+    body_sprite = {spaceship, origin, WHITE, RENDER_LAYER_PLAYER};
+    // Hull of the sprite pixels around origin: nose, wings and propellers
+    const Vector2 hull_points[] = {{-1, -5}, {1, -5}, {3, -4}, {4, -2}, {4, 6}, {-4, 6}, {-4, -2}, {-3, -4}};
+    SetHull(hull_points, 8);
+    is_on_screen = true;
+    gun_cooldown_time = 0.1f;
+    // float thruster_offset_x = spaceship.width * 0.2f;
+    // float thruster_offset_y = spaceship.height * 0.4f;
+
+    // Vector2 left_thruster_pos = { position.x - thruster_offset_x, position.y + thruster_offset_y };
+    // Vector2 right_thruster_pos = { position.x + thruster_offset_x, position.y + thruster_offset_y };
+}
+
+// Pixel art of the spaceship, generated once by the SpriteRegistry
+Image Player::GenerateSpaceshipImage()
+{
     Image spaceship_image = GenImageColor(16, 16, BLANK);
 
     // Draw spaceship Base
@@ -27,45 +55,7 @@ Player::Player()
     ImageDrawRectangleV(&spaceship_image, {4, 15}, {2, 1}, DARKGRAY);
     ImageDrawRectangleV(&spaceship_image, {10, 15}, {2, 1}, DARKGRAY);
 
-    Image propeller_image_left = GenImageColor(16, 19, BLANK);
-    ImageDrawPixelV(&propeller_image_left, {4, 16}, LIGHTGRAY);
-    ImageDrawPixelV(&propeller_image_left, {5, 17}, LIGHTGRAY);
-    ImageDrawPixelV(&propeller_image_left, {4, 18}, LIGHTGRAY);
-    Image propeller_image_right = GenImageColor(16, 19, BLANK);
-    ImageDrawPixelV(&propeller_image_right, {10, 16}, LIGHTGRAY);
-    ImageDrawPixelV(&propeller_image_right, {11, 17}, LIGHTGRAY);
-    ImageDrawPixelV(&propeller_image_right, {10, 18}, LIGHTGRAY);
-
-    if (IsWindowReady() == true)
-    {
-        // Load spaceship texture
-        spaceship = LoadTextureFromImage(spaceship_image);
-    }
-    else
-    {
-        spaceship = {0};
-    }
-
-
-    UnloadImage(spaceship_image);
-    origin = {spaceship.width / 2.0f, (spaceship.height / 2.0f) + 2};
-    gun_socket_left = {7, 5};
-    gun_socket_right = {8, 5};
-    rotation_speed = 2.0f;
-    rotation_speed_limit = 50.0f;
-    speed = 40.0f;
-    deceleration_multiplier = 1.0f;
-    object_type = ObjectType::PLAYER_TYPE;
-    height = 10.0f;
-    width = spaceship.width;
-    center = origin;
-    is_on_screen = true;
-    gun_cooldown_time = 0.1f;
-    // float thruster_offset_x = spaceship.width * 0.2f;
-    // float thruster_offset_y = spaceship.height * 0.4f;
-
-    // Vector2 left_thruster_pos = { position.x - thruster_offset_x, position.y + thruster_offset_y };
-    // Vector2 right_thruster_pos = { position.x + thruster_offset_x, position.y + thruster_offset_y };
+    return spaceship_image;
 }
 // Spaceship physics logic
 void Player::FixUpdate(float delta_time)
@@ -89,35 +79,26 @@ void Player::Update(float delta_time)
     direction = {
         sinf(rotation * DEG2RAD),
         -cosf(rotation * DEG2RAD)};
-    gun_position = Vector2Add(position, {direction.x * (spaceship.width - 10.0f), direction.y * (spaceship.height - 10.0f)});
+    Vector2 spaceship_size = SpriteRegistry::GetInstance().GetSize(spaceship);
+    gun_position = Vector2Add(position, {direction.x * (spaceship_size.x - 10.0f), direction.y * (spaceship_size.y - 10.0f)});
+    UpdateGunSight();
+    // Hits of the bullets fired by this ship since the last frame
+    EventBus::GetInstance().Drain<ScoreEvent>([this](const ScoreEvent &event)
+    {
+        if (event.source == physics_id)
+            score += event.points;
+    });
     for (int i = bullets.size()-1; i >= 0; i--)
     {
-        if (auto shared_bullet = bullets.at(i).lock())
-        {
-            if (shared_bullet->is_alive)
-            {
-                shared_bullet->Update(delta_time);
-                while (!shared_bullet->eventQueue.empty()) {
-                    BulletEvent event = shared_bullet->eventQueue.front();
-                    shared_bullet->eventQueue.pop();
-
-                    switch (event.type) {
-                        case BulletEventType::COLLISION:
-                            shared_bullet->Destroy();
-                            score += 10;
-                            break;
-                        default:
-                            break;
-                    }
-                }
-            }
-            else
-            {
-                bullets.erase(bullets.begin() + i);
-            }
-        }else
+        Bullet &bullet = bullet_pool->Get(bullets[i]);
+        if (bullet.is_enabled)
+            bullet.Update(delta_time);
+        // Spent bullets go back to the pool, the last one in flight takes their place
+        if (!bullet.is_enabled)
         {
-            bullets.erase(bullets.begin() + i);
+            bullet_pool->Release(bullets[i]);
+            bullets[i] = bullets.back();
+            bullets.pop_back();
         }
     }
     // // Update Thruster Position
@@ -154,47 +135,33 @@ void Player::Update(float delta_time)
     // thruster_right.Update(delta_time);;
 }
 
-void Player::Render()
-{ 
-    // Call the base class version
-    DynamicBody::Render();
-    // Check if window is ready
-    if (IsWindowReady() == false)
-        return;
-    if (!is_on_screen)
-        return;
-    DrawTexturePro(
-        spaceship,
-        Rectangle({0, 0, static_cast<float>(spaceship.width), static_cast<float>(spaceship.height)}),                   // Source rectangle (full texture)
-        Rectangle({position.x, position.y, static_cast<float>(spaceship.width), static_cast<float>(spaceship.height)}), // Destination rectangle (position and size)
-        origin,                                                                                                         // Origin of rotation (center of the texture)
-        rotation,                                                                                                       // Rotation in degrees
-        WHITE                                                                                                           // Tint color
-    );
-
-    if (is_accelerating || is_rotating_right)
-    {
-        // Draw rotated propeller texture Left
-        // thruster_left.Draw();
-    }
-    if (is_accelerating || is_rotating_left)
+GunSight Player::GetGunSight() const
+{
+    return {gun_position, direction, gun_range, gun_target.point, is_gun_on_target};
+}
+
+void Player::RenderGunSight(const GunSight &sight)
+{
+    DrawCircleV(sight.position, 1.0f, RED);
+    if (sight.is_on_target)
     {
-        // Draw rotated propeller texture Right
-        // thruster_right.Draw();
+        DrawLineV(sight.position, sight.target, {200, 0, 0, 60});
+        DrawCircleV(sight.target, 1.0f, RED);
     }
-    // Render bullets that are enabled
-    for (std::weak_ptr<Bullet> bullet : bullets)
+    else
     {
-        if (auto shared_bullet = bullet.lock())
-        {
-            if (shared_bullet->is_enabled)
-            {
-                shared_bullet->Render();
-            }
-        }
+        DrawLineV(sight.position, sight.position + Vector2Scale(sight.direction, sight.range), {0, 200, 0, 10});
     }
-    DrawCircleV(gun_position, 1.0f, RED);
-    DrawLineV(gun_position, gun_position + Vector2Scale(direction, gun_range), {0, 200, 0, 10});
+}
+
+// Cast the gun line up to gun_range, the sight locks on the first asteroid it crosses
+void Player::UpdateGunSight()
+{
+    QueryFilter filter;
+    filter.type_mask = ObjectTypeBit(ObjectType::ASTEROID_TYPE);
+    filter.ignore = physics_id;
+    Vector2 end = Vector2Add(gun_position, Vector2Scale(direction, gun_range));
+    is_gun_on_target = PhysicsSystem::GetInstance().Raycast(gun_position, end, filter, gun_target);
 }
 
 void Player::TurnLeft()
@@ -231,20 +198,19 @@ void Player::TakeDamage(float damage, Vector2 point)
 void Player::Shoot()
 {
     // Shoot a bullet
-    if (is_gun_ready)
+    if (is_gun_ready && bullet_pool != nullptr)
     {
+        // Every bullet is in flight, wait for one to come back
+        int index = bullet_pool->Acquire();
+        if (index < 0)
+            return;
         is_shooting = true;
         gun_cooldown = gun_cooldown_time; // Reset cooldown
         is_gun_ready = false;
-        std::shared_ptr<Bullet> bullet = Bullet::Create();
-        bullet->owner = shared_from_this();
-        bullet->position = gun_position;
-        bullet->rotation = rotation;
+        Bullet &bullet = bullet_pool->Get(index);
+        bullet.owner = physics_id;
         // Vector2 direction = {sin(rotation*DEG2RAD), -cos(rotation*DEG2RAD)};
-        bullet->SetEnabled(true);
-        PhysicsSystem::GetInstance().ApplyForce(bullet->physics_id, 500, direction);
-        bullets.push_back(bullet);
+        bullet.Fire(sector, gun_position, rotation, direction, 500);
+        bullets.push_back(index);
     }
-
-    // TODO: Add raycast collision detection here when needed
 }
@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <async_logger.h>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// Everything the logger wrote to output since it was rewound
+static std::string ReadOutput(FILE *output)
+{
+    std::string text;
+    rewind(output);
+    char line[256];
+    while (fgets(line, sizeof(line), output))
+        text += line;
+    return text;
+}
+
+TEST(AsyncLoggerTest, WritesEveryThreadInBatches) {
+    AsyncLogger &logger = AsyncLogger::GetInstance();
+    FILE *output = tmpfile();
+    ASSERT_NE(output, nullptr);
+    logger.Stop();
+    logger.SetOutput(output);
+    logger.SetRateLimit(1000);
+    logger.Start();
+    std::vector<std::thread> producers;
+    for (int thread = 0; thread < 4; thread++)
+    {
+        producers.emplace_back([&logger, thread]()
+        {
+            for (int i = 0; i < 100; i++)
+            {
+                logger.Log(LOG_INFO, "worker %i: message %i", thread, i);
+            }
+        });
+    }
+    for (std::thread &producer : producers)
+        producer.join();
+    logger.Stop();
+    std::string text = ReadOutput(output);
+    EXPECT_NE(text.find("[INFO] : worker 3: message 99\n"), std::string::npos);
+    int lines = 0;
+    for (char c : text)
+        lines += c == '\n';
+    EXPECT_EQ(lines, 400);
+    logger.SetOutput(stdout);
+    logger.SetRateLimit(AsyncLogger::RATE_LIMIT);
+    fclose(output);
+}
+
+TEST(AsyncLoggerTest, RateLimitsEachCategory) {
+    AsyncLogger &logger = AsyncLogger::GetInstance();
+    FILE *output = tmpfile();
+    ASSERT_NE(output, nullptr);
+    logger.Stop();
+    logger.SetOutput(output);
+    logger.SetRateLimit(5);
+    uint32_t rate_limited = logger.GetRateLimitedCount();
+    int queued = 0;
+    for (int i = 0; i < 50; i++)
+    {
+        queued += logger.Log(LOG_DEBUG, "Spam: %i", i);
+    }
+    // Another category is not held back by the first one
+    EXPECT_TRUE(logger.Log(LOG_WARNING, "Other: %i", 1));
+    // Two windows at most if the second turned during the loop
+    EXPECT_GE(queued, 5);
+    EXPECT_LE(queued, 10);
+    EXPECT_EQ(logger.GetRateLimitedCount() - rate_limited, static_cast<uint32_t>(50 - queued));
+    logger.Pump();
+    std::string text = ReadOutput(output);
+    EXPECT_NE(text.find("[DEBUG]: Spam: 0\n"), std::string::npos);
+    EXPECT_NE(text.find("[WARN] : Other: 1\n"), std::string::npos);
+    EXPECT_NE(text.find("rate limited"), std::string::npos);
+    logger.SetOutput(stdout);
+    logger.SetRateLimit(AsyncLogger::RATE_LIMIT);
+    fclose(output);
+}
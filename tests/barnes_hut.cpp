@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <barnes_hut.h>
+#include <cstdlib>
+#include <vector>
+
+struct TestBodies
+{
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> mass;
+};
+
+static TestBodies CreateTestBodies(int count, unsigned int seed)
+{
+    TestBodies bodies;
+    srand(seed);
+    for (int i = 0; i < count; i++)
+    {
+        bodies.x.push_back(static_cast<float>(rand() % 20000) / 10.0f);
+        bodies.y.push_back(static_cast<float>(rand() % 20000) / 10.0f);
+        bodies.mass.push_back(1.0f + static_cast<float>(rand() % 100));
+    }
+    return bodies;
+}
+
+static BarnesHutTree BuildTree(const TestBodies &bodies)
+{
+    BarnesHutTree tree;
+    for (size_t i = 0; i < bodies.x.size(); i++)
+    {
+        tree.AddBody(static_cast<int>(i), bodies.x[i], bodies.y[i], bodies.mass[i]);
+    }
+    tree.Build();
+    return tree;
+}
+
+TEST(BarnesHutTest, ZeroThetaMatchesBruteForce) {
+    TestBodies bodies = CreateTestBodies(300, 1);
+    BarnesHutTree tree = BuildTree(bodies);
+    for (int i = 0; i < 300; i += 7)
+    {
+        Vector2 expected = ComputeGravityBruteForce(bodies.x.data(), bodies.y.data(), bodies.mass.data(), 300, bodies.x[i], bodies.y[i], i, 5.0f);
+        Vector2 actual = tree.GetAcceleration(bodies.x[i], bodies.y[i], i, 0.0f, 5.0f);
+        EXPECT_NEAR(actual.x, expected.x, 1e-4f * (fabsf(expected.x) + 1e-3f));
+        EXPECT_NEAR(actual.y, expected.y, 1e-4f * (fabsf(expected.y) + 1e-3f));
+    }
+}
+
+TEST(BarnesHutTest, ApproximationErrorShrinksWithTheta) {
+    const int count = 2000;
+    TestBodies bodies = CreateTestBodies(count, 2);
+    BarnesHutTree tree = BuildTree(bodies);
+    float previous_error = INFINITY;
+    for (float theta : {1.0f, 0.5f, 0.25f})
+    {
+        // Relative RMS error of the acceleration over a sample of bodies
+        double error_sum = 0.0;
+        double norm_sum = 0.0;
+        for (int i = 0; i < count; i += 10)
+        {
+            Vector2 expected = ComputeGravityBruteForce(bodies.x.data(), bodies.y.data(), bodies.mass.data(), count, bodies.x[i], bodies.y[i], i, 5.0f);
+            Vector2 actual = tree.GetAcceleration(bodies.x[i], bodies.y[i], i, theta, 5.0f);
+            error_sum += (actual.x - expected.x) * (actual.x - expected.x) + (actual.y - expected.y) * (actual.y - expected.y);
+            norm_sum += expected.x * expected.x + expected.y * expected.y;
+        }
+        float error = static_cast<float>(sqrt(error_sum / norm_sum));
+        EXPECT_LT(error, previous_error);
+        if (theta <= 0.5f)
+        {
+            EXPECT_LT(error, 0.01f);
+        }
+        previous_error = error;
+    }
+}
+
+TEST(BarnesHutTest, CoincidentBodiesShareALeaf) {
+    BarnesHutTree tree;
+    for (int i = 0; i < 64; i++)
+    {
+        tree.AddBody(i, 10.0f, 10.0f, 1.0f);
+    }
+    tree.AddBody(64, 110.0f, 10.0f, 1.0f);
+    tree.Build();
+    const float softening = 1.0f;
+    const float one_pull = 100.0f / powf(10001.0f, 1.5f);
+    Vector2 pull = tree.GetAcceleration(110.0f, 10.0f, 64, 0.5f, softening);
+    // 64 unit masses 100 to the left
+    EXPECT_NEAR(pull.x, -64.0f * one_pull, 1e-6f);
+    EXPECT_NEAR(pull.y, 0.0f, 1e-6f);
+    // The coincident bodies cancel out, softening keeps their pull finite
+    Vector2 self_pull = tree.GetAcceleration(10.0f, 10.0f, 0, 0.5f, softening);
+    EXPECT_NEAR(self_pull.x, one_pull, 1e-6f);
+    EXPECT_NEAR(self_pull.y, 0.0f, 1e-6f);
+}
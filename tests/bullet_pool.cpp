@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+#include <bullet_pool.h>
+
+TEST(BulletPoolTest, FiredBulletsRecycleTheirPhysicsSlot) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    BulletPool pool;
+    int first = pool.Acquire();
+    ASSERT_GE(first, 0);
+    Bullet &bullet = pool.Get(first);
+    bullet.Fire(WorldSector(), {100.0f, 100.0f}, 90.0f, {1.0f, 0.0f}, 500.0f);
+    EXPECT_TRUE(bullet.is_enabled);
+    EXPECT_EQ(pool.GetActiveCount(), 1);
+    PhysicsHandle first_body = bullet.physics_id;
+    ASSERT_TRUE(physics.IsValid(first_body));
+    EXPECT_EQ(physics.GetGameObject(first_body).get(), &bullet);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(first_body).velocity.x, 500.0f);
+    // Back to the pool with its body, the next shot reuses both
+    pool.Release(first);
+    EXPECT_FALSE(physics.IsValid(first_body));
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    int second = pool.Acquire();
+    EXPECT_EQ(second, first);
+    pool.Get(second).Fire(WorldSector(), {100.0f, 100.0f}, 0.0f, {0.0f, -1.0f}, 500.0f);
+    EXPECT_EQ(pool.Get(second).physics_id.index, first_body.index);
+    EXPECT_NE(pool.Get(second).physics_id, first_body);
+    EXPECT_EQ(physics.GetBodyCount(), 1);
+    physics.Unload();
+    pool.Reset();
+    EXPECT_EQ(pool.GetActiveCount(), 0);
+}
+
+TEST(BulletPoolTest, RunsOutInsteadOfAllocating) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    BulletPool pool;
+    for (int i = 0; i < BulletPool::CAPACITY; i++)
+    {
+        EXPECT_GE(pool.Acquire(), 0);
+    }
+    EXPECT_EQ(pool.Acquire(), -1);
+    // A spent bullet is free again once released
+    pool.Release(3);
+    EXPECT_EQ(pool.Acquire(), 3);
+    // Every bullet shares the sprite of the pool
+    EXPECT_TRUE(pool.GetSprite().IsValid());
+    EXPECT_EQ(pool.Get(0).body_sprite.sprite, pool.GetSprite());
+    physics.Unload();
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include <convex_polygon.h>
+#include <swept_collision.h>
+
+TEST(ConvexPolygonTest, NormalsPointOutOfEitherWinding) {
+    const Vector2 clockwise[] = {{-1.0f, -1.0f}, {1.0f, -1.0f}, {1.0f, 1.0f}, {-1.0f, 1.0f}};
+    const Vector2 counter_clockwise[] = {{-1.0f, -1.0f}, {-1.0f, 1.0f}, {1.0f, 1.0f}, {1.0f, -1.0f}};
+    for (const Vector2 *points : {clockwise, counter_clockwise})
+    {
+        ConvexPolygon polygon = ConvexPolygon::Create(points, 4);
+        ASSERT_EQ(polygon.count, 4);
+        EXPECT_NEAR(polygon.radius, sqrtf(2.0f), 1e-5f);
+        for (int i = 0; i < polygon.count; i++)
+        {
+            // Every vertex of a box around the origin sits on the outer side of its edge
+            EXPECT_GT(Vector2DotProduct(polygon.vertices[i], polygon.normals[i]), 0.0f);
+        }
+    }
+}
+
+TEST(ConvexPolygonTest, SeparatingAxisFollowsRotation) {
+    // Thin bar along x, 20 long and 2 wide
+    const Vector2 bar_points[] = {{-10.0f, -1.0f}, {10.0f, -1.0f}, {10.0f, 1.0f}, {-10.0f, 1.0f}};
+    ConvexPolygon bar = ConvexPolygon::Create(bar_points, 4);
+    WorldPolygon box = WorldPolygon::FromRectangle({-1.0f, 5.0f, 2.0f, 2.0f});
+    EXPECT_FALSE(CheckCollisionPolygons(WorldPolygon::FromPolygon(bar, {0.0f, 0.0f}, 0.0f), box));
+    // Turned a quarter, the bar reaches down to y = 10
+    EXPECT_TRUE(CheckCollisionPolygons(WorldPolygon::FromPolygon(bar, {0.0f, 0.0f}, 90.0f), box));
+
+    WorldPolygon flat = WorldPolygon::FromPolygon(bar, {0.0f, 0.0f}, 0.0f);
+    EXPECT_TRUE(CheckCollisionPolygonCircle(flat, {0.0f, 2.5f}, 2.0f));
+    EXPECT_FALSE(CheckCollisionPolygonCircle(flat, {0.0f, 3.5f}, 2.0f));
+    // Near the corner only the vertex axis separates them
+    EXPECT_FALSE(CheckCollisionPolygonCircle(flat, {11.5f, 2.5f}, 2.0f));
+    EXPECT_TRUE(CheckCollisionPolygonCircle(flat, {11.0f, 2.0f}, 2.0f));
+}
+
+TEST(ConvexPolygonTest, SweptCircleHitsHullInsideTheMove) {
+    ConvexPolygon octagon = ConvexPolygon::CreateRegular(8, 5.0f);
+    WorldPolygon world = WorldPolygon::FromPolygon(octagon, {50.0f, 0.0f}, 0.0f);
+    float time = -1.0f;
+    // The octagon has a vertex at x = 45, its grown sharp corner sits 1 / cos(22.5) further out
+    EXPECT_TRUE(SweptCirclePolygon({0.0f, 0.0f}, {100.0f, 0.0f}, 1.0f, world, time));
+    EXPECT_NEAR(time, (45.0f - 1.0f / cosf(PI / 8.0f)) / 100.0f, 1e-4f);
+    EXPECT_FALSE(SweptCirclePolygon({0.0f, 10.0f}, {100.0f, 10.0f}, 1.0f, world, time));
+    EXPECT_FALSE(SweptCirclePolygon({0.0f, 0.0f}, {30.0f, 0.0f}, 1.0f, world, time));
+}
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include <dynamic_aabb_tree.h>
+#include <math.h>
+#include <algorithm>
+#include <vector>
+
+TEST(DynamicAabbTreeTest, QueryReportsOverlappingItemsOnce) {
+    DynamicAabbTree tree(0.0f);
+    tree.CreateProxy({0.0f, 0.0f, 40.0f, 40.0f}, 0);
+    tree.CreateProxy({100.0f, 100.0f, 4.0f, 4.0f}, 1);
+    int found = 0;
+    tree.Query({-10.0f, -10.0f, 60.0f, 60.0f}, [&](int item) {
+        EXPECT_EQ(item, 0);
+        found++;
+    });
+    EXPECT_EQ(found, 1);
+    found = 0;
+    tree.QueryPoint({102.0f, 102.0f}, [&](int item) {
+        EXPECT_EQ(item, 1);
+        found++;
+    });
+    EXPECT_EQ(found, 1);
+}
+
+TEST(DynamicAabbTreeTest, ProxyIsReinsertedOnlyWhenLeavingItsFatBox) {
+    DynamicAabbTree tree(2.0f, 2.0f);
+    int proxy = tree.CreateProxy({0.0f, 0.0f, 4.0f, 4.0f}, 7);
+    EXPECT_FALSE(tree.MoveProxy(proxy, {1.0f, 0.0f, 4.0f, 4.0f}, {1.0f, 0.0f}));
+    EXPECT_TRUE(tree.MoveProxy(proxy, {10.0f, 0.0f, 4.0f, 4.0f}, {9.0f, 0.0f}));
+    // Stretched ahead along the move
+    Rectangle fat = tree.GetFatBounds(proxy);
+    EXPECT_FLOAT_EQ(fat.x, 8.0f);
+    EXPECT_FLOAT_EQ(fat.x + fat.width, 34.0f);
+    EXPECT_EQ(tree.GetItem(proxy), 7);
+    tree.DestroyProxy(proxy);
+    EXPECT_EQ(tree.GetProxyCount(), 0);
+}
+
+TEST(DynamicAabbTreeTest, StaysBalancedWithMixedSizes) {
+    DynamicAabbTree tree;
+    std::vector<int> proxies;
+    // A row of bullets, asteroids and planets inserted in sorted order, the worst case
+    // for an unbalanced tree
+    const float sizes[3] = {2.0f, 5.0f, 128.0f};
+    const int count = 4096;
+    for (int i = 0; i < count; i++)
+    {
+        float size = sizes[i % 3];
+        proxies.push_back(tree.CreateProxy({i * 10.0f, 0.0f, size, size}, i));
+    }
+    EXPECT_LE(tree.GetHeight(), 2 * static_cast<int>(log2f(static_cast<float>(count))));
+    for (int i = 0; i < count; i += 2)
+    {
+        tree.DestroyProxy(proxies[i]);
+    }
+    EXPECT_EQ(tree.GetProxyCount(), count / 2);
+    EXPECT_LE(tree.GetHeight(), 2 * static_cast<int>(log2f(static_cast<float>(count / 2))));
+    int found = 0;
+    tree.Query({5000.0f, 0.0f, 1.0f, 1.0f}, [&](int item) {
+        EXPECT_EQ(item % 2, 1);
+        found++;
+    });
+    // Planets of 128 reach over about 13 neighbours, only the odd ones are left
+    EXPECT_GT(found, 0);
+}
+
+TEST(DynamicAabbTreeTest, RayCastSkipsBoxesBehindTheClosestHit) {
+    DynamicAabbTree tree(0.0f);
+    for (int i = 0; i < 8; i++)
+    {
+        tree.CreateProxy({20.0f + i * 10.0f, -2.0f, 4.0f, 4.0f}, i);
+    }
+    tree.CreateProxy({50.0f, 40.0f, 4.0f, 4.0f}, 100);
+    DynamicAabbTree::QueryContext context;
+    std::vector<int> visited;
+    tree.RayCast({0.0f, 0.0f}, {200.0f, 0.0f}, context, [&](int item, float) {
+        visited.push_back(item);
+        // Clip at the near side of the box
+        return (20.0f + item * 10.0f) / 200.0f;
+    });
+    ASSERT_FALSE(visited.empty());
+    EXPECT_EQ(*std::min_element(visited.begin(), visited.end()), 0);
+    EXPECT_EQ(std::count(visited.begin(), visited.end(), 100), 0);
+    // Once item 0 clipped the ray, nothing behind it is reported
+    EXPECT_EQ(visited.back(), 0);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <asteroid.h>
+#include <entity_lifecycle.h>
+
+TEST(EntityLifecycleTest, ReleasesAtTheEndOfTheFrameWithinBudget) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    EntityWorld world;
+    EntityLifecycle lifecycle;
+    std::vector<std::shared_ptr<PhysicsObject>> objects;
+    std::vector<Entity> asteroids;
+    for (int i = 0; i < 200; i++)
+    {
+        asteroids.push_back(CreateAsteroid(world, 10.0f, 10.0f, 50.0f, {static_cast<float>(i) * 20.0f, 0.0f}));
+    }
+    for (Entity asteroid : asteroids)
+    {
+        lifecycle.QueueDestroy(world, asteroid);
+        // Asking twice is harmless
+        lifecycle.QueueDestroy(world, asteroid);
+    }
+    EXPECT_EQ(lifecycle.GetPendingCount(), 200);
+    EXPECT_EQ(world.GetCount(), 200);
+    // No budget left: one stride goes, the rest waits for the next frame
+    int released = lifecycle.Flush(world, objects, 0.0);
+    EXPECT_EQ(released, EntityLifecycle::CLOCK_STRIDE);
+    EXPECT_EQ(lifecycle.GetPendingCount(), 200 - released);
+    lifecycle.FlushAll(world, objects);
+    EXPECT_EQ(lifecycle.GetPendingCount(), 0);
+    EXPECT_EQ(lifecycle.GetDestroyedCount(), 200);
+    EXPECT_EQ(world.GetCount(), 0);
+    // Slots are compacted on the next tick
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    EXPECT_EQ(physics.GetBodyCount(), 0);
+    for (Entity asteroid : asteroids)
+    {
+        EXPECT_FALSE(lifecycle.IsPendingDestroy(asteroid));
+    }
+    physics.Unload();
+}
+
+TEST(EntityLifecycleTest, ObjectsLeaveTheirListBySwapAndPop) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    EntityLifecycle lifecycle;
+    EntityWorld world;
+    std::vector<std::shared_ptr<PhysicsObject>> objects;
+    for (int i = 0; i < 3; i++)
+    {
+        objects.push_back(std::make_shared<PhysicsObject>());
+    }
+    std::shared_ptr<PhysicsObject> last = objects[2];
+    lifecycle.QueueDestroy(objects[0]);
+    lifecycle.QueueDestroy(objects[0]);
+    EXPECT_EQ(lifecycle.GetPendingCount(), 1);
+    EXPECT_EQ(lifecycle.Flush(world, objects), 1);
+    ASSERT_EQ(objects.size(), 2u);
+    EXPECT_EQ(objects[0], last);
+    EXPECT_EQ(lifecycle.GetDestroyedCount(), 1);
+}
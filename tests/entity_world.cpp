@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <entity_world.h>
+
+struct TestPosition
+{
+    static constexpr int ID = 0;
+    float x = 0.0f;
+    float y = 0.0f;
+};
+
+struct TestHealth
+{
+    static constexpr int ID = 1;
+    float life = 0.0f;
+};
+
+struct TestTag
+{
+    static constexpr int ID = 2;
+    int value = 0;
+};
+
+TEST(EntityWorldTest, DestroyedEntitiesAreNeverReused) {
+    EntityWorld world;
+    Entity first = world.Create(TestPosition{1.0f, 2.0f});
+    Entity second = world.Create(TestPosition{3.0f, 4.0f});
+    world.Destroy(first);
+    EXPECT_FALSE(world.IsAlive(first));
+    EXPECT_EQ(world.Get<TestPosition>(first), nullptr);
+    // The last row moved into the hole, its entity still finds it
+    ASSERT_NE(world.Get<TestPosition>(second), nullptr);
+    EXPECT_FLOAT_EQ(world.Get<TestPosition>(second)->x, 3.0f);
+    // Same index, new generation
+    Entity third = world.Create(TestPosition{5.0f, 6.0f});
+    EXPECT_EQ(third.index, first.index);
+    EXPECT_NE(third, first);
+    EXPECT_FALSE(world.IsAlive(first));
+    EXPECT_EQ(Entity::FromUserData(third.ToUserData()), third);
+    EXPECT_NE(third.ToUserData(), 0u);
+    EXPECT_EQ(world.GetCount(), 2);
+}
+
+TEST(EntityWorldTest, AddingAComponentMovesTheEntity) {
+    EntityWorld world;
+    Entity entity = world.Create(TestPosition{1.0f, 2.0f});
+    Entity other = world.Create(TestPosition{7.0f, 8.0f});
+    world.Add(entity, TestHealth{50.0f});
+    EXPECT_EQ(world.GetArchetypeCount(), 2);
+    EXPECT_TRUE(world.Has<TestHealth>(entity));
+    EXPECT_FLOAT_EQ(world.Get<TestPosition>(entity)->y, 2.0f);
+    EXPECT_FLOAT_EQ(world.Get<TestHealth>(entity)->life, 50.0f);
+    EXPECT_FLOAT_EQ(world.Get<TestPosition>(other)->x, 7.0f);
+    world.Remove<TestHealth>(entity);
+    EXPECT_FALSE(world.Has<TestHealth>(entity));
+    EXPECT_FLOAT_EQ(world.Get<TestPosition>(entity)->x, 1.0f);
+    // Back in the first archetype, no new one
+    EXPECT_EQ(world.GetArchetypeCount(), 2);
+}
+
+TEST(EntityWorldTest, ForEachVisitsEveryMatchingArchetype) {
+    EntityWorld world;
+    for (int i = 0; i < 10; i++)
+    {
+        world.Create(TestPosition{static_cast<float>(i), 0.0f});
+        world.Create(TestPosition{static_cast<float>(i), 0.0f}, TestHealth{10.0f});
+        world.Create(TestHealth{20.0f}, TestTag{i});
+    }
+    int position_count = 0;
+    int batch_count = 0;
+    world.ForEach<TestPosition>([&](int count, const Entity *entities, TestPosition *positions)
+    {
+        batch_count++;
+        for (int i = 0; i < count; i++)
+        {
+            positions[i].y = 1.0f;
+            EXPECT_TRUE(world.IsAlive(entities[i]));
+        }
+        position_count += count;
+    });
+    EXPECT_EQ(position_count, 20);
+    EXPECT_EQ(batch_count, 2);
+    float life = 0.0f;
+    world.ForEach<TestPosition, TestHealth>([&](int count, const Entity *, TestPosition *positions, TestHealth *healths)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            EXPECT_FLOAT_EQ(positions[i].y, 1.0f);
+            life += healths[i].life;
+        }
+    });
+    EXPECT_FLOAT_EQ(life, 100.0f);
+    world.Clear();
+    EXPECT_EQ(world.GetCount(), 0);
+    int remaining = 0;
+    world.ForEach<TestHealth>([&](int count, const Entity *, TestHealth *) { remaining += count; });
+    EXPECT_EQ(remaining, 0);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include <event_bus.h>
+#include <bullet_pool.h>
+
+TEST(EventBusTest, RingDrainsInOrderAndDropsWhenFull) {
+    EventRing<ScoreEvent, 4> ring;
+    for (int round = 0; round < 3; round++)
+    {
+        // Wraps around the end of the buffer from the second round on
+        for (int i = 0; i < 3; i++)
+        {
+            EXPECT_TRUE(ring.Push(ScoreEvent{PhysicsHandle(), round * 10 + i}));
+        }
+        int expected = round * 10;
+        ring.Drain([&expected](const ScoreEvent &event)
+        {
+            EXPECT_EQ(event.points, expected);
+            expected++;
+        });
+        EXPECT_EQ(expected, round * 10 + 3);
+        EXPECT_EQ(ring.GetCount(), 0u);
+    }
+    for (int i = 0; i < 6; i++)
+    {
+        ring.Push(ScoreEvent{PhysicsHandle(), i});
+    }
+    EXPECT_EQ(ring.GetCount(), 4u);
+    EXPECT_EQ(ring.GetDroppedCount(), 2u);
+}
+
+TEST(EventBusTest, BulletHitsPayTheOwner) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    EventBus &events = EventBus::GetInstance();
+    physics.Unload();
+    events.Clear();
+    BulletPool pool;
+    PhysicsBody owner_body;
+    owner_body.is_alive = true;
+    PhysicsHandle owner = physics.CreatePhysicsObject(owner_body);
+    int index = pool.Acquire();
+    Bullet &bullet = pool.Get(index);
+    bullet.owner = owner;
+    bullet.Fire(WorldSector(), {100.0f, 100.0f}, 0.0f, {1.0f, 0.0f}, 500.0f);
+    PhysicsHandle target = physics.CreatePhysicsObject(owner_body);
+    bullet.OnHit(target, {120.0f, 100.0f});
+    // Spent: a second contact in the same tick pays nothing
+    bullet.OnHit(target, {121.0f, 100.0f});
+    EXPECT_FALSE(bullet.is_enabled);
+    int paid = 0;
+    events.Drain<ScoreEvent>([&](const ScoreEvent &event)
+    {
+        EXPECT_EQ(event.source, owner);
+        paid += event.points;
+    });
+    EXPECT_EQ(paid, Bullet::HIT_SCORE);
+    ASSERT_EQ(events.Get<CollisionEvent>().GetCount(), 1u);
+    events.Drain<CollisionEvent>([&](const CollisionEvent &event)
+    {
+        EXPECT_EQ(event.target, target);
+        // Where the contact was, not where the bullet was fired from
+        EXPECT_FLOAT_EQ(event.position.x, 120.0f);
+    });
+    pool.Release(index);
+    events.Clear();
+    physics.Unload();
+}
+
+TEST(EventBusTest, SpentBulletsTellWhereTheyEnded) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    EventBus &events = EventBus::GetInstance();
+    physics.Unload();
+    events.Clear();
+    BulletPool pool;
+    int index = pool.Acquire();
+    Bullet &bullet = pool.Get(index);
+    bullet.Fire(WorldSector(), {100.0f, 100.0f}, 0.0f, {1.0f, 0.0f}, 500.0f);
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    // Past its 2 s of life
+    bullet.Update(2.5f);
+    EXPECT_FALSE(bullet.is_enabled);
+    ASSERT_EQ(events.Get<EndOfLifeEvent>().GetCount(), 1u);
+    events.Drain<EndOfLifeEvent>([](const EndOfLifeEvent &event)
+    {
+        EXPECT_GT(event.position.x, 100.0f);
+    });
+    pool.Release(index);
+    events.Clear();
+    physics.Unload();
+}
@@ -0,0 +1,20 @@
+#include <gtest/gtest.h>
+#include <fixed_timestep.h>
+
+TEST(FixedTimestepTest, AccumulatesPartialSteps) {
+    FixedTimestep timestep(50.0f, 5);
+    EXPECT_EQ(timestep.Advance(0.015f), 0);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.75f, 1e-4f);
+    EXPECT_EQ(timestep.Advance(0.015f), 1);
+    EXPECT_NEAR(timestep.GetAlpha(), 0.5f, 1e-4f);
+}
+
+TEST(FixedTimestepTest, SlowFrameIsClampedToMaxSteps) {
+    FixedTimestep timestep(30.0f, 4);
+    // One second hitch would be 30 steps, only 4 run and the rest is dropped
+    EXPECT_EQ(timestep.Advance(1.0f), 4);
+    EXPECT_GT(timestep.GetDroppedTime(), 0.8f);
+    EXPECT_LE(timestep.GetAlpha(), 1.0f);
+    // The next normal frame is not punished for the hitch
+    EXPECT_LE(timestep.Advance(1.0f / 144.0f), 1);
+}
@@ -0,0 +1,63 @@
+#include <gtest/gtest.h>
+#include <force_field.h>
+
+TEST(ForceFieldTest, SamplesBlendTheBakedNodes) {
+    ForceField field;
+    // Across the corner of four sectors
+    field.AddSource(ForceSource::Well({0.0f, 0.0f}, 100000.0f, 64.0f, 600.0f));
+    field.Bake();
+    EXPECT_EQ(field.GetSectorCount(), 4);
+    // On a node the sample is the exact pull, with the fade of the reach
+    ForceSample on_node = field.Sample(WorldSector(), -ForceField::CELL_SIZE * 4, 0.0f);
+    float distance = ForceField::CELL_SIZE * 4;
+    float softened = distance * distance + 64.0f * 64.0f;
+    float fade = 1.0f - distance * distance / (600.0f * 600.0f);
+    EXPECT_NEAR(on_node.acceleration_x, 100000.0f * distance * fade * fade / (softened * sqrtf(softened)), 1e-4f);
+    EXPECT_NEAR(on_node.acceleration_y, 0.0f, 1e-6f);
+    // Halfway between two nodes, the mean of both
+    ForceSample next_node = field.Sample(WorldSector(), -ForceField::CELL_SIZE * 3, 0.0f);
+    ForceSample between = field.Sample(WorldSector(), -ForceField::CELL_SIZE * 3.5f, 0.0f);
+    EXPECT_NEAR(between.acceleration_x, (on_node.acceleration_x + next_node.acceleration_x) / 2, 1e-4f);
+    // Both sides of the sector border agree
+    ForceSample left = field.Sample(WorldSector(), -0.001f, 200.0f);
+    ForceSample right = field.Sample(WorldSector(), 0.001f, 200.0f);
+    EXPECT_NEAR(left.acceleration_y, right.acceleration_y, 1e-3f);
+    // Out of reach, and in a sector no source reaches
+    EXPECT_FLOAT_EQ(field.Sample(WorldSector(), 0.0f, 700.0f).acceleration_y, 0.0f);
+    EXPECT_FLOAT_EQ(field.Sample(WorldSector(), 5000.0f, 5000.0f).acceleration_x, 0.0f);
+}
+
+TEST(ForceFieldTest, DragWindAndUniformAcceleration) {
+    ForceField field;
+    field.SetUniformAcceleration(0.0f, 2.0f);
+    field.AddSource(ForceSource::Drag({2048.0f, 0.0f}, 0.5f, 300.0f));
+    field.AddSource(ForceSource::Wind({2048.0f, 0.0f}, {1.0f, 0.0f}, 3.0f, 300.0f));
+    field.Bake();
+    ForceSample center = field.Sample(WorldSector(), 2048.0f, 0.0f);
+    EXPECT_FLOAT_EQ(center.drag, 0.5f);
+    EXPECT_FLOAT_EQ(center.acceleration_x, 3.0f);
+    EXPECT_FLOAT_EQ(center.acceleration_y, 2.0f);
+    ForceSample outside = field.Sample(WorldSector(), 0.0f, 0.0f);
+    EXPECT_FLOAT_EQ(outside.drag, 0.0f);
+    EXPECT_FLOAT_EQ(outside.acceleration_y, 2.0f);
+}
+
+TEST(ForceFieldTest, OnlyTouchedSectorsAreBakedAgain) {
+    ForceField field;
+    int near_id = field.AddSource(ForceSource::Well({100.0f, 100.0f}, 1000.0f, 10.0f, 50.0f));
+    field.AddSource(ForceSource::Well({5000.0f, 5000.0f}, 1000.0f, 10.0f, 50.0f));
+    field.Bake();
+    EXPECT_EQ(field.GetBakeCount(), 2);
+    // Same position, nothing to do
+    field.MoveSource(near_id, {100.0f, 100.0f});
+    EXPECT_TRUE(field.IsBaked());
+    // Within the same sector, only that one
+    field.MoveSource(near_id, {300.0f, 100.0f});
+    field.Bake();
+    EXPECT_EQ(field.GetBakeCount(), 3);
+    EXPECT_GT(field.Sample(WorldSector(), 280.0f, 100.0f).acceleration_x, 0.0f);
+    EXPECT_FLOAT_EQ(field.Sample(WorldSector(), 120.0f, 100.0f).acceleration_x, 0.0f);
+    field.RemoveSource(near_id);
+    field.Bake();
+    EXPECT_FLOAT_EQ(field.Sample(WorldSector(), 280.0f, 100.0f).acceleration_x, 0.0f);
+}
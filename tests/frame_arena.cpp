@@ -0,0 +1,68 @@
+#include <gtest/gtest.h>
+#include <frame_arena.h>
+#include <sprite_batch.h>
+
+TEST(FrameArenaTest, BumpsAlignedAndStartsOverOnReset) {
+    FrameArena arena(1024);
+    char *byte = arena.Allocate<char>(1);
+    double *value = arena.Allocate<double>(4);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(value) % alignof(double), 0u);
+    EXPECT_GT(reinterpret_cast<char *>(value), byte);
+    EXPECT_GE(arena.GetUsed(), 1 + 4 * sizeof(double));
+    arena.Reset();
+    EXPECT_EQ(arena.GetUsed(), 0u);
+    EXPECT_EQ(arena.Allocate<char>(1), byte);
+    EXPECT_EQ(arena.GetHeapAllocationCount(), 1);
+}
+
+TEST(FrameArenaTest, GrowsToTheHighWaterMarkThenStopsAllocating) {
+    FrameArena arena(1024);
+    for (int frame = 0; frame < 4; frame++)
+    {
+        FrameVector<int> values{FrameAllocator<int>(arena)};
+        for (int i = 0; i < 1000; i++)
+        {
+            values.push_back(i);
+        }
+        EXPECT_EQ(values[999], 999);
+        arena.Reset();
+    }
+    // Overflowed on the first frame only, then the block holds a whole frame
+    EXPECT_GE(arena.GetCapacity(), arena.GetHighWater());
+    int allocations = arena.GetHeapAllocationCount();
+    FrameVector<int> values{FrameAllocator<int>(arena)};
+    values.resize(1000);
+    arena.Reset();
+    EXPECT_EQ(arena.GetHeapAllocationCount(), allocations);
+}
+
+TEST(FrameArenaTest, SpriteBatchSortsInTheFrameArena) {
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    FrameArenas &arenas = FrameArenas::GetInstance();
+    registry.Unload();
+    arenas.ResetAll();
+    SpriteHandle sprite = registry.GetOrCreate("arena", 0, []()
+    {
+        return GenImageColor(8, 8, BLANK);
+    });
+    SpriteBatch batch;
+    for (int frame = 0; frame < 3; frame++)
+    {
+        for (int i = 0; i < 5000; i++)
+        {
+            batch.Submit(sprite, {0.0f, 0.0f}, {0.0f, 0.0f}, 0.0f, WHITE, i % 4);
+        }
+        batch.Flush();
+        EXPECT_GT(arenas.GetUsed(), 0u);
+        arenas.ResetAll();
+    }
+    int allocations = arenas.GetHeapAllocationCount();
+    for (int i = 0; i < 5000; i++)
+    {
+        batch.Submit(sprite, {0.0f, 0.0f}, {0.0f, 0.0f}, 0.0f, WHITE, i % 4);
+    }
+    batch.Flush();
+    arenas.ResetAll();
+    EXPECT_EQ(arenas.GetHeapAllocationCount(), allocations);
+    registry.Unload();
+}
@@ -5,4 +5,21 @@
 TEST(GameManagerTest, TestInitialization) {
     GameManager gameManager;
     EXPECT_EQ(gameManager.isGameOver(), false);
-}
\ No newline at end of file
+}
+TEST(GameManagerTest, PlanetPullsAgainAfterAGameOver) {
+    GameManager gameManager;
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    Vector2 center = Vector2Add(gameManager.GetPlanet()->GetPosition(), {64.0f, 64.0f});
+    Vector2 nearby = Vector2Add(center, {200.0f, 0.0f});
+    gameManager.StartGame();
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    float first_pull = physics.SampleForceField(nearby).acceleration_x;
+    EXPECT_LT(first_pull, 0.0f);
+    // What a game over does to the physics world
+    physics.Unload();
+    EXPECT_FLOAT_EQ(physics.SampleForceField(nearby).acceleration_x, 0.0f);
+    gameManager.StartGame();
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    EXPECT_TRUE(physics.IsValid(gameManager.GetPlanet()->physics_id));
+    EXPECT_FLOAT_EQ(physics.SampleForceField(nearby).acceleration_x, first_pull);
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <asteroid.h>
+#include <game_systems.h>
+
+TEST(GameSystemsTest, DamageDestroysTheEntityAndItsBody) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    EntityWorld world;
+    Entity asteroid = CreateAsteroid(world, 100.0f, 10.0f, 50.0f, {100.0f, 100.0f});
+    PhysicsHandle body = world.Get<PhysicsBodyComponent>(asteroid)->handle;
+    EXPECT_EQ(GetBodyEntity(body), asteroid);
+    DamageSystem damage;
+    EntityLifecycle lifecycle;
+    std::vector<std::shared_ptr<PhysicsObject>> objects;
+    EventBus &events = EventBus::GetInstance();
+    events.Clear();
+    events.Push(DamageEvent{PhysicsHandle(), body, 60.0f});
+    damage.Update(world, lifecycle);
+    EXPECT_FLOAT_EQ(world.Get<HealthComponent>(asteroid)->life, 40.0f);
+    // Both hits land, the second one kills
+    events.Push(DamageEvent{PhysicsHandle(), body, 30.0f});
+    events.Push(DamageEvent{PhysicsHandle(), body, 30.0f});
+    damage.Update(world, lifecycle);
+    EXPECT_EQ(events.Get<DeathEvent>().GetCount(), 1u);
+    // Gone once the frame is over
+    EXPECT_TRUE(lifecycle.IsPendingDestroy(asteroid));
+    lifecycle.Flush(world, objects);
+    EXPECT_FALSE(world.IsAlive(asteroid));
+    EXPECT_FALSE(physics.IsValid(body));
+    events.Clear();
+    physics.Unload();
+}
+
+TEST(GameSystemsTest, LifetimesRunOutAndEntitiesFollowTheirBodies) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    EntityWorld world;
+    Entity asteroid = CreateAsteroid(world, 100.0f, 10.0f, 50.0f, {100.0f, 100.0f}, {2, 3});
+    PhysicsHandle body = world.Get<PhysicsBodyComponent>(asteroid)->handle;
+    physics.FixUpdate(0.1f, {0.0f, 0.0f}, {2, 3});
+    BodyLinkSystem body_link;
+    EntityLifecycle lifecycle;
+    std::vector<std::shared_ptr<PhysicsObject>> objects;
+    body_link.Update(world, lifecycle);
+    EXPECT_FALSE(lifecycle.IsPendingDestroy(asteroid));
+    LifetimeSystem lifetime;
+    lifetime.Update(world, ASTEROID_LIFETIME / 2, lifecycle);
+    EXPECT_FALSE(lifecycle.IsPendingDestroy(asteroid));
+    lifetime.Update(world, ASTEROID_LIFETIME / 2, lifecycle);
+    lifecycle.Flush(world, objects);
+    EXPECT_FALSE(world.IsAlive(asteroid));
+    EXPECT_FALSE(physics.IsValid(body));
+    // A body removed behind the entity takes it away on the next pass
+    Entity other = CreateAsteroid(world, 100.0f, 10.0f, 50.0f, {100.0f, 100.0f});
+    physics.RemoveObject(world.Get<PhysicsBodyComponent>(other)->handle);
+    body_link.Update(world, lifecycle);
+    lifecycle.Flush(world, objects);
+    EXPECT_FALSE(world.IsAlive(other));
+    physics.Unload();
+}
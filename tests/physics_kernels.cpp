@@ -0,0 +1,100 @@
+#include <gtest/gtest.h>
+#include <physics_kernels.h>
+#include <physics_body_store.h>
+#include <cstdlib>
+#include <cstring>
+
+static float RandomRange(float min, float max)
+{
+    return min + (max - min) * (static_cast<float>(rand()) / static_cast<float>(RAND_MAX));
+}
+
+// Random bodies covering every branch: dead bodies, resting bodies, over the speed limit,
+// wrapped rotations, torque beyond its limit and field accelerations
+static PhysicsBodyStore CreateRandomStore(int count)
+{
+    srand(7);
+    PhysicsBodyStore store;
+    for (int i = 0; i < count; i++)
+    {
+        PhysicsBody body;
+        body.is_alive = (i % 5) != 0;
+        body.is_applying_torque = (i % 3) == 0;
+        body.is_accelerating = true;
+        body.position = {RandomRange(-1000.0f, 1000.0f), RandomRange(-1000.0f, 1000.0f)};
+        body.velocity = (i % 7) == 0 ? Vector2{0.0f, 0.0f} : Vector2{RandomRange(-200.0f, 200.0f), RandomRange(-200.0f, 200.0f)};
+        body.rotation = RandomRange(-400.0f, 400.0f);
+        body.rotation_torque = (i % 4) == 0 ? 0.0f : RandomRange(-300.0f, 300.0f);
+        body.speed_limit = RandomRange(10.0f, 150.0f);
+        body.deceleration_multiplier = RandomRange(0.0f, 1.0f);
+        body.rotation_speed_limit = RandomRange(10.0f, 250.0f);
+        store.PushBack(body);
+        store.acceleration_x.back() = RandomRange(-5.0f, 5.0f);
+        store.acceleration_y.back() = (i % 6) == 0 ? 0.0f : RandomRange(-5.0f, 5.0f);
+    }
+    return store;
+}
+
+static bool SameBits(const std::vector<float> &a, const std::vector<float> &b)
+{
+    return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+}
+
+TEST(PhysicsKernelsTest, IntegrationMatchesScalarBitForBit) {
+    const int count = 1003; // not a multiple of any lane width
+    for (SimdPath path : {SimdPath::SSE2, SimdPath::AVX2, SimdPath::WasmSimd128})
+    {
+        if (!IsSimdPathSupported(path))
+            continue;
+        PhysicsBodyStore expected = CreateRandomStore(count);
+        PhysicsBodyStore actual = CreateRandomStore(count);
+        for (int tick = 0; tick < 10; tick++)
+        {
+            GetPhysicsKernels(SimdPath::Scalar).integrate(expected.GetIntegrationStreams(), 0, count, 0.02f);
+            GetPhysicsKernels(path).integrate(actual.GetIntegrationStreams(), 0, count, 0.02f);
+        }
+        SCOPED_TRACE(GetPhysicsKernels(path).name);
+        EXPECT_TRUE(SameBits(expected.position_x, actual.position_x));
+        EXPECT_TRUE(SameBits(expected.position_y, actual.position_y));
+        EXPECT_TRUE(SameBits(expected.velocity_x, actual.velocity_x));
+        EXPECT_TRUE(SameBits(expected.velocity_y, actual.velocity_y));
+        EXPECT_TRUE(SameBits(expected.rotation, actual.rotation));
+        EXPECT_TRUE(SameBits(expected.rotation_torque, actual.rotation_torque));
+        EXPECT_EQ(expected.flags, actual.flags);
+    }
+}
+
+TEST(PhysicsKernelsTest, NarrowphaseMatchesScalar) {
+    srand(11);
+    const int count = 67;
+    std::vector<float> x(count), y(count), radius(count), width(count), height(count);
+    for (int i = 0; i < count; i++)
+    {
+        x[i] = RandomRange(-40.0f, 40.0f);
+        y[i] = RandomRange(-40.0f, 40.0f);
+        radius[i] = RandomRange(1.0f, 10.0f);
+        width[i] = RandomRange(1.0f, 30.0f);
+        height[i] = RandomRange(1.0f, 30.0f);
+    }
+    std::vector<uint8_t> expected(count), actual(count);
+    const PhysicsKernels &scalar = GetPhysicsKernels(SimdPath::Scalar);
+    for (int i = 0; i < count; i++)
+    {
+        // The scalar kernels follow raylib's collision tests
+        scalar.circle_circle(3.0f, -2.0f, 8.0f, &x[i], &y[i], &radius[i], 1, &expected[i]);
+        EXPECT_EQ(expected[i] != 0, CheckCollisionCircles({3.0f, -2.0f}, 8.0f, {x[i], y[i]}, radius[i]));
+        scalar.circle_rect(3.0f, -2.0f, 8.0f, &x[i], &y[i], &width[i], &height[i], 1, &actual[i]);
+        EXPECT_EQ(actual[i] != 0, CheckCollisionCircleRec({3.0f, -2.0f}, 8.0f, {x[i], y[i], width[i], height[i]}));
+    }
+    for (SimdPath path : {SimdPath::SSE2, SimdPath::AVX2, SimdPath::WasmSimd128})
+    {
+        if (!IsSimdPathSupported(path))
+            continue;
+        scalar.circle_circle(3.0f, -2.0f, 8.0f, x.data(), y.data(), radius.data(), count, expected.data());
+        GetPhysicsKernels(path).circle_circle(3.0f, -2.0f, 8.0f, x.data(), y.data(), radius.data(), count, actual.data());
+        EXPECT_EQ(expected, actual);
+        scalar.circle_rect(3.0f, -2.0f, 8.0f, x.data(), y.data(), width.data(), height.data(), count, expected.data());
+        GetPhysicsKernels(path).circle_rect(3.0f, -2.0f, 8.0f, x.data(), y.data(), width.data(), height.data(), count, actual.data());
+        EXPECT_EQ(expected, actual);
+    }
+}
@@ -0,0 +1,443 @@
+#include <gtest/gtest.h>
+#include <physics_system.h>
+#include <utility>
+
+// Records every collision it is notified about
+class CollisionRecorder : public PhysicsObject
+{
+public:
+    std::vector<std::pair<int, int>> *log = nullptr;
+
+    static std::shared_ptr<CollisionRecorder> Create(int in_id, Vector2 in_position, std::vector<std::pair<int, int>> *in_log)
+    {
+        std::shared_ptr<CollisionRecorder> obj = std::make_shared<CollisionRecorder>();
+        obj->id = in_id;
+        obj->position = in_position;
+        obj->width = 10.0f;
+        obj->height = 10.0f;
+        obj->object_type = ObjectType::ASTEROID_TYPE;
+        obj->log = in_log;
+        obj->physics_id = CreatePhysicsId(obj);
+        return obj;
+    }
+    void EnterCollision(std::shared_ptr<PhysicsObject> other) override
+    {
+        log->push_back({id, other ? other->id : -1});
+    }
+};
+
+static PhysicsHandle CreateTestBody(ObjectType type, Vector2 position, float size)
+{
+    PhysicsBody body;
+    body.is_alive = true;
+    body.type = type;
+    body.position = position;
+    body.width = size;
+    body.height = size;
+    body.speed_limit = 100.0f;
+    return PhysicsSystem::GetInstance().CreatePhysicsObject(body);
+}
+
+TEST(PhysicsSystemTest, OnlyNearbyBodiesAreCandidates) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    // Two asteroids overlapping and one far away, all on screen
+    CreateTestBody(ObjectType::ASTEROID_TYPE, {100.0f, 100.0f}, 10.0f);
+    CreateTestBody(ObjectType::ASTEROID_TYPE, {104.0f, 100.0f}, 10.0f);
+    CreateTestBody(ObjectType::ASTEROID_TYPE, {500.0f, 300.0f}, 10.0f);
+    physics.FixUpdate(0.02f, {0.0f, 0.0f});
+    EXPECT_EQ(physics.GetCandidatePairCount(), 1);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, BodyStreamsRoundTrip) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsHandle id = CreateTestBody(ObjectType::ASTEROID_TYPE, {10.0f, 20.0f}, 4.0f);
+    physics.ApplyForce(id, 10.0f, {1.0f, 0.0f});
+    physics.ApplyTorque(id, -5.0f);
+    PhysicsBody body = physics.GetPhysicsObject(id);
+    EXPECT_TRUE(body.is_alive);
+    EXPECT_TRUE(body.is_accelerating);
+    EXPECT_TRUE(body.is_rotating_left);
+    EXPECT_FALSE(body.is_rotating_right);
+    EXPECT_FLOAT_EQ(body.velocity.x, 10.0f);
+    EXPECT_FLOAT_EQ(body.rotation_torque, -5.0f);
+    EXPECT_FLOAT_EQ(body.position.y, 20.0f);
+    physics.RemoveObject(id);
+    EXPECT_FALSE(physics.GetPhysicsObject(id).is_alive);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, StaleHandleIsDetectedAfterSlotReuse) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsHandle first = CreateTestBody(ObjectType::ASTEROID_TYPE, {10.0f, 10.0f}, 4.0f);
+    PhysicsHandle second = CreateTestBody(ObjectType::ASTEROID_TYPE, {50.0f, 50.0f}, 4.0f);
+    physics.RemoveObject(first);
+    EXPECT_FALSE(physics.IsValid(first));
+    // Compaction moves the second body into the hole, its handle still resolves
+    physics.FixUpdate(0.02f, {0.0f, 0.0f});
+    EXPECT_EQ(physics.GetBodyCount(), 1);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(second).position.x, 50.0f);
+    // The freed slot is reused with a new generation
+    PhysicsHandle third = CreateTestBody(ObjectType::ASTEROID_TYPE, {90.0f, 90.0f}, 4.0f);
+    EXPECT_EQ(third.index, first.index);
+    EXPECT_NE(third.generation, first.generation);
+    int stale_before = physics.GetStaleHandleAccessCount();
+    physics.ApplyForce(first, 10.0f, {1.0f, 0.0f});
+    EXPECT_FALSE(physics.GetPhysicsObject(first).is_alive);
+    EXPECT_EQ(physics.GetStaleHandleAccessCount(), stale_before + 2);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(third).velocity.x, 0.0f);
+    physics.Unload();
+    EXPECT_FALSE(physics.IsValid(second));
+    EXPECT_FALSE(physics.IsValid(third));
+}
+
+TEST(PhysicsSystemTest, RenderStateInterpolatesBetweenTicks) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsHandle id = CreateTestBody(ObjectType::ASTEROID_TYPE, {0.0f, 0.0f}, 4.0f);
+    physics.ApplyForce(id, 50.0f, {1.0f, 0.0f});
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    float current_x = physics.GetPhysicsObject(id).position.x;
+    EXPECT_GT(current_x, 0.0f);
+    EXPECT_FLOAT_EQ(physics.GetInterpolatedPhysicsObject(id, 0.0f).position.x, 0.0f);
+    EXPECT_FLOAT_EQ(physics.GetInterpolatedPhysicsObject(id, 0.5f).position.x, current_x * 0.5f);
+    EXPECT_FLOAT_EQ(physics.GetInterpolatedPhysicsObject(id, 1.0f).position.x, current_x);
+    physics.Unload();
+}
+
+static std::vector<std::pair<int, int>> RecordCollisions(int thread_count)
+{
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    physics.SetThreadCount(thread_count);
+    std::vector<std::pair<int, int>> log;
+    std::vector<std::shared_ptr<CollisionRecorder>> objects;
+    for (int i = 0; i < 3000; i++)
+    {
+        // Dense on screen field, enough bodies to be split in several chunks
+        objects.push_back(CollisionRecorder::Create(i, {static_cast<float>((i * 37) % 620), static_cast<float>((i * 53) % 340)}, &log));
+    }
+    physics.FixUpdate(0.02f, {0.0f, 0.0f});
+    physics.Unload();
+    return log;
+}
+
+TEST(PhysicsSystemTest, CollisionsDoNotDependOnThreadCount) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    int default_thread_count = physics.GetThreadCount();
+    std::vector<std::pair<int, int>> single_thread = RecordCollisions(1);
+    std::vector<std::pair<int, int>> multi_thread = RecordCollisions(4);
+    physics.SetThreadCount(default_thread_count);
+    EXPECT_FALSE(single_thread.empty());
+    EXPECT_EQ(single_thread, multi_thread);
+}
+
+TEST(PhysicsSystemTest, ContactHandlerReceivesTypePairInBulk) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsHandle left = CreateTestBody(ObjectType::ASTEROID_TYPE, {100.0f, 100.0f}, 10.0f);
+    PhysicsHandle right = CreateTestBody(ObjectType::ASTEROID_TYPE, {106.0f, 100.0f}, 10.0f);
+    CreateTestBody(ObjectType::ASTEROID_TYPE, {300.0f, 100.0f}, 10.0f);
+    int calls = 0;
+    std::vector<PhysicsContact> received;
+    physics.SetContactHandler(ObjectType::ASTEROID_TYPE, ObjectType::ASTEROID_TYPE, [&](const PhysicsContact *contacts, int count)
+    {
+        calls++;
+        received.assign(contacts, contacts + count);
+        // Removing from a handler is safe, compaction waits for the next tick
+        for (int i = 0; i < count; i++)
+            physics.RemoveObject(contacts[i].handle_a);
+    });
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    physics.SetContactHandler(ObjectType::ASTEROID_TYPE, ObjectType::ASTEROID_TYPE, nullptr);
+    ASSERT_EQ(calls, 1);
+    ASSERT_EQ(received.size(), 1u);
+    EXPECT_EQ(received[0].handle_a, left);
+    EXPECT_EQ(received[0].handle_b, right);
+    EXPECT_FLOAT_EQ(received[0].normal.x, 1.0f);
+    EXPECT_FLOAT_EQ(received[0].point.x, 105.0f);
+    EXPECT_FALSE(physics.IsValid(left));
+    EXPECT_TRUE(physics.IsValid(right));
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, FastBulletDoesNotTunnel) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsBody bullet;
+    bullet.is_alive = true;
+    bullet.type = ObjectType::BULLET_TYPE;
+    bullet.position = {10.0f, 100.0f};
+    bullet.width = 2.0f;
+    bullet.height = 2.0f;
+    bullet.speed_limit = 500.0f;
+    bullet.is_fast = true;
+    PhysicsHandle bullet_id = physics.CreatePhysicsObject(bullet);
+    PhysicsHandle asteroid_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {40.0f, 100.0f}, 6.0f);
+    // 500 units/s at 10 Hz: 50 units per tick, the bullet ends well past the asteroid
+    physics.ApplyForce(bullet_id, 500.0f, {1.0f, 0.0f});
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    EXPECT_GT(physics.GetPhysicsObject(bullet_id).position.x, 55.0f);
+    ASSERT_EQ(physics.GetContacts().size(), 1u);
+    const PhysicsContact &contact = physics.GetContacts()[0];
+    EXPECT_EQ(contact.handle_a, bullet_id);
+    EXPECT_EQ(contact.handle_b, asteroid_id);
+    EXPECT_NEAR(contact.point.x, 37.0f, 1e-3f);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, FarBodiesCatchUpWhenBackInRange) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    physics.SetSimulationLod(1000.0f, 3000.0f, 4);
+    PhysicsHandle near_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {100.0f, 100.0f}, 4.0f);
+    PhysicsHandle mid_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {2000.0f, 0.0f}, 4.0f);
+    PhysicsHandle far_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {10000.0f, 0.0f}, 4.0f);
+    physics.ApplyForce(far_id, 10.0f, {1.0f, 0.0f});
+    // Every body is classified within one LOD interval
+    for (int i = 0; i < 4; i++)
+    {
+        physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    }
+    float frozen_x = physics.GetPhysicsObject(far_id).position.x;
+    for (int i = 0; i < 6; i++)
+    {
+        physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    }
+    EXPECT_EQ(physics.GetTierCount(SIM_TIER_NEAR), 1);
+    EXPECT_EQ(physics.GetTierCount(SIM_TIER_MID), 1);
+    EXPECT_EQ(physics.GetTierCount(SIM_TIER_FAR), 1);
+    EXPECT_TRUE(physics.IsValid(near_id));
+    EXPECT_TRUE(physics.IsValid(mid_id));
+    // Far body is not integrated while far
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(far_id).position.x, frozen_x);
+    // Move the view next to it, the skipped second is caught up at once on its next
+    // due tick (within the LOD interval)
+    for (int i = 0; i < 4; i++)
+    {
+        physics.FixUpdate(0.0f, {9700.0f, -180.0f});
+    }
+    EXPECT_EQ(physics.GetTierCount(SIM_TIER_NEAR), 1);
+    PhysicsBody far_body = physics.GetPhysicsObject(far_id);
+    EXPECT_NEAR((WorldPosition{far_body.sector, far_body.position}.RelativeTo({}).x), 10010.0f, 1e-2f);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, PolygonHullFollowsBodyRotation) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    // Asteroid shaped as a bar 40 long and 4 wide, the player sits 15 below its center
+    const Vector2 bar_points[] = {{-20.0f, -2.0f}, {20.0f, -2.0f}, {20.0f, 2.0f}, {-20.0f, 2.0f}};
+    PhysicsBody bar;
+    bar.is_alive = true;
+    bar.type = ObjectType::ASTEROID_TYPE;
+    bar.position = {100.0f, 100.0f};
+    bar.collision = ObjectShape::Polygon;
+    bar.polygon = ConvexPolygon::Create(bar_points, 4);
+    PhysicsHandle bar_id = physics.CreatePhysicsObject(bar);
+    PhysicsHandle player_id = CreateTestBody(ObjectType::PLAYER_TYPE, {100.0f, 115.0f}, 6.0f);
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    EXPECT_EQ(physics.GetCandidatePairCount(), 1);
+    EXPECT_TRUE(physics.GetContacts().empty());
+    physics.SetTransform(bar_id, {100.0f, 100.0f}, 90.0f);
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    ASSERT_EQ(physics.GetContacts().size(), 1u);
+    EXPECT_EQ(physics.GetContacts()[0].handle_a, bar_id);
+    EXPECT_EQ(physics.GetContacts()[0].handle_b, player_id);
+    EXPECT_EQ(physics.GetPhysicsObject(bar_id).polygon.count, 4);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, StaticBodiesOnlyPairWithMovingOnes) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    // Two overlapping planets and a small asteroid touching the first one
+    PhysicsBody planet;
+    planet.is_alive = true;
+    planet.is_static = true;
+    planet.type = ObjectType::ASTEROID_TYPE;
+    planet.collision = ObjectShape::Rectangle;
+    planet.width = 128.0f;
+    planet.height = 128.0f;
+    planet.position = {100.0f, 100.0f};
+    PhysicsHandle planet_id = physics.CreatePhysicsObject(planet);
+    planet.position = {200.0f, 100.0f};
+    physics.CreatePhysicsObject(planet);
+    PhysicsHandle asteroid_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {98.0f, 160.0f}, 5.0f);
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    EXPECT_EQ(physics.GetCandidatePairCount(), 1);
+    ASSERT_EQ(physics.GetContacts().size(), 1u);
+    EXPECT_EQ(physics.GetContacts()[0].handle_a, planet_id);
+    EXPECT_EQ(physics.GetContacts()[0].handle_b, asteroid_id);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, RaycastReturnsClosestFilteredBody) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsHandle player_id = CreateTestBody(ObjectType::PLAYER_TYPE, {50.0f, 100.0f}, 10.0f);
+    PhysicsHandle near_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {100.0f, 100.0f}, 10.0f);
+    CreateTestBody(ObjectType::ASTEROID_TYPE, {150.0f, 100.0f}, 10.0f);
+    // Broadphase trees are filled by the tick
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    QueryFilter filter;
+    RaycastHit hit;
+    ASSERT_TRUE(physics.Raycast({0.0f, 100.0f}, {300.0f, 100.0f}, filter, hit));
+    EXPECT_EQ(hit.handle, player_id);
+    filter.ignore = player_id;
+    ASSERT_TRUE(physics.Raycast({0.0f, 100.0f}, {300.0f, 100.0f}, filter, hit));
+    EXPECT_EQ(hit.handle, near_id);
+    EXPECT_NEAR(hit.point.x, 95.0f, 1e-3f);
+    EXPECT_NEAR(hit.distance, 95.0f, 1e-3f);
+    EXPECT_NEAR(hit.normal.x, -1.0f, 1e-5f);
+    filter.type_mask = ObjectTypeBit(ObjectType::BULLET_TYPE);
+    EXPECT_FALSE(physics.Raycast({0.0f, 100.0f}, {300.0f, 100.0f}, filter, hit));
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, OverlapQueriesFillCallerBuffers) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    for (int i = 0; i < 5; i++)
+    {
+        CreateTestBody(ObjectType::ASTEROID_TYPE, {100.0f + i * 20.0f, 100.0f}, 4.0f);
+    }
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    QueryFilter filter;
+    PhysicsHandle results[8];
+    EXPECT_EQ(physics.OverlapCircle({140.0f, 100.0f}, 21.0f, filter, results, 8), 3);
+    EXPECT_EQ(physics.OverlapCircle({140.0f, 100.0f}, 100.0f, filter, results, 2), 2);
+    EXPECT_EQ(physics.OverlapAABB({110.0f, 90.0f, 40.0f, 20.0f}, filter, results, 8), 2);
+    filter.layer_mask = 2;
+    EXPECT_EQ(physics.OverlapAABB({0.0f, 0.0f, 400.0f, 400.0f}, filter, results, 8), 0);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, KNearestSortsByDistance) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsHandle handles[5];
+    const float xs[5] = {160.0f, 110.0f, 190.0f, 130.0f, 400.0f};
+    for (int i = 0; i < 5; i++)
+    {
+        handles[i] = CreateTestBody(ObjectType::ASTEROID_TYPE, {xs[i], 100.0f}, 4.0f);
+    }
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    PhysicsHandle results[3];
+    float distances[3];
+    int count = physics.KNearest({100.0f, 100.0f}, 200.0f, QueryFilter(), 3, results, distances);
+    ASSERT_EQ(count, 3);
+    EXPECT_EQ(results[0], handles[1]);
+    EXPECT_EQ(results[1], handles[3]);
+    EXPECT_EQ(results[2], handles[0]);
+    EXPECT_FLOAT_EQ(distances[0], 10.0f);
+    EXPECT_FLOAT_EQ(distances[2], 60.0f);
+    // Closest ones are 90 and 100 away
+    EXPECT_EQ(physics.KNearest({300.0f, 100.0f}, 50.0f, QueryFilter(), 3, results, distances), 0);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, NBodyGravityPullsBodiesTogether) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    physics.SetNBodyGravity(true, 100.0f);
+    PhysicsBody heavy;
+    heavy.is_alive = true;
+    heavy.type = ObjectType::ASTEROID_TYPE;
+    heavy.position = {100.0f, 100.0f};
+    heavy.width = 20.0f;
+    heavy.mass = 1000.0f;
+    heavy.speed_limit = 100.0f;
+    PhysicsHandle heavy_id = physics.CreatePhysicsObject(heavy);
+    // Static bodies pull through the force field, not the tree
+    heavy.position = {100.0f, 300.0f};
+    heavy.is_static = true;
+    PhysicsHandle static_id = physics.CreatePhysicsObject(heavy);
+    PhysicsHandle left_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {0.0f, 100.0f}, 4.0f);
+    PhysicsHandle bullet_id = CreateTestBody(ObjectType::BULLET_TYPE, {200.0f, 100.0f}, 4.0f);
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    physics.SetNBodyGravity(false);
+    // Pulled towards each other, bullets ignore gravity
+    EXPECT_GT(physics.GetPhysicsObject(left_id).velocity.x, 0.0f);
+    EXPECT_LT(physics.GetPhysicsObject(heavy_id).velocity.x, 0.0f);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(left_id).velocity.y, 0.0f);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(static_id).velocity.y, 0.0f);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(bullet_id).velocity.x, 0.0f);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, ForceSourcesFollowTheirBody) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    PhysicsBody planet;
+    planet.is_alive = true;
+    planet.is_static = true;
+    planet.type = ObjectType::ASTEROID_TYPE;
+    planet.position = {300.0f, 200.0f};
+    planet.width = 40.0f;
+    planet.speed_limit = 100.0f;
+    PhysicsHandle planet_id = physics.CreatePhysicsObject(planet);
+    physics.AddForceSource(ForceSource::Well({300.0f, 200.0f}, 100000.0f, 20.0f, 500.0f), planet_id);
+    PhysicsHandle left_id = CreateTestBody(ObjectType::ASTEROID_TYPE, {100.0f, 200.0f}, 4.0f);
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    EXPECT_GT(physics.GetPhysicsObject(left_id).velocity.x, 0.0f);
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(planet_id).velocity.x, 0.0f);
+    // Nothing moved, nothing is baked again
+    int bake_count = physics.GetForceField().GetBakeCount();
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    EXPECT_EQ(physics.GetForceField().GetBakeCount(), bake_count);
+    // The well moves with the planet, then goes away with it
+    physics.SetTransform(planet_id, {600.0f, 200.0f}, 0.0f);
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    EXPECT_GT(physics.GetForceField().GetBakeCount(), bake_count);
+    EXPECT_GT(physics.SampleForceField({500.0f, 200.0f}).acceleration_x, 0.0f);
+    physics.RemoveObject(planet_id);
+    physics.FixUpdate(0.1f, {0.0f, 0.0f});
+    EXPECT_FLOAT_EQ(physics.SampleForceField({500.0f, 200.0f}).acceleration_x, 0.0f);
+    physics.Unload();
+}
+
+TEST(PhysicsSystemTest, FarSectorsKeepPrecisionAndContacts) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    // Seen from the origin first, the bodies would be deferred as far ones
+    physics.SetSimulationLodEnabled(false);
+    // A billion units from the origin, touching across a sector border
+    const WorldSector far_sector = {1000000, 1000000};
+    PhysicsBody body;
+    body.is_alive = true;
+    body.type = ObjectType::ASTEROID_TYPE;
+    body.width = 10.0f;
+    body.height = 10.0f;
+    body.speed_limit = 100.0f;
+    body.sector = far_sector;
+    body.position = {WORLD_SECTOR_SIZE - 6.0f, 100.0f};
+    PhysicsHandle left_id = physics.CreatePhysicsObject(body);
+    body.position = {WORLD_SECTOR_SIZE + 1.0f, 100.0f};
+    PhysicsHandle right_id = physics.CreatePhysicsObject(body);
+    EXPECT_EQ(physics.GetPhysicsObject(right_id).sector, WorldSector({far_sector.x + 1, far_sector.y}));
+    EXPECT_FLOAT_EQ(physics.GetPhysicsObject(right_id).position.x, 1.0f);
+    // Off screen from the origin
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    EXPECT_TRUE(physics.GetContacts().empty());
+    // Viewed from their sector, then from the next one with the trees moved along
+    physics.FixUpdate(0.0f, {500.0f, 0.0f}, far_sector);
+    ASSERT_EQ(physics.GetContacts().size(), 1u);
+    physics.FixUpdate(0.0f, {-524.0f, 0.0f}, {far_sector.x + 1, far_sector.y});
+    ASSERT_EQ(physics.GetContacts().size(), 1u);
+    EXPECT_EQ(physics.GetFrameSector(), WorldSector({far_sector.x + 1, far_sector.y}));
+    // Small steps are not lost, and the body is carried to the next sector
+    physics.RemoveObject(right_id);
+    physics.ApplyForce(left_id, 100.0f, {1.0f, 0.0f});
+    physics.FixUpdate(0.1f, {-524.0f, 0.0f}, {far_sector.x + 1, far_sector.y});
+    PhysicsBody moved = physics.GetPhysicsObject(left_id);
+    EXPECT_EQ(moved.sector, WorldSector({far_sector.x + 1, far_sector.y}));
+    EXPECT_NEAR((WorldPosition{moved.sector, moved.position}.RelativeTo(far_sector).x), WORLD_SECTOR_SIZE + 4.0f, 1e-3f);
+    // Interpolation starts from where it was, not from the other side of the sector
+    EXPECT_NEAR(physics.GetInterpolatedPhysicsObject(left_id, 0.0f).position.x, -6.0f, 1e-3f);
+    physics.SetSimulationLodEnabled(true);
+    physics.Unload();
+}
@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <asteroid.h>
+#include <render_snapshot.h>
+
+TEST(RenderSnapshotTest, PublishesBodiesWithASpriteEveryTick) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    EntityWorld world;
+    Entity asteroid = CreateAsteroid(world, 100.0f, 10.0f, 50.0f, {100.0f, 100.0f}, {2, 3});
+    PhysicsHandle body = world.Get<PhysicsBodyComponent>(asteroid)->handle;
+    // Simulated but never drawn
+    PhysicsBody plain;
+    plain.is_alive = true;
+    physics.CreatePhysicsObject(plain);
+    physics.ApplyForce(body, 10.0f, {1.0f, 0.0f});
+    physics.FixUpdate(0.1f, {0.0f, 0.0f}, {2, 3});
+    const RenderSnapshot &snapshot = physics.GetRenderSnapshot();
+    ASSERT_EQ(snapshot.GetCount(), 1);
+    const RenderProxy *proxy = snapshot.Find(body);
+    ASSERT_NE(proxy, nullptr);
+    PhysicsBody state = physics.GetPhysicsObject(body);
+    EXPECT_EQ(proxy->sector, WorldSector({2, 3}));
+    EXPECT_FLOAT_EQ(proxy->position.x, state.position.x);
+    EXPECT_GT(proxy->position.x, 100.0f);
+    EXPECT_TRUE(proxy->is_on_screen);
+    EXPECT_EQ(proxy->sprite.layer, RENDER_LAYER_ASTEROID);
+    // Blended like the interpolated body, relative to any sector
+    PhysicsBody halfway = physics.GetInterpolatedPhysicsObject(body, 0.5f);
+    EXPECT_FLOAT_EQ(proxy->GetPosition(0.5f, {2, 3}).x, halfway.position.x);
+    EXPECT_FLOAT_EQ(proxy->GetPosition(0.0f, {1, 3}).x, 100.0f + WORLD_SECTOR_SIZE);
+    // The snapshot is what the tick left, a removed body leaves it on the next tick
+    physics.RemoveObject(body);
+    EXPECT_NE(snapshot.Find(body), nullptr);
+    physics.FixUpdate(0.1f, {0.0f, 0.0f}, {2, 3});
+    EXPECT_EQ(snapshot.GetCount(), 0);
+    EXPECT_EQ(snapshot.Find(body), nullptr);
+    physics.Unload();
+}
+
+TEST(RenderSnapshotTest, RendersOnlyWhatIsOnScreen) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    physics.Unload();
+    EntityWorld world;
+    for (int i = 0; i < 10; i++)
+    {
+        CreateAsteroid(world, 100.0f, 10.0f, 50.0f, {10.0f * i, 100.0f});
+    }
+    // Far out of view
+    CreateAsteroid(world, 100.0f, 10.0f, 50.0f, {100.0f, 100.0f}, {50, 50});
+    physics.FixUpdate(0.0f, {0.0f, 0.0f});
+    const RenderSnapshot &snapshot = physics.GetRenderSnapshot();
+    EXPECT_EQ(snapshot.GetCount(), 11);
+    SpriteBatch batch;
+    snapshot.Render(1.0f, WorldSector(), batch);
+    ASSERT_EQ(batch.GetInstances().size(), 10u);
+    EXPECT_FLOAT_EQ(batch.GetInstances()[3].position.x, 30.0f);
+    EXPECT_EQ(batch.GetInstances()[3].layer, RENDER_LAYER_ASTEROID);
+    physics.Unload();
+    EXPECT_EQ(snapshot.GetCount(), 0);
+}
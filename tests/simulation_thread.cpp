@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <simulation_thread.h>
+#include <thread>
+
+TEST(SimulationThreadTest, SpscQueueKeepsOrderAcrossThreads) {
+    static SpscQueue<int, 64> queue;
+    // Enough to wrap the ring many times, small enough for a single core runner
+    const int count = 4096;
+    std::thread producer([count]()
+    {
+        for (int i = 0; i < count; i++)
+        {
+            // Full: the consumer catches up, nothing is waited on inside the queue
+            while (!queue.Push(i))
+                std::this_thread::yield();
+        }
+    });
+    int expected = 0;
+    while (expected < count)
+    {
+        // Empty: let the producer run instead of spinning
+        if (queue.Drain([&expected](const int &item)
+        {
+            EXPECT_EQ(item, expected);
+            expected++;
+        }) == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    // Single threaded, a full queue drops
+    SpscQueue<int, 4> small;
+    for (int i = 0; i < 6; i++)
+        small.Push(i);
+    EXPECT_EQ(small.GetDroppedCount(), 2u);
+    int item = -1;
+    EXPECT_TRUE(small.Pop(item));
+    EXPECT_EQ(item, 0);
+}
+
+TEST(SimulationThreadTest, TripleBufferHandsOverWholeStates) {
+    struct State
+    {
+        int first = 0;
+        int second = 0;
+    };
+    static TripleBuffer<State> states;
+    const int count = 4096;
+    std::thread writer([count]()
+    {
+        for (int i = 1; i <= count; i++)
+        {
+            State &state = states.GetWriteBuffer();
+            state.first = i;
+            state.second = i;
+            states.Publish();
+        }
+    });
+    int last = 0;
+    while (last < count)
+    {
+        const State &state = states.Read();
+        // Never half written, never older than what was read before
+        EXPECT_EQ(state.first, state.second);
+        EXPECT_GE(state.first, last);
+        last = state.first;
+        std::this_thread::yield();
+    }
+    writer.join();
+    EXPECT_FALSE(states.HasNew());
+    EXPECT_EQ(states.Read().first, count);
+}
+
+TEST(SimulationThreadTest, StepsUntilTheStepFunctionStops) {
+    struct Counter
+    {
+        int steps = 0;
+        float step = 0.0f;
+    } counter;
+    SimulationThread simulation;
+    EXPECT_FALSE(simulation.IsStarted());
+    ASSERT_TRUE(simulation.Start(FixedTimestep(1000.0f, 5), [](void *context, float step)
+    {
+        Counter *counter = static_cast<Counter *>(context);
+        counter->step = step;
+        return ++counter->steps < 20;
+    }, &counter));
+    EXPECT_TRUE(simulation.IsStarted());
+    while (simulation.IsRunning())
+        std::this_thread::yield();
+    // Stopped by the step function, still to be joined
+    EXPECT_TRUE(simulation.IsStarted());
+    simulation.Stop();
+    EXPECT_FALSE(simulation.IsStarted());
+    EXPECT_EQ(counter.steps, 20);
+    EXPECT_EQ(simulation.GetStepCount(), 20);
+    EXPECT_FLOAT_EQ(counter.step, 0.001f);
+}
@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+#include <sprite_batch.h>
+
+TEST(SpriteBatchTest, SortsByLayerKeepingSubmitOrder) {
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    registry.Unload();
+    SpriteHandle sprite = registry.GetOrCreate("batched", 0, []()
+    {
+        return GenImageColor(8, 8, BLANK);
+    });
+    SpriteBatch batch;
+    const int layers[] = {RENDER_LAYER_PLAYER, RENDER_LAYER_PLANET, RENDER_LAYER_BULLET, RENDER_LAYER_PLANET, RENDER_LAYER_ASTEROID};
+    for (int i = 0; i < 5; i++)
+    {
+        batch.Submit(sprite, {static_cast<float>(i), 0.0f}, {0.0f, 0.0f}, 0.0f, WHITE, layers[i]);
+    }
+    batch.Sort();
+    const float expected_x[] = {1.0f, 3.0f, 4.0f, 2.0f, 0.0f};
+    for (size_t i = 0; i < 5; i++)
+    {
+        EXPECT_FLOAT_EQ(batch.GetSorted(i).position.x, expected_x[i]);
+    }
+    registry.Unload();
+}
+
+TEST(SpriteBatchTest, DrawsStayFlatAsSpritesGrow) {
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    registry.Unload();
+    SpriteHandle small = registry.GetOrCreate("batched", 1, []()
+    {
+        return GenImageColor(8, 8, BLANK);
+    });
+    SpriteHandle large = registry.GetOrCreate("batched", 2, []()
+    {
+        return GenImageColor(32, 32, BLANK);
+    });
+    SpriteBatch batch;
+    for (int count : {10, 10000})
+    {
+        for (int i = 0; i < count; i++)
+        {
+            batch.Submit(i % 2 ? small : large, {static_cast<float>(i), 0.0f}, {4.0f, 4.0f}, 45.0f, WHITE, i % 4);
+        }
+        batch.Flush();
+        // Every sprite shares the atlas: one bind whatever the count
+        EXPECT_EQ(batch.GetInstanceCount(), count);
+        EXPECT_EQ(batch.GetDrawCount(), 1);
+        EXPECT_TRUE(batch.GetInstances().empty());
+    }
+    // Invalid sprites are never queued
+    batch.Submit(SpriteHandle(), {0.0f, 0.0f}, {0.0f, 0.0f}, 0.0f, WHITE, 0);
+    EXPECT_TRUE(batch.GetInstances().empty());
+    registry.Unload();
+}
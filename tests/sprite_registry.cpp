@@ -0,0 +1,93 @@
+#include <gtest/gtest.h>
+#include <sprite_registry.h>
+#include <asteroid.h>
+#include <thread>
+
+TEST(SpriteRegistryTest, GeneratesEachKeyOnce) {
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    registry.Unload();
+    int generated = 0;
+    auto generate = [&generated]()
+    {
+        generated++;
+        return GenImageColor(16, 16, BLANK);
+    };
+    SpriteHandle first = registry.GetOrCreate("rock", 3, generate);
+    SpriteHandle again = registry.GetOrCreate("rock", 3, generate);
+    SpriteHandle other_seed = registry.GetOrCreate("rock", 4, generate);
+    EXPECT_TRUE(first.IsValid());
+    EXPECT_EQ(first, again);
+    EXPECT_NE(first, other_seed);
+    EXPECT_EQ(generated, 2);
+    EXPECT_EQ(registry.Find("rock", 3), first);
+    EXPECT_FALSE(registry.Find("rock", 5).IsValid());
+    registry.Unload();
+    EXPECT_EQ(registry.GetSpriteCount(), 0);
+}
+
+TEST(SpriteRegistryTest, OtherThreadsFindRegisteredSprites) {
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    registry.Unload();
+    SpriteHandle asteroid = GetAsteroidSprite();
+    SpriteHandle found;
+    std::thread simulation([&found]()
+    {
+        found = GetAsteroidSprite();
+    });
+    simulation.join();
+    EXPECT_EQ(found, asteroid);
+    EXPECT_EQ(registry.GetSpriteCount(), 1);
+    registry.Unload();
+}
+
+TEST(SpriteRegistryTest, PacksSpritesWithoutOverlap) {
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    registry.Unload();
+    std::vector<SpriteHandle> handles;
+    std::vector<Rectangle> sources;
+    for (uint32_t i = 0; i < 200; i++)
+    {
+        int size = 8 + static_cast<int>(i % 5) * 12;
+        handles.push_back(registry.GetOrCreate("packed", i, [size]()
+        {
+            return GenImageColor(size, size, BLANK);
+        }));
+        sources.push_back(registry.GetSource(handles.back()));
+    }
+    for (size_t i = 0; i < sources.size(); i++)
+    {
+        // Inside the atlas, where it was first placed
+        EXPECT_GE(sources[i].x, SpriteRegistry::PADDING);
+        EXPECT_LE(sources[i].x + sources[i].width, SpriteRegistry::ATLAS_WIDTH - SpriteRegistry::PADDING);
+        EXPECT_LE(sources[i].y + sources[i].height, registry.GetAtlasHeight());
+        Rectangle now = registry.GetSource(handles[i]);
+        EXPECT_FLOAT_EQ(now.x, sources[i].x);
+        EXPECT_FLOAT_EQ(now.y, sources[i].y);
+        for (size_t j = i + 1; j < sources.size(); j++)
+        {
+            EXPECT_FALSE(CheckCollisionRecs(sources[i], sources[j])) << i << " overlaps " << j;
+        }
+    }
+    registry.Unload();
+}
+
+TEST(SpriteRegistryTest, AsteroidsShareOneSprite) {
+    PhysicsSystem &physics = PhysicsSystem::GetInstance();
+    SpriteRegistry &registry = SpriteRegistry::GetInstance();
+    physics.Unload();
+    registry.Unload();
+    EntityWorld world;
+    int uploads = registry.GetUploadCount();
+    Entity first = CreateAsteroid(world, 10.0f, 16.0f, 100.0f, {-20.0f, 0.0f});
+    for (int i = 0; i < 999; i++)
+    {
+        CreateAsteroid(world, 10.0f, 16.0f, 100.0f, {static_cast<float>(i) * 20.0f, 0.0f});
+    }
+    registry.GetAtlas();
+    EXPECT_EQ(registry.GetSpriteCount(), 1);
+    EXPECT_LE(registry.GetUploadCount() - uploads, 1);
+    PhysicsHandle body = world.Get<PhysicsBodyComponent>(first)->handle;
+    EXPECT_EQ(physics.GetPhysicsObject(body).sprite.sprite, registry.Find("asteroid", 0));
+    physics.Unload();
+    registry.Unload();
+}
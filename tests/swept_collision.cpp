@@ -0,0 +1,20 @@
+#include <gtest/gtest.h>
+#include <swept_collision.h>
+
+TEST(SweptCollisionTest, CircleHitsCircleInsideTheMove) {
+    float time = -1.0f;
+    // Moves 100 units through a circle of radius 5 centered at 50
+    EXPECT_TRUE(SweptCircleCircle({0.0f, 0.0f}, {100.0f, 0.0f}, 1.0f, {50.0f, 0.0f}, 5.0f, time));
+    EXPECT_NEAR(time, 0.44f, 1e-5f);
+    EXPECT_FALSE(SweptCircleCircle({0.0f, 0.0f}, {100.0f, 0.0f}, 1.0f, {50.0f, 20.0f}, 5.0f, time));
+    EXPECT_FALSE(SweptCircleCircle({0.0f, 0.0f}, {30.0f, 0.0f}, 1.0f, {50.0f, 0.0f}, 5.0f, time));
+}
+
+TEST(SweptCollisionTest, CircleHitsRectangleInsideTheMove) {
+    float time = -1.0f;
+    Rectangle rectangle = {40.0f, -5.0f, 10.0f, 10.0f};
+    EXPECT_TRUE(SweptCircleRect({0.0f, 0.0f}, {100.0f, 0.0f}, 1.0f, rectangle, time));
+    EXPECT_NEAR(time, 0.39f, 1e-5f);
+    EXPECT_FALSE(SweptCircleRect({0.0f, 10.0f}, {100.0f, 10.0f}, 1.0f, rectangle, time));
+    EXPECT_FALSE(SweptCircleRect({100.0f, 0.0f}, {60.0f, 0.0f}, 1.0f, rectangle, time));
+}
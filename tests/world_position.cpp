@@ -0,0 +1,27 @@
+#include <gtest/gtest.h>
+#include <world_position.h>
+
+TEST(WorldPositionTest, OffsetsFoldIntoTheirSector) {
+    WorldPosition inside = WorldPosition::FromOffset({3, -2}, {10.0f, 1000.0f});
+    EXPECT_EQ(inside.sector, WorldSector({3, -2}));
+    EXPECT_FLOAT_EQ(inside.local.x, 10.0f);
+    // Past the far edge and below zero both move whole sectors
+    WorldPosition outside = WorldPosition::FromOffset({3, -2}, {WORLD_SECTOR_SIZE * 2 + 5.0f, -1.0f});
+    EXPECT_EQ(outside.sector, WorldSector({5, -3}));
+    EXPECT_FLOAT_EQ(outside.local.x, 5.0f);
+    EXPECT_FLOAT_EQ(outside.local.y, WORLD_SECTOR_SIZE - 1.0f);
+    // Same point from either representation
+    Vector2 relative = outside.RelativeTo({3, -2});
+    EXPECT_FLOAT_EQ(relative.x, WORLD_SECTOR_SIZE * 2 + 5.0f);
+    EXPECT_FLOAT_EQ(relative.y, -1.0f);
+}
+
+TEST(WorldPositionTest, PrecisionDoesNotDependOnTheSector) {
+    // A millimeter step a billion units away, lost in a plain float position
+    const WorldSector far_sector = {1000000, -1000000};
+    WorldPosition position = WorldPosition::FromOffset(far_sector, {512.0f, 512.0f});
+    WorldPosition moved = WorldPosition::FromOffset(position.sector, {position.local.x + 0.001f, position.local.y});
+    EXPECT_NEAR(moved.RelativeTo(far_sector).x - position.RelativeTo(far_sector).x, 0.001f, 1e-4f);
+    float plain = static_cast<float>(far_sector.x) * WORLD_SECTOR_SIZE + 512.0f;
+    EXPECT_EQ(plain + 0.001f, plain);
+}